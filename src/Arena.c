@@ -0,0 +1,162 @@
+/*
+ * Arena: functions to hand out memory in large chunks and take it all
+ * back at once
+ *
+ * This file provides the definitions of the functions declared in
+ * Arena.h.  A piece that does not fit in what is left of the current
+ * chunk goes at the start of the next chunk in the chain, if it fits
+ * there (as it does when the arena is filled again after a reset), or
+ * of a new chunk put in the chain just after the current one otherwise.
+ * What was left of the current chunk is not used again until the arena
+ * is reset.
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Arena.h"
+#include "printFuncs.h"
+#include "Stats.h"
+
+// internal global variables (global to this file only)
+static const char * ERROR0 = "Error: cannot allocate space in memory.\n";
+
+// internal functions (visible to this file only)
+static void * takeBytes (Arena * arena, size_t size, size_t align);
+static int nextChunk (Arena * arena, size_t size);
+
+void arenaInit (Arena * arena, size_t firstSize, size_t maxSize)
+  /* Postcondition: arena is empty, and has no chunks yet.
+   */
+{
+        arena->first = NULL;
+        arena->current = NULL;
+        arena->next = NULL;
+        arena->end = NULL;
+        arena->firstSize = firstSize;
+        arena->maxSize = maxSize > firstSize ? maxSize : firstSize;
+}
+
+void * arenaAlloc (Arena * arena, size_t size)
+  /* Postcondition: size bytes of the arena, aligned for any type, are
+   *      set aside until it is reset or freed.
+   * Returns a pointer to them, or NULL (after printing an error) if
+   *      memory allocation error.
+   */
+{
+        return takeBytes (arena, size, _Alignof (max_align_t));
+}
+
+char * arenaCopy (Arena * arena, const char * text, size_t length)
+  /* Postcondition: the length characters at text, followed by a null
+   *      byte, have been copied into the arena.
+   * Returns the copy, or NULL (after printing an error) if memory
+   *      allocation error.
+   */
+{
+        char * copy;
+
+        if ( (copy = takeBytes (arena, length + 1, 1)) == NULL )
+            return NULL;
+        (void) memcpy (copy, text, length);
+        copy[length] = '\0';
+        return copy;
+}
+
+void arenaReset (Arena * arena)
+  /* Postcondition: arena is empty again, but keeps its chunks, in the
+   *      same order, for what is allocated next.
+   */
+{
+        if ( (arena->current = arena->first) == NULL )
+            return;
+        arena->next = (char *) arena->first->data;
+        arena->end = arena->next + arena->first->size;
+}
+
+void arenaFree (Arena * arena)
+  /* Postcondition: the chunks of the arena have been released; it is
+   *      empty again.
+   */
+{
+        ArenaChunk * chunk;
+
+        while ( (chunk = arena->first) != NULL )
+        {
+            arena->first = chunk->next;
+            free (chunk);
+        }
+        arenaInit (arena, arena->firstSize, arena->maxSize);
+}
+
+static void * takeBytes (Arena * arena, size_t size, size_t align)
+ /* Returns the first size bytes of the arena that are free and start
+  * at a multiple of align (a power of 2), moving on to the next chunk if
+  * the current one does not have them; or NULL (after printing an error)
+  * if memory allocation error.
+  */
+{
+        size_t padding;
+        char * piece;
+
+        /* (Nothing fits in a NULL chunk: next and end are both NULL.) */
+        padding = -(uintptr_t) arena->next & (align - 1);
+        if ( arena->current == NULL ||
+             (size_t) (arena->end - arena->next) < padding + size )
+        {
+            if ( ! nextChunk (arena, size) )
+                return NULL;
+            padding = 0;            /* chunks start aligned for anything */
+        }
+
+        piece = arena->next + padding;
+        arena->next = piece + size;
+        return piece;
+}
+
+static int nextChunk (Arena * arena, size_t size)
+ /* Makes the chunk after the current one, which must be at least size
+  * bytes (a new one, if the next one in the chain is smaller), the
+  * current one.  Returns 1 if everything went OK; prints an error and
+  * returns 0 otherwise.
+  */
+{
+        ArenaChunk * chunk;
+        ArenaChunk * fresh;
+        size_t       chunkSize;
+
+        chunk = arena->current != NULL ? arena->current->next : arena->first;
+        if ( chunk == NULL || chunk->size < size )
+        {
+            /* Each new chunk is twice as big as the one before it. */
+            chunkSize = arena->current == NULL ? arena->firstSize
+                                               : 2 * arena->current->size;
+            if ( chunkSize > arena->maxSize )
+                chunkSize = arena->maxSize;
+            if ( chunkSize < size )
+                chunkSize = size;
+
+            countStat (STAT_BYTES, sizeof(ArenaChunk) + chunkSize);
+            if ( (fresh = malloc (sizeof(ArenaChunk) + chunkSize)) == NULL )
+            {
+                printError ("%s", ERROR0);
+                return 0;       /* fatal error: couldn't allocate memory */
+            }
+            fresh->size = chunkSize;
+            fresh->next = chunk;
+            if ( arena->current != NULL )
+                arena->current->next = fresh;
+            else
+                arena->first = fresh;
+            chunk = fresh;
+        }
+
+        arena->current = chunk;
+        arena->next = (char *) chunk->data;
+        arena->end = arena->next + chunk->size;
+        return 1;
+}
@@ -0,0 +1,96 @@
+/*
+ * Arena: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for a group
+ * of functions that hand out memory for data that only needs to live as
+ * long as one assembly -- label names, and the working arrays of the
+ * passes -- without a malloc and a free for each piece.  An arena is a
+ * chain of large chunks that the pieces are packed into one after
+ * another: the first chunk is firstSize bytes, and each new one is twice
+ * as big as the last, up to maxSize (or as big as the piece that did not
+ * fit, if that is bigger).  Nothing is ever freed on its own.
+ *
+ * arenaReset empties the arena in constant time, however many pieces it
+ * holds, by going back to the start of its first chunk: the chunks stay
+ * chained as they are, and are filled again, in the same order, by the
+ * next assembly.  One that needs no more memory than the last therefore
+ * allocates nothing at all.  arenaFree releases the chunks.
+ *
+ * The memory arenaAlloc hands out is aligned for any type; arenaCopy
+ * packs strings with no padding between them.  An arena belongs to one
+ * thread at a time.
+ *
+ * EXAMPLE:
+ *      Arena  arena;
+ *      char * name;
+ *      int *  map;
+ *      arenaInit (&arena, 4096, 1024 * 1024);
+ *      for each program:
+ *          name = arenaCopy (&arena, label, length);  // null-terminated
+ *          map = arenaAlloc (&arena, n * sizeof(int));
+ *          ...
+ *          arenaReset (&arena);          // name and map are gone
+ *      arenaFree (&arena);
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <stddef.h>
+
+/* THE DATA STRUCTURES */
+
+typedef struct ArenaChunk {
+        struct ArenaChunk * next;   /* chunk to fill after this one */
+        size_t size;                /* nbr of bytes it holds */
+        max_align_t data[];         /* the bytes */
+} ArenaChunk;
+
+typedef struct {
+        ArenaChunk * first;     /* oldest chunk, or NULL if none yet */
+        ArenaChunk * current;   /* chunk being filled */
+        char * next;            /* next free byte in that chunk */
+        char * end;             /* first byte beyond that chunk */
+        size_t firstSize;       /* size of the first chunk */
+        size_t maxSize;         /* largest size chunks double up to */
+} Arena;
+
+
+/* THE FUNCTIONS */
+
+void arenaInit (Arena * arena, size_t firstSize, size_t maxSize);
+        /* Postcondition: arena is empty, and has no chunks yet; its
+         *      first chunk will be firstSize bytes, and the next ones
+         *      will double in size up to maxSize.
+         */
+
+void * arenaAlloc (Arena * arena, size_t size);
+        /* Postcondition: size bytes of the arena, aligned for any type,
+         *      are set aside until it is reset or freed.
+         * Returns a pointer to them, or NULL (after printing an error)
+         *      if memory allocation error.
+         */
+
+char * arenaCopy (Arena * arena, const char * text, size_t length);
+        /* Postcondition: the length characters at text (which need not
+         *      be null-terminated) have been copied into the arena,
+         *      followed by a null byte, until it is reset or freed.
+         * Returns the copy, or NULL (after printing an error) if memory
+         *      allocation error.
+         */
+
+void arenaReset (Arena * arena);
+        /* Postcondition: arena is empty again, but keeps its chunks for
+         *      what is allocated next; the memory it handed out is no
+         *      longer in use.  Takes constant time.
+         */
+
+void arenaFree (Arena * arena);
+        /* Postcondition: the chunks of the arena have been released; it
+         *      is empty again (and keeps its chunk sizes).
+         */
+
+#endif
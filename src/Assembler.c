@@ -1,40 +1,313 @@
-Assembler()
-char * getNToken (char ** tokBegin, char ** tokEnd);
-	// Moves tokBegin and tokEnd to point to beginning and end of token
-        // Returns the beginning of the token if a token was found (the
-        // same address as tokBegin points to), or null if no token was
-        // found.
-
-   void getOpType (char * opcode, char * opType, int * code, int line);
-	// Takes opcode (mnemonic name, e.g., "add") and returns
-        // opType ('R', 'I', 'J') and code (opcode or funct number).
-	// Takes line number as input for printing error messages.
-
-   int  getRegNbr (char * regName, int line);
-	// Takes register name (e.g., $t0) and returns register number.
-	// Takes line number as input for printing error messages.
-
-   void assembleR (int opcode, char * restOfStmt, int line);
-	// Takes opcode (actually funct number in most cases),
-	// pointer to the rest of the statement, and line number for
-	// printing error messages.
-	// Prints I-format instruction to standard output.
-
-   void assembleI (int opcode, char * restOfStmt, int line, LabelTable table);
-	// Takes opcode, pointer to the rest of the statement,
-	// line number (for printing error messages), and label table.
-	// Prints I-format instruction to standard output.
-        // (Alternative: label table could be global instead of a param.)
-
-   void assembleJ (int opcode, char * restOfStmt, int line, LabelTable table);
-	// Takes opcode, pointer to the rest of the statement,
-	// line number (for printing error messages), and label table.
-	// Prints J-format instruction to standard output.
-        // (Alternative: label table could be global instead of a param.)
-
-   void printBin (int value, int length);
-	// Takes a numeric value and prints the binary format to
-	// standard output as characters.  The length specifies how
-	// many binary digits to print.
-	// E.g., printBin (3, 5) would print 00011 to stdout (the binary
-        // representation for the number 3, expressed using 5 characters).
+/*
+ * This is the MIPS assembler.  It reads a MIPS assembly language
+ * program from a file if a filename has been passed as a command-line
+ * argument, or from the standard input otherwise, and writes the
+ * machine code for it to the standard output.  Instructions are 4
+ * bytes long, with the first instruction at address 0.
+ *
+ * The assembler makes two passes over the program, which is only read
+ * into memory once (see SourceFile.h):
+ *      pass1   builds a table of the labels at the beginning of lines
+ *              and the addresses of the instructions they label, and
+ *              parses each instruction into a compact record (see
+ *              IR.h).  getOpType maps the mnemonic to its opcode id,
+ *              getRegNbr maps register names to numbers, and
+ *              parseOperands parses the operands the way the
+ *              instruction's form says to (see assemble.c);
+ *      pass2   encodes each of those records, without looking at the
+ *              source again.
+ * With the -s option, it makes a single pass instead (see onePass.c),
+ * encoding instructions as it builds the table and patching forward
+ * references to labels at the end.  With the -S option, it makes a
+ * single pass as the program is read (see streamPass.c), writing out
+ * the machine code as it goes, so that a program of any length can be
+ * piped through it.  The passes themselves are run by
+ * assemble (see AssemblerContext.h), which other programs can also
+ * use to assemble programs held in memory.
+ *
+ * USAGE:
+ *      name [ filename ] [ 0|1 ] [ -t | -b | -l ] [ -o outfile ] [ -s ]
+ *              [ -S ] [ -j N ] [ -e N ] [ -p | -P ] [ -c cachefile ]
+ * where "name" is the name of the executable, "filename" is an optional
+ * file containing the input to read, "0" or "1" specifies that
+ * debugging should be turned off or on, respectively, regardless of any
+ * calls to debug_on, debug_off, or debug_restore in the program, and
+ * the last option chooses the output format:
+ *      -t      text: each instruction as 32 '0'/'1' characters on a
+ *              line of its own (the default)
+ *      -b      binary: each instruction as 4 bytes, big-endian
+ *      -l      binary: each instruction as 4 bytes, little-endian
+ * and "-o outfile" writes the machine code to outfile (which is
+ * created or truncated) instead of the standard output.  "-s" chooses
+ * single-pass assembly; for a program without errors, the output is the
+ * same either way.  "-S" chooses streaming assembly: the input (a file
+ * or the standard input) is read a chunk at a time and assembled in a
+ * single pass, and the machine code is written out along the way rather
+ * than at the end, so that neither the whole program nor its whole
+ * machine code is ever in memory (see streamPass.c); for a program
+ * without errors, the output is the same again.  "-j N" lets pass 1
+ * read and pass 2 encode a large program on N threads (see pass1.c and
+ * pass2.c; the output and errors are the same for any N, and -j has no
+ * effect with -s or -S).  "-e N" stops
+ * assembling the program after N errors (20 by default; 0 for no
+ * limit).  "-p" prints a line of statistics on the standard error at
+ * the end: how long loading the input, pass 1 (and adding the labels
+ * to the table, within it), pass 2, and writing the output took, and
+ * counts of the lines (parsed, and skipped as blank or comments only),
+ * tokens, labels, label table lookups and probes, table resizes, and
+ * bytes allocated (see Stats.h); "-P" prints the
+ * same statistics as a JSON object.  "-c cachefile" keeps the labels,
+ * parsed instructions, and machine code of the program in cachefile
+ * when it assembles without errors, and reads them back in the next
+ * time, so that only the parts of the program that have changed since
+ * are parsed and encoded again (see SymbolCache.h; the output is the
+ * same as without it, and both passes run on one thread).  With -o as
+ * well, an outfile still holding the machine code of the last run is
+ * not truncated: only the words that changed are rewritten in it.  A
+ * missing or out-of-date cache file is not an error.  -c has no effect
+ * with -s or -S.
+ * All arguments are optional and may appear in any order.
+ *
+ * INPUT:
+ * This program expects the input to consist of lines of MIPS
+ * instructions, one instruction per line, each of which may (or may
+ * not) begin with a label followed immediately by a colon.  Everything
+ * from a '#' to the end of a line is a comment.
+ *
+ * OUTPUT:
+ * The machine code, in the chosen format, on the standard output (or
+ * in outfile).  Nothing is written until pass 2 is over (except with
+ * -S); see OutputSink.h.
+ *
+ * ERROR CONDITIONS:
+ * Duplicate labels, unknown instructions, invalid registers or numbers,
+ * and undefined labels are reported on the standard error, with line
+ * numbers, a batch at a time (see Diagnostics.h).  After the error
+ * limit (see -e), the rest of the program is skipped and no machine
+ * code is written (with -S, no more than was written already).  The
+ * program returns 1 if there were any errors.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added -S.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "assembler.h"
+
+extern int ERROR_LIMIT;         /* see printError.c */
+
+/* The most threads -j may ask for. */
+#define MAX_THREADS 256
+
+static int process_arguments(int argc, char * argv[], SourceFile * source,
+                             int * streamFd, const char ** inName,
+                             OutputMode * mode, int * outFd, int * onePass,
+                             int * nbrThreads, int * errorLimit,
+                             int * statsFormat, const char ** cacheFile);
+
+int main (int argc, char * argv[])
+{
+    SourceFile       source;    /* the input, held in memory */
+    int              streamFd;  /* or the input, to be streamed */
+    const char *     inName;    /* its name */
+    AssemblerContext ctx;       /* everything the passes work on */
+    OutputMode       mode;
+    int              outFd;
+    int              singlePass;
+    int              nbrThreads;
+    int              errorLimit;
+    int              statsFormat;
+    const char *     cacheFile;
+    int              nbrErrors;
+    long long        start;
+
+    /* Process command-line arguments (if any). */
+    if ( ! process_arguments(argc, argv, &source, &streamFd, &inName,
+                             &mode, &outFd, &singlePass, &nbrThreads,
+                             &errorLimit, &statsFormat, &cacheFile) )
+    {
+        return 1;   /* Fatal error when processing arguments */
+    }
+
+    /* Assemble the program (reporting errors as they are found), then
+     * write out the machine code.
+     */
+    contextInit (&ctx, outFd, mode);
+    ctx.singlePass = singlePass;
+    ctx.nbrThreads = nbrThreads;
+    ctx.printErrors = 1;
+    ctx.errorLimit = errorLimit;
+    ctx.cacheFile = cacheFile;
+    if ( streamFd >= 0 )
+        nbrErrors = assembleStream (&ctx, streamFd, inName, NULL);
+    else
+        nbrErrors = assemble (&ctx, source.data, source.size, NULL);
+
+    /* An outfile opened for -c was not truncated (see process_arguments);
+     * unless it holds the last run's words, to be updated, start it over.
+     */
+    if ( cacheFile != NULL && outFd != STDOUT_FILENO &&
+         ctx.out.previous == NULL && ftruncate (outFd, 0) != 0 )
+    {
+        printError ("Error: cannot write the output.\n");
+        nbrErrors++;
+    }
+    start = statsClock ();
+    if ( ! contextFlush (&ctx) )
+        nbrErrors++;
+    statsTime (STAT_FLUSH, start);
+    if ( statsEnabled )
+        statsPrint (stderr, statsFormat);
+
+    contextFree (&ctx);
+    if ( outFd != STDOUT_FILENO )
+        close (outFd);
+    if ( streamFd > STDIN_FILENO )
+        close (streamFd);
+    else if ( streamFd < 0 )
+        sourceClose (&source);
+    return nbrErrors > 0;
+}
+
+/*
+ * The internal (static) process_arguments function parses the
+ * command-line arguments for an optional filename, an optional choice
+ * (1 or 0) to turn all debugging messages on or off, an optional
+ * output format (-t, -b, or -l), an optional output file (-o), and an
+ * optional choice of single-pass assembly (-s) or streaming assembly
+ * (-S), an optional number of threads for the two passes (-j), an
+ * optional error limit (-e), and an optional request for statistics
+ * (-p or -P), and an optional symbol cache file (-c).
+ * It opens the input (stdin if no filename was passed in) as the given
+ * source or, with -S, sets *streamFd to its file descriptor (-1
+ * otherwise), sets *inName to its name, sets *mode to the output
+ * format, *outFd to the output (stdout if no output file was passed
+ * in), *onePass to 1 for single-pass assembly (0 otherwise),
+ * *nbrThreads to the number of threads (1 by default), *errorLimit to
+ * the error limit (ERROR_LIMIT by default), *statsFormat to 1 for JSON
+ * statistics (0 otherwise), and *cacheFile to the symbol cache file
+ * (NULL if none was passed in, or with -S), turning on statsEnabled if
+ * statistics were asked for (and timing the loading of the input), and
+ * returns 1, or returns 0 if process_arguments encounters a fatal error.
+ *
+ * Usage:
+ *      programName  [filename] [0|1] [-t|-b|-l] [-o outfile] [-s] [-S]
+ *                   [-j N] [-e N] [-p|-P] [-c cachefile]
+ * The arguments may be in any order.
+ *
+ * A debugging choice argument of 0 or 1 indicates a choice to globally
+ * turn debugging off or on, overriding any calls to debug_on,
+ * debug_off, and debug_restore in the code.
+ */
+static int process_arguments(int argc, char * argv[], SourceFile * source,
+                             int * streamFd, const char ** inName,
+                             OutputMode * mode, int * outFd, int * onePass,
+                             int * nbrThreads, int * errorLimit,
+                             int * statsFormat, const char ** cacheFile)
+{
+    const char * filename = NULL;
+    const char * outName = NULL;
+    int          streaming = 0;
+    char *       end;
+    long long    start;
+
+    *mode = OUTPUT_TEXT;
+    *outFd = STDOUT_FILENO;
+    *onePass = 0;
+    *nbrThreads = 1;
+    *errorLimit = ERROR_LIMIT;
+    *statsFormat = 0;
+    *cacheFile = NULL;
+    for ( int i = 1; i < argc; i++ )
+    {
+        if ( strcmp(argv[i], "0") == SAME )
+        {
+            debug_off();  override_debug_changes();
+        }
+        else if ( strcmp(argv[i], "1") == SAME )
+        {
+            debug_on();  override_debug_changes();
+        }
+        else if ( strcmp(argv[i], "-t") == SAME )
+            *mode = OUTPUT_TEXT;
+        else if ( strcmp(argv[i], "-b") == SAME )
+            *mode = OUTPUT_BINARY_BE;
+        else if ( strcmp(argv[i], "-l") == SAME )
+            *mode = OUTPUT_BINARY_LE;
+        else if ( strcmp(argv[i], "-s") == SAME )
+            *onePass = 1;
+        else if ( strcmp(argv[i], "-S") == SAME )
+            streaming = 1;
+        else if ( strcmp(argv[i], "-p") == SAME ||
+                  strcmp(argv[i], "-P") == SAME )
+        {
+            statsEnabled = 1;
+            *statsFormat = argv[i][1] == 'P';
+        }
+        else if ( strcmp(argv[i], "-j") == SAME && i + 1 < argc &&
+                  (*nbrThreads = strtol(argv[i + 1], &end, 10)) > 0 &&
+                  *nbrThreads <= MAX_THREADS && *end == '\0' )
+            i++;
+        else if ( strcmp(argv[i], "-e") == SAME && i + 1 < argc &&
+                  (*errorLimit = strtol(argv[i + 1], &end, 10)) >= 0 &&
+                  *end == '\0' && argv[i + 1][0] != '\0' )
+            i++;
+        else if ( strcmp(argv[i], "-o") == SAME && i + 1 < argc &&
+                  outName == NULL )
+            outName = argv[++i];
+        else if ( strcmp(argv[i], "-c") == SAME && i + 1 < argc &&
+                  *cacheFile == NULL )
+            *cacheFile = argv[++i];
+        else if ( argv[i][0] != '-' && filename == NULL )
+            filename = argv[i];
+        else
+        {
+            printError("Usage:  %s [filename] [0|1] [-t|-b|-l] [-o outfile] "
+                       "[-s] [-S] [-j N] [-e N] [-p|-P] [-c cachefile]\n",
+                       argv[0]);
+            return 0;
+        }
+    }
+
+    /* A stream is written out as it is assembled: no cache. */
+    if ( streaming )
+        *cacheFile = NULL;
+
+    /* Open the output for reading as well as writing, so that it can
+     * be memory-mapped.  (With a cache, it may only need updating; main
+     * truncates it otherwise.)
+     */
+    if ( outName != NULL &&
+         (*outFd = open(outName, O_RDWR | O_CREAT |
+                                 (*cacheFile != NULL ? 0 : O_TRUNC),
+                        0666)) < 0 )
+    {
+        printError("Error: Cannot open file %s.\n", outName);
+        return 0;
+    }
+
+    /* Open the input; with no filename, use standard input.
+     * (sourceOpen prints any error message.)  A stream is only opened
+     * here; it is read as it is assembled.
+     */
+    *streamFd = -1;
+    *inName = filename != NULL ? filename : "<stdin>";
+    if ( streaming )
+    {
+        if ( filename == NULL )
+            *streamFd = STDIN_FILENO;
+        else if ( (*streamFd = open(filename, O_RDONLY)) < 0 )
+        {
+            printError("Error: Cannot open file %s.\n", filename);
+            return 0;
+        }
+        return 1;
+    }
+    start = statsClock ();
+    if ( ! sourceOpen (source, filename) )
+        return 0;
+    statsTime (STAT_LOAD, start);
+    return 1;
+}
@@ -0,0 +1,284 @@
+/*
+ * Assembler Context: functions to assemble programs held in memory
+ *
+ * This file provides the definitions of the functions declared in
+ * AssemblerContext.h.  assemble runs the same passes as the assembler
+ * program itself (see Assembler.c), on the structures in the context.
+ * The symbol cache stays mapped until the context is used again, since
+ * the output may be flushed with the words in it as the previous ones.
+ * assembleStream runs the assembler's streaming pass (see streamPass.c)
+ * on a file descriptor instead.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added assembleStream.
+ *
+ */
+
+#include <sys/stat.h>
+
+#include "assembler.h"
+
+extern int ERROR_LIMIT;         /* see printError.c */
+
+// internal functions (visible to this file only)
+static DiagnosticSink * startAssembly (AssemblerContext * ctx,
+                                       const char * src, size_t len);
+static int finishAssembly (AssemblerContext * ctx, DiagnosticSink * previous,
+                           int nbrErrors, AssembledCode * code);
+static void describeOutput (const OutputSink * out, CacheImage * image);
+
+void contextInit (AssemblerContext * ctx, int outFd, OutputMode mode)
+  /* Postcondition: ctx is an empty context that assembles in two
+   *      passes, on one thread, keeping its errors (and stopping at
+   *      ERROR_LIMIT of them), without a symbol cache, with its
+   *      output going to outFd (or, if outFd is -1, only kept in
+   *      memory).
+   */
+{
+        ctx->singlePass = 0;
+        ctx->nbrThreads = 1;
+        ctx->printErrors = 0;
+        ctx->errorLimit = ERROR_LIMIT;
+        ctx->cacheFile = NULL;
+        tableInit (&ctx->table);
+        irInit (&ctx->program);
+        fixupInit (&ctx->fixups);
+        outputInit (&ctx->out, outFd, mode);
+        diagInit (&ctx->errors, NULL, ctx->errorLimit);
+        cacheInit (&ctx->cache);
+}
+
+int assemble (AssemblerContext * ctx, const char * src, size_t len,
+              AssembledCode * code)
+  /* Postcondition: ctx holds the program in the len bytes at src, and
+   *      its machine code and error messages (described by code, if it
+   *      is not NULL).
+   * Returns the number of errors (0 if the program assembled).
+   */
+{
+        SourceFile       source;
+        SymbolCache *    cache = &ctx->cache;
+        CacheImage       image;
+        DiagnosticSink * previous;
+        int              nbrErrors;
+        long long        start;
+
+        previous = startAssembly (ctx, src, len);
+
+        sourceFromMemory (&source, src, len);
+        if ( ctx->singlePass )
+        {
+            /* One pass builds the table and encodes the instructions. */
+            start = statsClock ();
+            nbrErrors = onePass (&source, &ctx->table, &ctx->fixups,
+                                 &ctx->out);
+            statsTime (STAT_PASS1, start);
+            if ( debug_is_on() )
+                printLabels (&ctx->table);
+        }
+        else
+        {
+            /* Pass 1 builds the label table and parses the instructions;
+             * pass 2 encodes them.
+             */
+            start = statsClock ();
+            if ( ctx->cacheFile != NULL )
+            {
+                /* The output file may still hold the cached words. */
+                describeOutput (&ctx->out, &image);
+                if ( cacheLoad (cache, ctx->cacheFile) &&
+                     image.inode != 0 && image.device == cache->image.device &&
+                     image.inode == cache->image.inode &&
+                     image.size == cache->image.size &&
+                     image.modified == cache->image.modified &&
+                     image.mode == cache->image.mode &&
+                     cache->image.nbrWords <= (uint32_t) cache->nbrInstrs )
+                    outputSetPrevious (&ctx->out, cache->words,
+                                       cache->image.nbrWords);
+                pass1Cached (&source, &ctx->table, &ctx->program, cache);
+            }
+            else
+                pass1 (&source, &ctx->table, &ctx->program, ctx->nbrThreads);
+            statsTime (STAT_PASS1, start);
+            if ( debug_is_on() )
+                printLabels (&ctx->table);
+
+            nbrErrors = ctx->program.nbrErrors;
+            if ( errorLimitReached () )
+                ;                   /* too many errors: no pass 2 */
+            else if ( ! outputReserve (&ctx->out, ctx->program.nbrInstrs) )
+                nbrErrors++;
+            else
+            {
+                start = statsClock ();
+                if ( ctx->cacheFile != NULL )
+                    nbrErrors += pass2Cached (&ctx->program, &ctx->table,
+                                              &ctx->out, cache);
+                else
+                    nbrErrors += pass2 (&ctx->program, ctx->table,
+                                        &ctx->out, ctx->nbrThreads);
+                statsTime (STAT_PASS2, start);
+            }
+
+            /* Only a program without errors is kept. */
+            if ( ctx->cacheFile != NULL && nbrErrors == 0 &&
+                 ctx->errors.nbrErrors == 0 )
+            {
+                if ( ! cacheAddProgram (cache, &ctx->program, &ctx->table,
+                                        ctx->out.words) ||
+                     ! cacheSave (cache, ctx->cacheFile) )
+                    nbrErrors++;
+            }
+        }
+
+        return finishAssembly (ctx, previous, nbrErrors, code);
+}
+
+int assembleStream (AssemblerContext * ctx, int fd, const char * name,
+                    AssembledCode * code)
+  /* Postcondition: ctx has assembled the program read from fd in a
+   *      single pass, writing out its machine code along the way, and
+   *      holds its errors and the rest of its machine code (described
+   *      by code, if it is not NULL).
+   * Returns the number of errors (0 if the program assembled).
+   */
+{
+        LineStream       stream;
+        DiagnosticSink * previous;
+        int              nbrErrors = 1;
+        long long        start;
+
+        /* streamPass gives the errors their source, a line at a time. */
+        previous = startAssembly (ctx, NULL, 0);
+        if ( streamOpen (&stream, fd, name) )
+        {
+            start = statsClock ();
+            nbrErrors = streamPass (&stream, &ctx->table, &ctx->fixups,
+                                    &ctx->out);
+            statsTime (STAT_PASS1, start);
+            if ( debug_is_on() )
+                printLabels (&ctx->table);
+            streamClose (&stream);
+        }
+
+        return finishAssembly (ctx, previous, nbrErrors, code);
+}
+
+int contextFlush (AssemblerContext * ctx)
+  /* Postcondition: the machine code held by ctx has been written to its
+   *      output and, with a cacheFile, the cache records whether the
+   *      output file holds it.
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      the output or the cache file could not be written.
+   */
+{
+        CacheImage image;
+        int        ok = outputFlush (&ctx->out);
+
+        /* The cache's words are in the output file now only if it was
+         * saved by the last assemble (and the flush worked).
+         */
+        if ( ctx->cacheFile == NULL )
+            return ok;
+        describeOutput (&ctx->out, &image);
+        image.nbrWords = ctx->out.nbrWords;
+        return cacheSetImage (ctx->cacheFile, ok && ctx->cache.saved &&
+                                              image.inode != 0
+                                              ? &image : NULL) && ok;
+}
+
+void contextReset (AssemblerContext * ctx)
+  /* Postcondition: ctx holds no program, but keeps its memory for the
+   *      next one.
+   */
+{
+        tableReset (&ctx->table);
+        irReset (&ctx->program);
+        fixupReset (&ctx->fixups);
+        outputReset (&ctx->out);
+        diagReset (&ctx->errors);
+        cacheFree (&ctx->cache);
+}
+
+void contextFree (AssemblerContext * ctx)
+  /* Postcondition: the memory used by ctx has been released; ctx is
+   *      empty again (and keeps its settings).
+   */
+{
+        tableFree (&ctx->table);
+        irFree (&ctx->program);
+        fixupFree (&ctx->fixups);
+        outputFree (&ctx->out);
+        diagFree (&ctx->errors);
+        cacheFree (&ctx->cache);
+}
+
+static DiagnosticSink * startAssembly (AssemblerContext * ctx,
+                                       const char * src, size_t len)
+  /* Empties ctx and makes its sink, with its settings, the one the
+   * calling thread's errors go to, for the program in the len bytes at
+   * src.  Returns the sink they went to until now, or NULL.
+   */
+{
+        contextReset (ctx);
+        ctx->errors.stream = ctx->printErrors ? stderr : NULL;
+        ctx->errors.limit = ctx->errorLimit;
+        diagSetSource (&ctx->errors, src, len);
+        return captureErrors (&ctx->errors);
+}
+
+static int finishAssembly (AssemblerContext * ctx, DiagnosticSink * previous,
+                           int nbrErrors, AssembledCode * code)
+  /* Sends the calling thread's errors back to the previous sink, flushes
+   * ctx's errors, and, if code is not NULL, describes the machine code
+   * and errors in it.  Returns the number of errors (nbrErrors, plus any
+   * the flush could not write, or the number of errors kept if the
+   * limit stopped the program).
+   */
+{
+        (void) captureErrors (previous);
+        if ( ! diagFlush (&ctx->errors) )
+            nbrErrors++;
+
+        /* A program cut short by the error limit did not assemble, and
+         * has no machine code (none that is still in memory, anyway).
+         */
+        if ( ctx->errors.stopped )
+        {
+            outputReset (&ctx->out);
+            if ( nbrErrors == 0 )
+                nbrErrors = ctx->errors.nbrErrors;
+        }
+
+        if ( code != NULL )
+        {
+            code->words = ctx->out.words;
+            code->nbrWords = ctx->out.nbrWords;
+            code->nbrErrors = nbrErrors;
+            code->stopped = ctx->errors.stopped;
+            code->errors = &ctx->errors;
+        }
+        return nbrErrors;
+}
+
+static void describeOutput (const OutputSink * out, CacheImage * image)
+  /* Sets *image to the device, inode, size, and modification time of the
+   * output file, if it is a regular file (all 0 if not), and its mode,
+   * with no words.
+   */
+{
+        struct stat info;
+
+        image->device = image->inode = image->size = image->modified = 0;
+        if ( out->fd >= 0 && fstat (out->fd, &info) == 0 &&
+             S_ISREG(info.st_mode) )
+        {
+            image->device = info.st_dev;
+            image->inode = info.st_ino;
+            image->size = info.st_size;
+            image->modified = info.st_mtim.tv_sec * 1000000000ULL +
+                              info.st_mtim.tv_nsec;
+        }
+        image->mode = out->mode;
+        image->nbrWords = 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Assembler Context: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for the
+ * functions that let a program assemble source code held in memory, as
+ * often as it likes and on as many threads as it likes.  Everything an
+ * assembly needs -- the label table (with its arena of label names),
+ * the parsed program, the fixups, the output words, and the errors
+ * (see Diagnostics.h) -- belongs to an AssemblerContext rather than to the
+ * process.  assemble only empties them between programs, so a context
+ * that has assembled a program as big as the next one does not need to
+ * allocate any more memory for it.  Threads that each have a context
+ * of their own do not get in each other's way: the error count and the
+ * debugging state are kept per thread (see printFuncs.h).
+ *
+ * By default, the errors are kept in the context instead of being
+ * printed.  Once there are errorLimit of them, the rest of the program
+ * is not assembled (and nothing exits, as printError does at
+ * ERROR_LIMIT).  The words, too, are only kept in memory, as numbers,
+ * unless the context was given a file descriptor to flush them to (see
+ * outputFlush).
+ *
+ * A context given a cacheFile keeps the labels, parsed instructions,
+ * and machine code of each program it assembles in two passes in that
+ * file (see SymbolCache.h), and uses them the next time: only the parts
+ * of the program that changed are parsed, and only their instructions
+ * (and the branches and jumps that moved) are encoded.  Both passes
+ * then run on one thread.  If the context's output file still holds
+ * what contextFlush wrote to it the last time, flushing only writes the
+ * words that changed.
+ *
+ * assembleStream assembles a program read from a file descriptor as it
+ * comes in, in a single pass (see streamPass.c), without ever holding
+ * the whole program, or its machine code, in memory: the words are
+ * written to the context's output along the way, and only the last of
+ * them are still in memory at the end, for contextFlush to write out.
+ *
+ * EXAMPLE:
+ *      AssemblerContext ctx;
+ *      AssembledCode    code;
+ *
+ *      contextInit (&ctx, -1, OUTPUT_BINARY_BE);
+ *      for each snippet:
+ *          if ( assemble (&ctx, snippet, strlen (snippet), &code) == 0 )
+ *              ... use code.words[0] .. code.words[code.nbrWords - 1] ...
+ *          else
+ *              ... look at the entries in code.errors (see diagFormat) ...
+ *      contextFree (&ctx);
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added assembleStream.
+ *
+ */
+
+#ifndef _ASSEMBLER_CONTEXT_H
+#define _ASSEMBLER_CONTEXT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "LabelTable.h"
+#include "OutputSink.h"
+#include "Fixups.h"
+#include "IR.h"
+#include "Diagnostics.h"
+#include "SymbolCache.h"
+
+/* THE DATA STRUCTURES */
+
+typedef struct {
+        int singlePass;         /* 1 to assemble in a single pass */
+        int nbrThreads;         /* nbr of threads for pass 1 and pass 2 */
+        int printErrors;        /* 1 to print the errors to stderr (a
+                                 * batch at a time); 0 to keep them */
+        int errorLimit;         /* nbr of errors that stops a program,
+                                 * or 0 for no limit */
+        const char * cacheFile; /* the symbol cache file, or NULL */
+        LabelTable table;       /* the labels of the last program */
+        IRProgram program;      /* the last program, parsed by pass 1 */
+        FixupList fixups;       /* forward references, in a single pass */
+        OutputSink out;         /* the machine code of the last program */
+        DiagnosticSink errors;  /* its errors (see printErrors) */
+        SymbolCache cache;      /* what cacheFile held, and will hold */
+} AssemblerContext;
+
+typedef struct {
+        const uint32_t * words; /* the machine code, one word per
+                                 * instruction (in the context's memory) */
+        long nbrWords;          /* nbr of words */
+        int nbrErrors;          /* nbr of errors found */
+        int stopped;            /* 1 if errorLimit stopped the assembly */
+        const DiagnosticSink * errors;  /* the errors (unless printed) */
+} AssembledCode;
+
+
+/* THE FUNCTIONS */
+
+void contextInit (AssemblerContext * ctx, int outFd, OutputMode mode);
+        /* Postcondition: ctx is an empty context that assembles in two
+         *      passes, on one thread, keeping its errors (and stopping
+         *      at ERROR_LIMIT of them), without a symbol cache.  Its
+         *      output is flushed to the file descriptor outFd in the
+         *      given mode (or, if outFd is -1, only kept in memory).
+         */
+
+int assemble (AssemblerContext * ctx, const char * src, size_t len,
+              AssembledCode * code);
+        /* Postcondition: ctx holds the program made up of the len bytes
+         *      at src, its errors, and its machine code (for the
+         *      instructions that could be encoded, unless the errors
+         *      reached errorLimit); anything it held before is gone.  If
+         *      code is not NULL, it describes the machine code and
+         *      errors, which stay where they are until ctx is used again.
+         * Returns the number of errors (0 if the program assembled).
+         */
+
+int assembleStream (AssemblerContext * ctx, int fd, const char * name,
+                    AssembledCode * code);
+        /* Postcondition: ctx has assembled the program read from the
+         *      file descriptor fd (called name in error messages) to its
+         *      end, in a single pass, and holds its errors and the last
+         *      of its machine code; the words before those (there are
+         *      ctx->out.nbrDropped of them) have been written to ctx's
+         *      output already, even if the errors reached errorLimit.
+         *      (With an outFd of -1, all of the words are kept.)  If
+         *      code is not NULL, it describes the words still held, and
+         *      the errors, as for assemble.
+         * Returns the number of errors (0 if the program assembled).
+         */
+
+int contextFlush (AssemblerContext * ctx);
+        /* Postcondition: the machine code held by ctx has been written
+         *      to its output (see outputFlush), and, if ctx has a
+         *      cacheFile, the cache records whether the output file now
+         *      holds the words in it.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if the output or the cache file could not be written.
+         */
+
+void contextReset (AssemblerContext * ctx);
+        /* Postcondition: ctx holds no program, but keeps its memory for
+         *      the next one.  (assemble does this itself.)
+         */
+
+void contextFree (AssemblerContext * ctx);
+        /* Postcondition: the memory used by ctx has been released; ctx
+         *      is empty again (and keeps its settings).
+         */
+
+#endif
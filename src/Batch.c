@@ -0,0 +1,423 @@
+/*
+ * Batch: functions to assemble many source files on a pool of threads
+ *
+ * This file provides the definitions of the functions declared in
+ * Batch.h.  Each worker thread has an assembler context, and a sink
+ * for the errors found outside of assemble (opening the files, and
+ * writing the output), for as long as the batch runs.  The ranges of
+ * jobs the workers steal from each other each have a mutex of their
+ * own.  The worker that runs on the calling thread is started last, so
+ * that if no other thread can be started, it steals all of the jobs.
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "assembler.h"
+#include "Batch.h"
+
+extern int ERROR_LIMIT;         /* see printError.c */
+
+// internal global variables (global to this file only)
+static const char * ERROR0 = "Error: cannot allocate space in memory.\n";
+static const char * ERROR1 = "Error: Cannot open file %s.\n";
+
+/* THE DATA STRUCTURES (internal) */
+
+typedef struct {
+        pthread_mutex_t lock;
+        int next;               /* the next job to take from the range */
+        int end;                /* the job after the last one in it */
+} JobRange;
+
+typedef struct {
+        Batch * batch;
+        JobRange * ranges;      /* the range of each worker */
+        int nbrWorkers;
+} BatchWork;
+
+typedef struct {
+        BatchWork * work;
+        int self;               /* which worker this is */
+} Worker;
+
+// internal functions (visible to this file only)
+static void * runWorker (void * workerPtr);
+static int takeJob (BatchWork * work, int self);
+static void runJob (AssemblerContext * ctx, DiagnosticSink * other,
+                    BatchJob * job);
+static int addReport (BatchJob * job, const DiagnosticSink * errors);
+
+void batchInit (Batch * batch, OutputMode mode, int nbrThreads)
+  /* Postcondition: batch has no jobs, and will assemble in two passes,
+   *      on nbrThreads threads, stopping each file at ERROR_LIMIT
+   *      errors, and writing the machine code in the given mode.
+   */
+{
+        batch->mode = mode;
+        batch->singlePass = 0;
+        batch->errorLimit = ERROR_LIMIT;
+        batch->nbrThreads = nbrThreads > 0 ? nbrThreads : 1;
+        batch->jobs = NULL;
+        batch->nbrJobs = 0;
+        batch->capacity = 0;
+}
+
+int batchAdd (Batch * batch, const char * input)
+  /* Postcondition: a job for the named source file has been added.
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      memory allocation error.
+   */
+{
+        BatchJob * jobs;
+        BatchJob * job;
+        size_t     length = strlen (input);
+        int        capacity;
+
+        if ( batch->nbrJobs >= batch->capacity )
+        {
+            capacity = batch->capacity > 0 ? 2 * batch->capacity : 64;
+            if ( (jobs = realloc (batch->jobs,
+                                  capacity * sizeof(BatchJob))) == NULL )
+            {
+                printError ("%s", ERROR0);
+                return 0;
+            }
+            batch->jobs = jobs;
+            batch->capacity = capacity;
+        }
+
+        job = &batch->jobs[batch->nbrJobs];
+        job->input = malloc (length + 1);
+        job->output = malloc (length + sizeof(OUTPUT_SUFFIX));
+        if ( job->input == NULL || job->output == NULL )
+        {
+            free (job->input);
+            free (job->output);
+            printError ("%s", ERROR0);
+            return 0;
+        }
+        memcpy (job->input, input, length + 1);
+        memcpy (job->output, input, length);
+        memcpy (job->output + length, OUTPUT_SUFFIX, sizeof(OUTPUT_SUFFIX));
+        job->nbrErrors = 0;
+        job->stopped = 0;
+        job->report = NULL;
+        job->reportLength = 0;
+        batch->nbrJobs++;
+        return 1;
+}
+
+int batchAddManifest (Batch * batch, const char * manifest)
+  /* Postcondition: a job has been added for each source file named in
+   *      the manifest, one name to a line (skipping blank lines and
+   *      lines that start with '#').
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      the manifest could not be read or memory allocation error.
+   */
+{
+        SourceFile source;
+        LineView   line;
+        char *     name = NULL;
+        int        ok = 1;
+
+        if ( ! sourceOpen (&source, manifest) )
+            return 0;
+        while ( ok && sourceNextLine (&source, &line) )
+        {
+            const char * start = line.ptr;
+            const char * end = line.ptr + line.length;
+            char *       longer;
+
+            while ( start < end && (*start == ' ' || *start == '\t') )
+                start++;
+            while ( end > start && (end[-1] == ' ' || end[-1] == '\t') )
+                end--;
+            if ( start == end || *start == '#' )
+                continue;
+
+            /* The line is not null-terminated: copy the name first. */
+            if ( (longer = realloc (name, end - start + 1)) == NULL )
+            {
+                printError ("%s", ERROR0);
+                ok = 0;
+                break;
+            }
+            name = longer;
+            memcpy (name, start, end - start);
+            name[end - start] = '\0';
+            ok = batchAdd (batch, name);
+        }
+
+        free (name);
+        sourceClose (&source);
+        return ok;
+}
+
+int batchRun (Batch * batch)
+  /* Postcondition: every source file in the batch has been assembled,
+   *      its machine code written to its output file, and its errors
+   *      kept in its job.
+   * Returns the number of files with errors.
+   */
+{
+        BatchWork work;
+        int       nbrWorkers = batch->nbrThreads;
+        int       nbrFailed = 0;
+
+        if ( nbrWorkers > batch->nbrJobs )
+            nbrWorkers = batch->nbrJobs > 0 ? batch->nbrJobs : 1;
+
+        /* Each worker starts with an equal share of the jobs. */
+        JobRange  ranges[nbrWorkers];
+        Worker    workers[nbrWorkers];
+        pthread_t threads[nbrWorkers];
+        int       started[nbrWorkers];
+
+        work.batch = batch;
+        work.ranges = ranges;
+        work.nbrWorkers = nbrWorkers;
+        for ( int i = 0; i < nbrWorkers; i++ )
+        {
+            (void) pthread_mutex_init (&ranges[i].lock, NULL);
+            ranges[i].next = (long) batch->nbrJobs * i / nbrWorkers;
+            ranges[i].end = (long) batch->nbrJobs * (i + 1) / nbrWorkers;
+            workers[i].work = &work;
+            workers[i].self = i;
+        }
+
+        for ( int i = 1; i < nbrWorkers; i++ )
+            started[i] = pthread_create (&threads[i], NULL, runWorker,
+                                         &workers[i]) == 0;
+        (void) runWorker (&workers[0]);
+        for ( int i = 1; i < nbrWorkers; i++ )
+            if ( started[i] )
+                (void) pthread_join (threads[i], NULL);
+
+        for ( int i = 0; i < nbrWorkers; i++ )
+            (void) pthread_mutex_destroy (&ranges[i].lock);
+        for ( int i = 0; i < batch->nbrJobs; i++ )
+            nbrFailed += batch->jobs[i].nbrErrors > 0;
+        return nbrFailed;
+}
+
+void batchReport (const Batch * batch, FILE * stream)
+  /* Postcondition: the errors of each file with errors, and their
+   *      number, have been written to stream, in the order of the
+   *      jobs, followed by a line with the number of files and how
+   *      many had errors.
+   */
+{
+        int nbrFailed = 0;
+
+        for ( int i = 0; i < batch->nbrJobs; i++ )
+        {
+            const BatchJob * job = &batch->jobs[i];
+
+            if ( job->nbrErrors == 0 )
+                continue;
+            nbrFailed++;
+            if ( job->report != NULL )
+                (void) fwrite (job->report, 1, job->reportLength, stream);
+            fprintf (stream, "%s: %d error%s%s\n", job->input, job->nbrErrors,
+                     job->nbrErrors == 1 ? "" : "s",
+                     job->stopped ? " (stopped at the error limit)" : "");
+        }
+        fprintf (stream, "%d file%s assembled, %d with errors\n",
+                 batch->nbrJobs, batch->nbrJobs == 1 ? "" : "s", nbrFailed);
+}
+
+void batchFree (Batch * batch)
+  /* Postcondition: the memory used by batch has been released; batch
+   *      has no jobs again.
+   */
+{
+        for ( int i = 0; i < batch->nbrJobs; i++ )
+        {
+            free (batch->jobs[i].input);
+            free (batch->jobs[i].output);
+            free (batch->jobs[i].report);
+        }
+        free (batch->jobs);
+        batch->jobs = NULL;
+        batch->nbrJobs = 0;
+        batch->capacity = 0;
+}
+
+static void * runWorker (void * workerPtr)
+ /* Assembles jobs, with a context of its own, until there are none
+  * left to take or to steal.
+  */
+{
+        Worker *         worker = workerPtr;
+        const Batch *    batch = worker->work->batch;
+        AssemblerContext ctx;
+        DiagnosticSink   other;
+        int              job;
+
+        contextInit (&ctx, -1, batch->mode);
+        ctx.singlePass = batch->singlePass;
+        ctx.errorLimit = batch->errorLimit;
+        diagInit (&other, NULL, 0);
+
+        while ( (job = takeJob (worker->work, worker->self)) >= 0 )
+            runJob (&ctx, &other, &batch->jobs[job]);
+
+        contextFree (&ctx);
+        diagFree (&other);
+        return NULL;
+}
+
+static int takeJob (BatchWork * work, int self)
+ /* Returns the next job in the range of worker self or, if it has none
+  * left, the first of the second half of the jobs left in the biggest
+  * range of another worker, whose second half becomes self's range.
+  * Returns -1 if there are none left anywhere.
+  */
+{
+        JobRange * own = &work->ranges[self];
+        int        job = -1;
+
+        (void) pthread_mutex_lock (&own->lock);
+        if ( own->next < own->end )
+            job = own->next++;
+        (void) pthread_mutex_unlock (&own->lock);
+
+        while ( job < 0 )
+        {
+            JobRange * victim = NULL;
+            int        most = 0;
+            int        left;
+            int        end;
+
+            /* Find the biggest range... */
+            for ( int i = 0; i < work->nbrWorkers; i++ )
+            {
+                if ( i == self )
+                    continue;
+                (void) pthread_mutex_lock (&work->ranges[i].lock);
+                left = work->ranges[i].end - work->ranges[i].next;
+                (void) pthread_mutex_unlock (&work->ranges[i].lock);
+                if ( left > most )
+                {
+                    most = left;
+                    victim = &work->ranges[i];
+                }
+            }
+            if ( victim == NULL )
+                return -1;          /* nothing left to steal */
+
+            /* ...and take its second half, if it still has one (its
+             * owner, or another thief, may have got there first).
+             */
+            (void) pthread_mutex_lock (&victim->lock);
+            left = victim->end - victim->next;
+            end = victim->end;
+            if ( left > 0 )
+            {
+                victim->end -= (left + 1) / 2;
+                job = victim->end;
+            }
+            (void) pthread_mutex_unlock (&victim->lock);
+
+            if ( job >= 0 )
+            {
+                (void) pthread_mutex_lock (&own->lock);
+                own->next = job + 1;
+                own->end = end;
+                (void) pthread_mutex_unlock (&own->lock);
+            }
+        }
+        return job;
+}
+
+static void runJob (AssemblerContext * ctx, DiagnosticSink * other,
+                    BatchJob * job)
+ /* Assembles the source file of the job with ctx, writes its machine
+  * code to the job's output file, and keeps its errors (including the
+  * ones other collects, from opening and writing the files) and their
+  * number in the job.
+  */
+{
+        SourceFile       source;
+        AssembledCode    code;
+        DiagnosticSink * previous;
+        int              fd;
+        long long        start;
+
+        diagReset (other);
+        previous = captureErrors (other);
+
+        start = statsClock ();
+        if ( ! sourceOpen (&source, job->input) )
+            job->nbrErrors = 1;
+        else if ( (fd = open (job->output, O_RDWR | O_CREAT | O_TRUNC,
+                              0666)) < 0 )
+        {
+            printError (ERROR1, job->output);
+            job->nbrErrors = 1;
+            sourceClose (&source);
+        }
+        else
+        {
+            statsTime (STAT_LOAD, start);
+
+            /* The context writes to the job's file, for now. */
+            ctx->out.fd = fd;
+            job->nbrErrors = assemble (ctx, source.data, source.size, &code);
+            job->stopped = code.stopped;
+
+            /* The errors are about the source: format them while it is
+             * still there.
+             */
+            if ( ! addReport (job, code.errors) )
+                job->nbrErrors++;
+            start = statsClock ();
+            if ( ! contextFlush (ctx) )
+                job->nbrErrors++;
+            statsTime (STAT_FLUSH, start);
+
+            ctx->out.fd = -1;
+            (void) close (fd);
+            sourceClose (&source);
+        }
+
+        (void) captureErrors (previous);
+        if ( ! addReport (job, other) )
+            job->nbrErrors++;
+}
+
+static int addReport (BatchJob * job, const DiagnosticSink * errors)
+ /* Appends the messages of the errors, each after the name of the job's
+  * source file, to the job's report.  Returns 1 if everything went OK;
+  * 0 (after printing an error, on stderr) if memory allocation error.
+  */
+{
+        size_t nameLength = strlen (job->input);
+        char * report;
+        int    length;
+
+        for ( int i = 0; i < errors->nbrEntries; i++ )
+        {
+            length = diagFormat (errors, i, NULL, 0);
+            report = realloc (job->report, job->reportLength + nameLength +
+                                           2 + length + 1);
+            if ( length < 0 || report == NULL )
+            {
+                (void) fputs (ERROR0, stderr);
+                return 0;
+            }
+            job->report = report;
+            memcpy (report + job->reportLength, job->input, nameLength);
+            memcpy (report + job->reportLength + nameLength, ": ", 2);
+            job->reportLength += nameLength + 2;
+            (void) diagFormat (errors, i, report + job->reportLength,
+                               length + 1);
+            job->reportLength += length;
+        }
+        return 1;
+}
@@ -0,0 +1,125 @@
+/*
+ * Batch: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for the
+ * functions that assemble many source files in one process, so that
+ * a large number of small programs does not cost a process (and a new
+ * label table, and everything else) apiece.  A batch is a list of
+ * jobs, one for each source file, added one by one or from a manifest.
+ * batchRun assembles them on a pool of worker threads, each with an
+ * assembler context of its own (see AssemblerContext.h) that it reuses
+ * for every file it assembles, so that its label table, name arena,
+ * and the rest only grow to the size of the biggest of its programs.
+ *
+ * The jobs are shared out with work stealing: each worker starts out
+ * with a contiguous range of the jobs, and assembles them in order;
+ * a worker whose range is used up takes the second half of what is
+ * left of the biggest range of another worker, and carries on with it.
+ * Workers only ever lock one range at a time (their own, to take its
+ * next job, or another's, to split it), so they hardly ever wait for
+ * each other, and a few big files do not hold up the rest.
+ *
+ * The machine code of each source file goes to a file of its own, named
+ * after it with OUTPUT_SUFFIX added.  Errors do not stop the batch (or,
+ * as printError does at ERROR_LIMIT, the process): each job keeps its
+ * own errors, up to the batch's error limit, and batchReport prints
+ * them afterwards, file by file, in the order of the jobs, with the
+ * number of errors in each file.
+ *
+ * EXAMPLE:
+ *      Batch batch;
+ *      batchInit (&batch, OUTPUT_TEXT, 8);
+ *      (void) batchAdd (&batch, "prog1.mips");
+ *      (void) batchAddManifest (&batch, "more.list");
+ *      (void) batchRun (&batch);          // prog1.mips.out, ...
+ *      batchReport (&batch, stderr);
+ *      batchFree (&batch);
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "OutputSink.h"
+
+/* What is added to the name of a source file to name its output. */
+#define OUTPUT_SUFFIX ".out"
+
+/* THE DATA STRUCTURES */
+
+typedef struct {
+        char * input;           /* name of the source file */
+        char * output;          /* name of the file its code goes to */
+        int nbrErrors;          /* nbr of errors found in it */
+        int stopped;            /* 1 if the error limit stopped it */
+        char * report;          /* its error messages, or NULL if none */
+        size_t reportLength;    /* nbr of characters in report */
+} BatchJob;
+
+typedef struct {
+        OutputMode mode;        /* how the machine code is written */
+        int singlePass;         /* 1 to assemble in a single pass */
+        int errorLimit;         /* nbr of errors that stops a file, or 0
+                                 * for no limit */
+        int nbrThreads;         /* nbr of worker threads */
+        BatchJob * jobs;
+        int nbrJobs;            /* actual nbr of jobs in the batch */
+        int capacity;           /* nbr of jobs the memory can hold */
+} Batch;
+
+
+/* THE FUNCTIONS */
+
+void batchInit (Batch * batch, OutputMode mode, int nbrThreads);
+        /* Postcondition: batch has no jobs, and will assemble in two
+         *      passes, on nbrThreads threads, stopping each file at
+         *      ERROR_LIMIT errors, and writing the machine code in the
+         *      given mode.
+         */
+
+int batchAdd (Batch * batch, const char * input);
+        /* Postcondition: a job for the named source file (whose name
+         *      is copied) has been added to the batch.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if memory allocation error.
+         */
+
+int batchAddManifest (Batch * batch, const char * manifest);
+        /* Postcondition: a job has been added to the batch for each
+         *      source file named in the manifest, one name to a line, in
+         *      order.  Blank lines and lines that start with '#' are
+         *      skipped, and so are the spaces and tabs at either end of
+         *      a name.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if the manifest could not be read or memory allocation
+         *      error.
+         */
+
+int batchRun (Batch * batch);
+        /* Postcondition: every source file in the batch has been
+         *      assembled, and its machine code written to its output
+         *      file (none is written for a file the error limit stopped,
+         *      and none is created for one that could not be read);
+         *      each job holds the errors found in its file.
+         * Returns the number of files with errors.
+         */
+
+void batchReport (const Batch * batch, FILE * stream);
+        /* Postcondition: for each file with errors, in the order of the
+         *      jobs, its errors and then their number have been written
+         *      to stream, each on a line that starts with the name of
+         *      the file; then a line with the number of files, and how
+         *      many of them had errors.
+         */
+
+void batchFree (Batch * batch);
+        /* Postcondition: the memory used by batch has been released;
+         *      batch has no jobs again (and keeps its settings).
+         */
+
+#endif
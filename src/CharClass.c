@@ -0,0 +1,27 @@
+/*
+ * Character Classes: the table classifying every byte value
+ *
+ * This file defines the CHAR_CLASS table declared in CharClass.h.
+ * Every byte not listed below belongs to no class.
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#include "CharClass.h"
+
+const unsigned char CHAR_CLASS[256] =
+{
+        ['\0'] = CC_NULL,
+        [' ']  = CC_SPACE,
+        ['\t'] = CC_SPACE,
+        ['\n'] = CC_SPACE | CC_NEWLINE,
+        ['\v'] = CC_SPACE,
+        ['\f'] = CC_SPACE,
+        ['\r'] = CC_SPACE,
+        [',']  = CC_DELIM,
+        ['(']  = CC_DELIM,
+        [')']  = CC_DELIM,
+        [':']  = CC_DELIM | CC_COLON,
+        ['#']  = CC_COMMENT,
+};
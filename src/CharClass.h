@@ -0,0 +1,43 @@
+/*
+ * Character Classes: a table classifying every byte value
+ *
+ * This file declares a 256-entry table that gives, for each possible
+ * byte, the set of character classes the tokenizer cares about.  The
+ * table is initialized at compile time and does not depend on the
+ * current locale (unlike isspace), so classifying a character is a
+ * single table lookup.  It is shared by getToken, getTokenSpan, and
+ * anything else that needs to find token boundaries or comments.
+ *
+ * EXAMPLE:
+ *      while ( ! IS_TOKEN_END (*end) )
+ *          end++;
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#ifndef _CHAR_CLASS_H
+#define _CHAR_CLASS_H
+
+/* The character classes (a character may be in more than one). */
+#define CC_SPACE        0x01    /* whitespace: ' ' \t \n \v \f \r */
+#define CC_DELIM        0x02    /* token delimiter: , ( ) : */
+#define CC_COMMENT      0x04    /* start of a comment: # */
+#define CC_NEWLINE      0x08    /* end of a line: \n */
+#define CC_NULL         0x10    /* the null byte */
+#define CC_COLON        0x20    /* the end of a label: : */
+
+/* Any character that ends a token in a null-terminated string, and
+ * in a span whose end is given by a limit instead.
+ */
+#define CC_TOKEN_END    (CC_SPACE | CC_DELIM | CC_NULL)
+#define CC_SPAN_END     (CC_SPACE | CC_DELIM)
+
+extern const unsigned char CHAR_CLASS[256];
+
+#define CHAR_CLASS_OF(c)   (CHAR_CLASS[(unsigned char) (c)])
+#define IS_SPACE(c)        (CHAR_CLASS_OF(c) & CC_SPACE)
+#define IS_TOKEN_END(c)    (CHAR_CLASS_OF(c) & CC_TOKEN_END)
+#define IS_SPAN_END(c)     (CHAR_CLASS_OF(c) & CC_SPAN_END)
+
+#endif
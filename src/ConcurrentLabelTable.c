@@ -0,0 +1,550 @@
+/*
+ * Concurrent Label Table: a label table many threads can use at once
+ *
+ * This file provides the functions behind a table made with
+ * tableInitConcurrent (see LabelTable.h and ConcurrentLabelTable.h).
+ * Any number of threads may add, find, and refer to labels in such a
+ * table at the same time, with no locks:
+ *
+ *      Each label is a node of its own, allocated by the thread that
+ *      adds it, holding its entry and a copy of its name.  Nodes never
+ *      move and are only freed with the table, so a pointer to one
+ *      stays good while other threads keep adding labels.
+ *
+ *      The hash index is an open-addressing array of pointers to the
+ *      nodes (NULL = empty slot), probed linearly.  A thread adds a
+ *      label by claiming the first empty slot in the label's probe
+ *      sequence with a compare-and-swap.  If another thread claims it
+ *      first, the thread looks at what was put there (it may be the
+ *      same label) and, if need be, goes on to the next slot.  Finding
+ *      a label only reads the index, so it never waits for anyone.
+ *
+ *      When the index becomes half full, a bigger one is made and
+ *      linked to it (the first thread to link one wins), and the
+ *      nodes are moved over to it, one slot at a time.  A slot that
+ *      has been moved (whether it held a node or was empty) is set to
+ *      MOVED, which tells anyone who comes to it that the rest of the
+ *      story is in the bigger index.  The node is put in the bigger
+ *      index before its old slot is set to MOVED, so a reader finds it
+ *      in one index or the other and never has to wait for a move to
+ *      finish.  A thread that wants to add a label to an index that is
+ *      being moved helps move all of it first, so no label can end up
+ *      in the bigger index twice.  The old indexes are kept (for any
+ *      readers still in them) until the table is freed.
+ *
+ *      The position of a node in the table is handed out, in the order
+ *      the nodes were added, by the thread that added it, and the node
+ *      is stored at that position in an array of segments, each twice
+ *      as big as the last, which never have to move either.
+ *
+ * The address of an entry may be changed (from UNDEFINED_ADDRESS to
+ * a real address) while other threads are reading it, so it is always
+ * read and written atomically.  The table's nbrLabels (the number of
+ * positions handed out) is too.  The memory orders make sure that a
+ * thread that finds a node also sees the name and hash stored in it.
+ * The GCC atomic builtins are used (rather than <stdatomic.h>) because
+ * they work on the plain int fields of LabelTable and LabelEntry, which
+ * everyone else reads as usual once the threads are done.
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#include <sched.h>
+
+#include "assembler.h"
+#include "ConcurrentLabelTable.h"
+
+// internal global variables (global to this file only)
+static const char * ERROR2 = "Error: cannot allocate space in memory.\n";
+
+static const int FIRST_INDEX_SIZE = 1024;       /* in slots */
+#define FIRST_SEGMENT_SIZE 1024                 /* in entries */
+#define NBR_SEGMENTS 22                         /* room for 4G entries */
+
+/* Positions of nodes that do not have one yet, or never will (out of
+ * memory).
+ */
+#define NO_POSITION_YET (-1)
+#define NO_POSITION (-2)
+
+/* A label: its entry, its position in the table, and its name. */
+typedef struct {
+        LabelEntry entry;
+        int position;           /* position in the table, or NO_POSITION* */
+        char name[];
+} LabelNode;
+
+typedef struct LabelIndex {
+        struct LabelIndex * next;   /* bigger index moved to, or NULL */
+        struct LabelIndex * older;  /* smaller index moved from, or NULL */
+        int size;                   /* nbr of slots (a power of 2) */
+        int used;                   /* nbr of slots holding nodes */
+        LabelNode * slots[];        /* NULL (empty), a node, or MOVED */
+} LabelIndex;
+
+struct ConcurrentLabelTable {
+        LabelIndex * index;         /* newest index that has all nodes */
+        LabelNode ** segments[NBR_SEGMENTS];
+};
+
+/* What a slot that has been moved to the next index is set to. */
+static LabelNode movedNode;
+#define MOVED (&movedNode)
+
+// internal functions (visible to this file only)
+static LabelNode * findNode (ConcurrentLabelTable * shared,
+                             const char * label, int length, unsigned hash);
+static LabelNode * insertNode (LabelTable * table, const char * label,
+                               int length, unsigned hash, int PC,
+                               int * inserted);
+static int matches (const LabelNode * node, const char * label, int length,
+                    unsigned hash);
+static LabelIndex * newIndex (int size);
+static LabelIndex * growIndex (ConcurrentLabelTable * shared,
+                               LabelIndex * index);
+static LabelIndex * moveIndex (ConcurrentLabelTable * shared,
+                               LabelIndex * index);
+static void moveNode (LabelIndex * index, LabelNode * node);
+static void givePosition (LabelTable * table, LabelNode * node);
+static int waitForPosition (LabelNode * node);
+static LabelNode ** segmentSlot (ConcurrentLabelTable * shared, int position,
+                                 int allocate);
+
+ConcurrentLabelTable * concurrentInit (void)
+  /* Returns a new empty concurrent table, or NULL (after printing an
+   *      error) if memory allocation error.
+   */
+{
+        ConcurrentLabelTable * shared;
+
+        if ( (shared = calloc (1, sizeof(ConcurrentLabelTable))) == NULL ||
+             (shared->index = newIndex (FIRST_INDEX_SIZE)) == NULL )
+        {
+            free (shared);
+            printError ("%s", ERROR2);
+            return NULL;
+        }
+        return shared;
+}
+
+void concurrentFree (ConcurrentLabelTable * shared)
+  /* Postcondition: all memory used by shared, including its entries
+   *      and label names, has been released.
+   */
+{
+        LabelIndex * index = shared->index;
+        LabelIndex * older;
+
+        /* The newest index holds every node exactly once. */
+        while ( index->next != NULL )
+            index = index->next;
+        for ( int slot = 0; slot < index->size; slot++ )
+            if ( index->slots[slot] != NULL && index->slots[slot] != MOVED )
+                free (index->slots[slot]);
+
+        for ( ; index != NULL; index = older )
+        {
+            older = index->older;
+            free (index);
+        }
+        for ( int i = 0; i < NBR_SEGMENTS; i++ )
+            free (shared->segments[i]);
+        free (shared);
+}
+
+int concurrentAdd (LabelTable * table, const char * label, int length,
+                   unsigned hash, int PC)
+  /* Postcondition: works like addLabelLen, but returns 2 for a duplicate
+   *      label instead of reporting it.
+   */
+{
+        LabelNode * node;
+        int         inserted;
+        int         address = UNDEFINED_ADDRESS;
+
+        if ( (node = insertNode (table, label, length, hash, PC,
+                                 &inserted)) == NULL )
+            return 0;           /* fatal error: couldn't allocate memory */
+        if ( inserted )
+            return 1;
+
+        /* Define a label that was referenced before it was defined,
+         * unless some other thread got there first.
+         */
+        if ( ! __atomic_compare_exchange_n (&node->entry.address, &address, PC,
+                                            0, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED) )
+            return 2;           /* not fatal, as in addLabelLen */
+        return 1;
+}
+
+int concurrentFind (LabelTable * table, const char * label, int length,
+                    unsigned hash)
+  /* Returns the address of the label, or -1 if it is not in the table. */
+{
+        LabelNode * node = findNode (table->concurrent, label, length, hash);
+
+        if ( node == NULL )
+            return -1;
+        return __atomic_load_n (&node->entry.address, __ATOMIC_ACQUIRE);
+}
+
+int concurrentReference (LabelTable * table, const char * label, int length,
+                         unsigned hash)
+  /* Returns the position of the label's entry (added, with an undefined
+   *      address, if need be), or -1 if memory allocation error.
+   */
+{
+        LabelNode * node;
+        int         inserted;
+
+        if ( (node = insertNode (table, label, length, hash,
+                                 UNDEFINED_ADDRESS, &inserted)) == NULL )
+            return -1;          /* fatal error: couldn't allocate memory */
+        return waitForPosition (node);
+}
+
+int concurrentReserve (LabelTable * table, int nbrLabels)
+  /* Postcondition: the index can hold nbrLabels labels without having to
+   *      grow.  (Entries are never removed: returns 0 if there are more
+   *      than nbrLabels of them already.)
+   * Returns 1 if everything went OK; 0 if memory allocation error.
+   */
+{
+        ConcurrentLabelTable * shared = table->concurrent;
+        LabelIndex *           index;
+
+        if ( nbrLabels < __atomic_load_n (&table->nbrLabels, __ATOMIC_ACQUIRE) )
+            return 0;
+
+        index = __atomic_load_n (&shared->index, __ATOMIC_ACQUIRE);
+        while ( index != NULL && index->size / 2 < nbrLabels )
+            index = growIndex (shared, index);
+        return index != NULL;
+}
+
+LabelEntry * concurrentEntry (LabelTable * table, int position)
+  /* Returns the entry at the given position, or NULL if there is none
+   *      (yet).
+   */
+{
+        LabelNode ** slot;
+        LabelNode *  node;
+
+        if ( position < 0 ||
+             (slot = segmentSlot (table->concurrent, position, 0)) == NULL ||
+             (node = __atomic_load_n (slot, __ATOMIC_ACQUIRE)) == NULL )
+            return NULL;
+        return &node->entry;
+}
+
+static LabelNode * findNode (ConcurrentLabelTable * shared,
+                             const char * label, int length, unsigned hash)
+ /* Returns the node for label, or NULL if it is not in the table.  Never
+  * waits for anything: at worst it follows the moved slots into the
+  * newer indexes.
+  */
+{
+        LabelIndex * index = __atomic_load_n (&shared->index, __ATOMIC_ACQUIRE);
+        LabelNode *  node;
+        unsigned     mask;
+        unsigned     slot;
+        int          probes;
+
+        for ( ;; )
+        {
+            mask = index->size - 1;
+            for ( slot = hash & mask, probes = 0; probes < index->size;
+                  slot = (slot + 1) & mask, probes++ )
+            {
+                node = __atomic_load_n (&index->slots[slot], __ATOMIC_ACQUIRE);
+                if ( node == NULL )
+                    return NULL;
+                if ( node == MOVED )
+                    break;
+                if ( matches (node, label, length, hash) )
+                    return node;
+            }
+            /* moved (or full, which also means a bigger index is coming) */
+            if ( (index = __atomic_load_n (&index->next,
+                                           __ATOMIC_ACQUIRE)) == NULL )
+                return NULL;
+        }
+}
+
+static LabelNode * insertNode (LabelTable * table, const char * label,
+                               int length, unsigned hash, int PC,
+                               int * inserted)
+ /* Returns the node for label, which is added to the table, with the
+  * address PC, if it is not there yet (then *inserted is set to 1,
+  * otherwise to 0).  Returns NULL (after printing an error) if memory
+  * allocation error.
+  */
+{
+        ConcurrentLabelTable * shared = table->concurrent;
+        LabelIndex *           index;
+        LabelNode *            fresh = NULL;
+        LabelNode *            node = NULL;
+        unsigned               mask;
+        unsigned               slot;
+        int                    probes;
+
+        *inserted = 0;
+        index = __atomic_load_n (&shared->index, __ATOMIC_ACQUIRE);
+        for ( ;; )
+        {
+            /* Help finish any move before adding to an index. */
+            if ( __atomic_load_n (&index->next, __ATOMIC_ACQUIRE) != NULL )
+            {
+                index = moveIndex (shared, index);
+                continue;
+            }
+            if ( __atomic_load_n (&index->used, __ATOMIC_RELAXED)
+                 >= index->size / 2 )
+            {
+                if ( (index = growIndex (shared, index)) == NULL )
+                    break;
+                continue;
+            }
+
+            mask = index->size - 1;
+            for ( slot = hash & mask, probes = 0; probes < index->size;
+                  slot = (slot + 1) & mask, probes++ )
+            {
+                node = __atomic_load_n (&index->slots[slot], __ATOMIC_ACQUIRE);
+                if ( node == NULL )
+                {
+                    if ( fresh == NULL )
+                    {
+                        if ( (fresh = malloc (sizeof(LabelNode) + length + 1))
+                             == NULL )
+                            break;
+                        (void) memcpy (fresh->name, label, length);
+                        fresh->name[length] = '\0';
+                        fresh->entry.label = fresh->name;
+                        fresh->entry.address = PC;
+                        fresh->entry.length = length;
+                        fresh->entry.hash = hash;
+                        fresh->position = NO_POSITION_YET;
+                    }
+                    if ( __atomic_compare_exchange_n (&index->slots[slot],
+                                                      &node, fresh, 0,
+                                                      __ATOMIC_ACQ_REL,
+                                                      __ATOMIC_ACQUIRE) )
+                    {
+                        __atomic_fetch_add (&index->used, 1, __ATOMIC_RELAXED);
+                        givePosition (table, fresh);
+                        *inserted = 1;
+                        return fresh;
+                    }
+                    /* someone else got the slot: see what they put there */
+                }
+                if ( node == MOVED )
+                    break;
+                if ( matches (node, label, length, hash) )
+                {
+                    free (fresh);
+                    return node;
+                }
+            }
+
+            if ( probes < index->size && node != MOVED )
+                break;          /* couldn't allocate the node */
+            /* the index is being moved (or is full): go to the next one */
+            if ( node != MOVED && (index = growIndex (shared, index)) == NULL )
+                break;
+        }
+
+        free (fresh);
+        printError ("%s", ERROR2);
+        return NULL;
+}
+
+static int matches (const LabelNode * node, const char * label, int length,
+                    unsigned hash)
+ /* Returns true (1) if node is the node for label (whose hash and length
+  * have already been computed); false (0) otherwise.
+  */
+{
+        return node->entry.hash == hash && node->entry.length == length &&
+               memcmp (node->name, label, length) == SAME;
+}
+
+static LabelIndex * newIndex (int size)
+ /* Returns a new empty index with size slots, or NULL if memory
+  * allocation error.
+  */
+{
+        LabelIndex * index;
+
+        if ( (index = calloc (1, sizeof(LabelIndex) +
+                                 size * sizeof(LabelNode *))) != NULL )
+            index->size = size;
+        return index;
+}
+
+static LabelIndex * growIndex (ConcurrentLabelTable * shared,
+                               LabelIndex * index)
+ /* Links a bigger index to index, if no one has done so yet, moves the
+  * nodes to it, and returns it.  Returns NULL if memory allocation
+  * error.
+  */
+{
+        LabelIndex * bigger;
+        LabelIndex * expected = NULL;
+
+        if ( __atomic_load_n (&index->next, __ATOMIC_ACQUIRE) == NULL )
+        {
+            if ( (bigger = newIndex (2 * index->size)) == NULL )
+                return NULL;
+            bigger->older = index;
+            if ( ! __atomic_compare_exchange_n (&index->next, &expected,
+                                                bigger, 0, __ATOMIC_ACQ_REL,
+                                                __ATOMIC_ACQUIRE) )
+                free (bigger);  /* someone else linked one first */
+        }
+        return moveIndex (shared, index);
+}
+
+static LabelIndex * moveIndex (ConcurrentLabelTable * shared,
+                               LabelIndex * index)
+ /* Moves every slot of index (which has a next index) to the next index,
+  * unless some other thread already has, makes the next index the
+  * table's index, and returns it.  Moving a slot twice does no harm, so
+  * any number of threads can do this at once.
+  */
+{
+        LabelIndex * next = __atomic_load_n (&index->next, __ATOMIC_ACQUIRE);
+        LabelIndex * expected = index;
+        LabelNode *  node;
+
+        for ( int slot = 0; slot < index->size; slot++ )
+        {
+            node = __atomic_load_n (&index->slots[slot], __ATOMIC_ACQUIRE);
+            while ( node != MOVED )
+            {
+                /* an empty slot is set to MOVED, so no one can fill it */
+                if ( node == NULL )
+                {
+                    if ( __atomic_compare_exchange_n (&index->slots[slot],
+                                                      &node, MOVED, 0,
+                                                      __ATOMIC_ACQ_REL,
+                                                      __ATOMIC_ACQUIRE) )
+                        break;
+                    continue;   /* just filled: move that node instead */
+                }
+                moveNode (next, node);
+                __atomic_store_n (&index->slots[slot], MOVED, __ATOMIC_RELEASE);
+                break;
+            }
+        }
+
+        (void) __atomic_compare_exchange_n (&shared->index, &expected, next, 0,
+                                            __ATOMIC_ACQ_REL,
+                                            __ATOMIC_RELAXED);
+        return next;
+}
+
+static void moveNode (LabelIndex * index, LabelNode * node)
+ /* Puts node in index, unless it is there already.  Nothing else but
+  * nodes being moved is added to index until all of them have been, so
+  * the node goes in the first empty slot of its probe sequence.
+  */
+{
+        unsigned     mask = index->size - 1;
+        unsigned     slot = node->entry.hash & mask;
+        LabelNode *  found;
+
+        for ( int probes = 0; probes < index->size; probes++ )
+        {
+            found = __atomic_load_n (&index->slots[slot], __ATOMIC_ACQUIRE);
+            if ( found == NULL &&
+                 __atomic_compare_exchange_n (&index->slots[slot], &found,
+                                              node, 0, __ATOMIC_ACQ_REL,
+                                              __ATOMIC_ACQUIRE) )
+            {
+                __atomic_fetch_add (&index->used, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            /* a late helper can find the whole index moved on already */
+            if ( found == node || found == MOVED )
+                return;
+            if ( found != NULL )
+                slot = (slot + 1) & mask;
+        }
+}
+
+static void givePosition (LabelTable * table, LabelNode * node)
+ /* Gives node (which has just been added) the next position in the
+  * table and stores it there.
+  */
+{
+        int          position;
+        LabelNode ** slot;
+
+        position = __atomic_fetch_add (&table->nbrLabels, 1, __ATOMIC_RELAXED);
+        if ( (slot = segmentSlot (table->concurrent, position, 1)) == NULL )
+        {
+            __atomic_store_n (&node->position, NO_POSITION, __ATOMIC_RELEASE);
+            return;
+        }
+        __atomic_store_n (slot, node, __ATOMIC_RELEASE);
+        __atomic_store_n (&node->position, position, __ATOMIC_RELEASE);
+}
+
+static int waitForPosition (LabelNode * node)
+ /* Returns the position of node, or -1 (after printing an error) if it
+  * could not be given one.  A node that was just added by another thread
+  * may not have one yet; the thread is about to give it one.
+  */
+{
+        int position;
+
+        while ( (position = __atomic_load_n (&node->position,
+                                             __ATOMIC_ACQUIRE))
+                == NO_POSITION_YET )
+            (void) sched_yield ();
+
+        if ( position == NO_POSITION )
+        {
+            printError ("%s", ERROR2);
+            return -1;
+        }
+        return position;
+}
+
+static LabelNode ** segmentSlot (ConcurrentLabelTable * shared, int position,
+                                 int allocate)
+ /* Returns where the node at the given position is stored, allocating
+  * the segment for it if need be (and allocate is not 0).  Returns
+  * NULL if the segment is not there or cannot be allocated.  Segment k
+  * holds FIRST_SEGMENT_SIZE << k positions, following those of the
+  * segments before it.
+  */
+{
+        unsigned     block = (unsigned) position / FIRST_SEGMENT_SIZE + 1;
+        int          k = 31 - __builtin_clz (block);
+        LabelNode ** segment;
+        LabelNode ** expected = NULL;
+
+        if ( k >= NBR_SEGMENTS )
+            return NULL;
+        segment = __atomic_load_n (&shared->segments[k], __ATOMIC_ACQUIRE);
+        if ( segment == NULL )
+        {
+            if ( ! allocate ||
+                 (segment = calloc ((size_t) FIRST_SEGMENT_SIZE << k,
+                                    sizeof(LabelNode *))) == NULL )
+                return NULL;
+            if ( ! __atomic_compare_exchange_n (&shared->segments[k],
+                                                &expected, segment, 0,
+                                                __ATOMIC_ACQ_REL,
+                                                __ATOMIC_ACQUIRE) )
+            {
+                free (segment);         /* someone else allocated it */
+                segment = expected;
+            }
+        }
+        return &segment[position - FIRST_SEGMENT_SIZE * ((1 << k) - 1)];
+}
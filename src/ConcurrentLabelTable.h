@@ -0,0 +1,49 @@
+/*
+ * Concurrent Label Table: internal declarations
+ *
+ * This file declares the functions behind a label table made with
+ * tableInitConcurrent (see LabelTable.h).  They are only called by the
+ * functions in LabelTable.c, which check that the table exists and
+ * compute the hash of the label name (see hashLabel) before passing
+ * them on.  Everyone else uses the functions in LabelTable.h, which
+ * work the same on either kind of table.
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#ifndef CONCURRENT_LABEL_H
+#define CONCURRENT_LABEL_H
+
+#include "LabelTable.h"
+
+ConcurrentLabelTable * concurrentInit (void);
+        /* Returns a new empty concurrent table, or NULL (after printing
+         *      an error) if memory allocation error.
+         */
+
+void concurrentFree (ConcurrentLabelTable * shared);
+        /* Postcondition: all memory used by shared, including its
+         *      entries and label names, has been released.
+         */
+
+int concurrentAdd (LabelTable * table, const char * label, int length,
+                   unsigned hash, int PC);
+int concurrentFind (LabelTable * table, const char * label, int length,
+                    unsigned hash);
+int concurrentReference (LabelTable * table, const char * label, int length,
+                         unsigned hash);
+int concurrentReserve (LabelTable * table, int nbrLabels);
+        /* These work like addLabelLen, findLabelLen, referenceLabelLen,
+         *      and tableResize (which only makes room, see LabelTable.h),
+         *      for a label whose hash has already been computed, except
+         *      that concurrentAdd returns 2 for a duplicate label, for
+         *      addLabelLen to report.
+         */
+
+LabelEntry * concurrentEntry (LabelTable * table, int position);
+        /* Returns the entry at the given position, or NULL if there is
+         *      none (yet).
+         */
+
+#endif
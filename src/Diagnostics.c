@@ -0,0 +1,421 @@
+/*
+ * Diagnostics: functions to collect and print the errors in a program
+ *
+ * This file provides the definitions of the functions declared in
+ * Diagnostics.h, and reportMessage, through which printError records
+ * its messages in the calling thread's sink.  The messages and the
+ * arguments diagKeepArgs copies share one text buffer per sink.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added diagKeepArgs.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Diagnostics.h"
+#include "printFuncs.h"
+
+// internal global variables (global to this file only)
+static const char * ERROR0 = "Error: cannot allocate space in memory.\n";
+static const char * ERROR1 = "Error: too many errors; assembly stopped.\n";
+
+/* The format of each error, indexed by code. */
+#define DIAG(code, format)  format,
+static const char * FORMAT[NBR_DIAGNOSTICS] = { DIAGNOSTICS };
+#undef DIAG
+
+/* Bytes diagFlush formats before each write. */
+#define FLUSH_SIZE 8192
+
+/* The sink the calling thread's errors go to, if any. */
+static _Thread_local DiagnosticSink * current = NULL;
+
+// internal functions (visible to this file only)
+static Diagnostic * newEntry (DiagnosticSink * sink);
+static int columnOf (const DiagnosticSink * sink, const char * arg);
+static int saveMessage (DiagnosticSink * sink, const char * message,
+                        int length);
+static int growText (DiagnosticSink * sink, int length);
+static const char * argOf (const DiagnosticSink * sink,
+                           const Diagnostic * entry);
+
+void diagInit (DiagnosticSink * sink, FILE * stream, int limit)
+  /* Postcondition: sink is empty, with the given stream (or NULL, to
+   *      keep the errors) and limit (0 for no limit).
+   */
+{
+        sink->entries = NULL;
+        sink->capacity = 0;
+        sink->text = NULL;
+        sink->textSize = 0;
+        sink->stream = stream;
+        sink->limit = limit;
+        diagReset (sink);
+}
+
+void diagSetSource (DiagnosticSink * sink, const char * source, size_t size)
+  /* Postcondition: errors about characters in the size bytes at source
+   *      get their column.
+   */
+{
+        sink->source = source;
+        sink->sourceSize = size;
+}
+
+DiagnosticSink * captureErrors (DiagnosticSink * sink)
+  /* Postcondition: the calling thread's errors now go to sink (or are
+   *      printed, if sink is NULL).
+   * Returns the sink they went to until now, or NULL.
+   */
+{
+        DiagnosticSink * previous = current;
+
+        current = sink;
+        return previous;
+}
+
+DiagnosticSink * errorSink ()
+  /* Returns the sink the calling thread's errors go to, or NULL. */
+{
+        return current;
+}
+
+void reportError (DiagCode code, int line, const char * arg, int argLength)
+  /* Postcondition: the error has been recorded in the calling thread's
+   *      sink (unless it has reached its limit) or printed.
+   */
+{
+        Diagnostic * entry;
+
+        if ( current == NULL )
+        {
+            printError (FORMAT[code], line, argLength, arg);
+            return;
+        }
+        if ( (entry = newEntry (current)) == NULL )
+            return;
+        entry->line = line;
+        entry->column = columnOf (current, arg);
+        entry->code = code;
+        entry->arg = arg;
+        entry->argLength = argLength;
+        entry->text = -1;
+}
+
+int reportMessage (const char * format, va_list ap)
+  /* Postcondition: if the calling thread has a sink, the message has
+   *      been formatted and recorded in it (see printError).
+   * Returns 1 if the thread has a sink; 0 if the message is still to
+   *      be printed.
+   */
+{
+        char    buffer[256];
+        char *  message = buffer;
+        va_list copy;
+        int     length;
+
+        if ( current == NULL )
+            return 0;
+
+        va_copy (copy, ap);
+        length = vsnprintf (buffer, sizeof(buffer), format, copy);
+        va_end (copy);
+        if ( length >= (int) sizeof(buffer) &&
+             (message = malloc (length + 1)) != NULL )
+            (void) vsnprintf (message, length + 1, format, ap);
+        if ( message != NULL && length >= 0 )
+            (void) saveMessage (current, message, length);
+        if ( message != buffer )
+            free (message);
+        return 1;
+}
+
+int errorLimitReached ()
+  /* Returns 1 if the calling thread's sink has as many errors as its
+   *      limit; 0 otherwise.
+   */
+{
+        return current != NULL && current->stopped;
+}
+
+void diagKeepArgs (DiagnosticSink * sink, int first)
+  /* Postcondition: the characters of the entries from entry first on
+   *      that are about the sink's source have been copied into the
+   *      sink's text.
+   */
+{
+        const char * end = sink->source + sink->sourceSize;
+
+        if ( sink->source == NULL )
+            return;
+        for ( int i = first > 0 ? first : 0; i < sink->nbrEntries; i++ )
+        {
+            Diagnostic * entry = &sink->entries[i];
+
+            if ( entry->text >= 0 || entry->arg == NULL ||
+                 entry->arg < sink->source || entry->arg >= end ||
+                 ! growText (sink, entry->argLength) )
+                continue;
+            memcpy (sink->text + sink->textLength, entry->arg,
+                    entry->argLength);
+            entry->text = sink->textLength;
+            sink->textLength += entry->argLength;
+        }
+}
+
+int diagFormat (const DiagnosticSink * sink, int i, char * buffer,
+                size_t size)
+  /* Postcondition: buffer holds (up to size - 1 characters of) the
+   *      message for entry i, null-terminated.
+   * Returns the length of the whole message.
+   */
+{
+        const Diagnostic * entry = &sink->entries[i];
+
+        if ( entry->code == DIAG_MESSAGE )
+            return snprintf (buffer, size, "%.*s", entry->argLength,
+                             sink->text + entry->text);
+        return snprintf (buffer, size, FORMAT[entry->code], entry->line,
+                         entry->argLength, argOf (sink, entry));
+}
+
+int diagFlush (DiagnosticSink * sink)
+  /* Postcondition: if sink has a stream, its entries have been written
+   *      to it (with a note if the limit stopped the program) and sink
+   *      holds none any more.
+   * Returns 1 if everything went OK; 0 if the stream failed.
+   */
+{
+        char   buffer[FLUSH_SIZE];
+        size_t used = 0;
+        int    ok = 1;
+        int    length;
+
+        if ( sink->stream == NULL )
+            return 1;
+
+        /* Format as many messages as fit into the buffer before each
+         * write; a message too long for it on its own is written by
+         * itself.
+         */
+        for ( int i = 0; i < sink->nbrEntries; i++ )
+        {
+            length = diagFormat (sink, i, buffer + used, sizeof(buffer) - used);
+            if ( used + length < sizeof(buffer) )
+            {
+                used += length;
+                continue;
+            }
+            if ( used > 0 )
+                ok &= fwrite (buffer, 1, used, sink->stream) == used;
+            used = 0;
+            length = diagFormat (sink, i, buffer, sizeof(buffer));
+            if ( length < (int) sizeof(buffer) )
+                used = length;
+            else
+            {
+                char * message = malloc (length + 1);
+
+                if ( message != NULL )
+                {
+                    (void) diagFormat (sink, i, message, length + 1);
+                    ok &= fwrite (message, 1, length, sink->stream)
+                          == (size_t) length;
+                }
+                free (message);
+            }
+        }
+        if ( sink->stopped && ! sink->noted )
+        {
+            length = strlen (ERROR1);
+            if ( used + length >= sizeof(buffer) )
+            {
+                ok &= fwrite (buffer, 1, used, sink->stream) == used;
+                used = 0;
+            }
+            memcpy (buffer + used, ERROR1, length);
+            used += length;
+            sink->noted = 1;
+        }
+        if ( used > 0 )
+            ok &= fwrite (buffer, 1, used, sink->stream) == used;
+
+        sink->nbrEntries = 0;
+        sink->forwarded = 0;
+        sink->textLength = 0;
+        return ok;
+}
+
+void diagForward (DiagnosticSink * sink, int mark)
+  /* Postcondition: the entries of sink not forwarded yet, up to entry
+   *      mark (or all of them, if mark is negative), have been reported
+   *      again to the calling thread's sink (or printed), in order.
+   */
+{
+        if ( mark < 0 || mark > sink->nbrEntries )
+            mark = sink->nbrEntries;
+        for ( ; sink->forwarded < mark; sink->forwarded++ )
+        {
+            const Diagnostic * entry = &sink->entries[sink->forwarded];
+            Diagnostic *       copy;
+
+            if ( entry->code == DIAG_MESSAGE )
+            {
+                if ( current == NULL )
+                    printError ("%.*s", entry->argLength,
+                                sink->text + entry->text);
+                else
+                    (void) saveMessage (current, sink->text + entry->text,
+                                        entry->argLength);
+            }
+            else if ( current == NULL )
+                printError (FORMAT[entry->code], entry->line,
+                            entry->argLength, argOf (sink, entry));
+            else if ( (entry->text < 0 ||
+                       growText (current, entry->argLength)) &&
+                      (copy = newEntry (current)) != NULL )
+            {
+                /* A copied argument is copied again, into current. */
+                *copy = *entry;
+                if ( entry->text < 0 )
+                    continue;
+                memcpy (current->text + current->textLength,
+                        sink->text + entry->text, entry->argLength);
+                copy->text = current->textLength;
+                current->textLength += entry->argLength;
+            }
+        }
+}
+
+void diagReset (DiagnosticSink * sink)
+  /* Postcondition: sink holds no errors again, but keeps its memory and
+   *      settings.
+   */
+{
+        sink->nbrEntries = 0;
+        sink->forwarded = 0;
+        sink->nbrErrors = 0;
+        sink->stopped = 0;
+        sink->noted = 0;
+        sink->source = NULL;
+        sink->sourceSize = 0;
+        sink->textLength = 0;
+}
+
+void diagFree (DiagnosticSink * sink)
+  /* Postcondition: the memory used by sink has been released and sink
+   *      is empty again (and keeps its settings).
+   */
+{
+        free (sink->entries);
+        free (sink->text);
+        diagInit (sink, sink->stream, sink->limit);
+}
+
+static Diagnostic * newEntry (DiagnosticSink * sink)
+  /* Returns a new entry at the end of sink (flushing sink first, if it
+   *      is full and has a stream), or NULL if sink has reached its
+   *      limit or memory allocation error.
+   */
+{
+        Diagnostic * entries;
+        int          capacity;
+
+        if ( sink->limit > 0 && sink->nbrErrors >= sink->limit )
+            return NULL;                /* over the limit: dropped */
+        if ( sink->nbrEntries >= sink->capacity && sink->stream != NULL &&
+             sink->capacity > 0 )
+            (void) diagFlush (sink);
+        if ( sink->nbrEntries >= sink->capacity )
+        {
+            capacity = sink->capacity > 0 ? 2 * sink->capacity
+                                          : SINK_CAPACITY;
+            if ( (entries = realloc (sink->entries,
+                                     capacity * sizeof(Diagnostic))) == NULL )
+            {
+                (void) fputs (ERROR0, stderr);
+                return NULL;
+            }
+            sink->entries = entries;
+            sink->capacity = capacity;
+        }
+
+        sink->nbrErrors++;
+        if ( sink->limit > 0 && sink->nbrErrors >= sink->limit )
+            sink->stopped = 1;
+        return &sink->entries[sink->nbrEntries++];
+}
+
+static int columnOf (const DiagnosticSink * sink, const char * arg)
+  /* Returns the column of arg in its line, if it is in the program
+   *      being assembled; 0 otherwise.
+   */
+{
+        const char * start = arg;
+
+        if ( arg == NULL || sink->source == NULL || arg < sink->source ||
+             arg >= sink->source + sink->sourceSize )
+            return 0;
+        while ( start > sink->source && start[-1] != '\n' )
+            start--;
+        return arg - start + 1;
+}
+
+static int saveMessage (DiagnosticSink * sink, const char * message,
+                        int length)
+  /* Postcondition: the message (length characters) has been recorded in
+   *      sink with the code DIAG_MESSAGE, unless the limit was reached.
+   * Returns 1 if it was; 0 if not.
+   */
+{
+        Diagnostic * entry;
+
+        if ( ! growText (sink, length) || (entry = newEntry (sink)) == NULL )
+            return 0;
+
+        /* newEntry may have flushed the text, so copy it afterwards. */
+        memcpy (sink->text + sink->textLength, message, length);
+        entry->line = 0;
+        entry->column = 0;
+        entry->code = DIAG_MESSAGE;
+        entry->arg = NULL;
+        entry->argLength = length;
+        entry->text = sink->textLength;
+        sink->textLength += length;
+        return 1;
+}
+
+static int growText (DiagnosticSink * sink, int length)
+  /* Makes room for length more characters in the text of sink.
+   * Returns 1 if there is room; 0 (after printing an error) if memory
+   *      allocation error.
+   */
+{
+        char * text;
+        int    size = sink->textSize > 0 ? sink->textSize : 1024;
+
+        while ( size < sink->textLength + length )
+            size *= 2;
+        if ( size != sink->textSize )
+        {
+            if ( (text = realloc (sink->text, size)) == NULL )
+            {
+                (void) fputs (ERROR0, stderr);
+                return 0;
+            }
+            sink->text = text;
+            sink->textSize = size;
+        }
+        return 1;
+}
+
+static const char * argOf (const DiagnosticSink * sink,
+                           const Diagnostic * entry)
+  /* Returns the characters entry is about: its copy in the text of
+   *      sink, if it has one, or arg.
+   */
+{
+        return entry->text >= 0 ? sink->text + entry->text : entry->arg;
+}
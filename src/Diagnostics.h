@@ -0,0 +1,186 @@
+/*
+ * Diagnostics: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for the
+ * functions that collect the errors found while assembling a program.
+ * Rather than printing each error as it is found, reportError records
+ * it in a diagnostic sink as a small fixed-size entry -- its line and
+ * column, a code saying which error it is, and the characters of the
+ * source (or label name) it is about -- and nothing is formatted until
+ * the entries are flushed (or a caller asks for the text of one).  A
+ * sink with a stream to write to keeps up to SINK_CAPACITY entries in
+ * preallocated memory and flushes them all at once when it is full,
+ * formatting them into one buffer per write; a sink without a stream
+ * keeps every entry for its owner to look at.
+ *
+ * A sink can have a limit to the number of errors.  Once that many have
+ * been reported, any more are dropped, and errorLimitReached tells the
+ * passes to stop assembling the program (rather than the whole process
+ * exiting, as printError does at ERROR_LIMIT).
+ *
+ * Each thread reports to a sink of its own choosing: captureErrors sets
+ * it.  Messages passed to printError while a thread has a sink are
+ * recorded in it as well (already formatted, with the code
+ * DIAG_MESSAGE) so that they stay in order with the others.  A thread
+ * without a sink has its errors printed by printError right away.
+ *
+ * The characters an entry is about are not copied: they must stay put
+ * (as the source and the label table do) until the sink is flushed,
+ * reset, or freed.  A pass that reuses the memory its source was in
+ * (see streamPass.c) copies them into the sink first, with diagKeepArgs.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added diagKeepArgs.
+ *   Modified:  10/14/2026   Added DIAG_DUPLICATE_LABEL.
+ *
+ */
+
+#ifndef _DIAGNOSTICS_H
+#define _DIAGNOSTICS_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* The errors reportError knows, with the printf format of each.  The
+ * format is given the line number and then (if it has a %.*s) the
+ * length and characters of the entry's argument.
+ */
+#define DIAGNOSTICS \
+        DIAG(MESSAGE,           "%.*s") \
+        DIAG(TOO_MANY_OPERANDS, "Error on line %d: too many operands.\n") \
+        DIAG(TOKEN_TOO_LONG,    "Error on line %d: token is too long.\n") \
+        DIAG(WRONG_NBR_OPERANDS,"Error on line %d: wrong number of operands.\n") \
+        DIAG(UNKNOWN_INSTR,     "Error on line %d: unknown instruction %.*s.\n") \
+        DIAG(INVALID_REGISTER,  "Error on line %d: invalid register %.*s.\n") \
+        DIAG(INVALID_NUMBER,    "Error on line %d: invalid number %.*s.\n") \
+        DIAG(OUT_OF_RANGE,      "Error on line %d: %.*s is out of range.\n") \
+        DIAG(UNDEFINED_LABEL,   "Error on line %d: undefined label %.*s.\n") \
+        DIAG(TOO_FAR,           "Error on line %d: branch target %.*s is too far away.\n") \
+        DIAG(DUPLICATE_LABEL,   "Error on line %d: duplicate label %.*s.\n")
+
+/* Entries a sink with a stream holds before it flushes them. */
+#define SINK_CAPACITY 256
+
+/* THE DATA STRUCTURES */
+
+typedef enum {
+#define DIAG(code, format)  DIAG_##code,
+        DIAGNOSTICS
+#undef DIAG
+        NBR_DIAGNOSTICS
+} DiagCode;
+
+typedef struct {
+        int line;               /* line number (0 if none) */
+        int column;             /* column of arg in its line (1 for the
+                                 * first character), or 0 if unknown */
+        DiagCode code;
+        int argLength;          /* nbr of characters in arg */
+        const char * arg;       /* what the error is about, or NULL */
+        int text;               /* offset of the message (or of the
+                                 * copy of arg) in the sink's text, or
+                                 * -1 if arg is not copied */
+} Diagnostic;
+
+typedef struct {
+        Diagnostic * entries;
+        int nbrEntries;         /* nbr of entries held */
+        int capacity;           /* nbr of entries the memory can hold */
+        int forwarded;          /* nbr of entries diagForward has done */
+        int nbrErrors;          /* nbr of errors kept (or flushed) */
+        int limit;              /* nbr of errors at which to stop, or 0 */
+        int stopped;            /* 1 once it has reached its limit */
+        int noted;              /* 1 once diagFlush has said so */
+        FILE * stream;          /* where diagFlush writes, or NULL */
+        const char * source;    /* the program the errors are in */
+        size_t sourceSize;
+        char * text;            /* the DIAG_MESSAGE messages */
+        int textLength;
+        int textSize;
+} DiagnosticSink;
+
+
+/* THE FUNCTIONS */
+
+void diagInit (DiagnosticSink * sink, FILE * stream, int limit);
+        /* Postcondition: sink is empty, with the given stream (or NULL,
+         *      to keep the errors) and limit (0 for no limit).
+         */
+
+void diagSetSource (DiagnosticSink * sink, const char * source,
+                    size_t size);
+        /* Postcondition: errors about characters in the size bytes at
+         *      source (the program being assembled) get their column.
+         */
+
+DiagnosticSink * captureErrors (DiagnosticSink * sink);
+        /* Postcondition: the errors reported on the calling thread (only)
+         *      now go to sink or, if sink is NULL, are printed by
+         *      printError.
+         * Returns the sink they went to until now, or NULL.
+         */
+
+DiagnosticSink * errorSink ();
+        /* Returns the sink the calling thread's errors go to, or NULL. */
+
+void reportError (DiagCode code, int line, const char * arg,
+                  int argLength);
+        /* Postcondition: the error has been recorded in the calling
+         *      thread's sink (unless it has reached its limit) or, if
+         *      there is none, printed by printError.
+         */
+
+int reportMessage (const char * format, va_list ap);
+        /* Postcondition: if the calling thread has a sink, the message
+         *      (formatted as by vprintf) has been recorded in it as a
+         *      DIAG_MESSAGE.  (printError calls this.)
+         * Returns 1 if the thread has a sink; 0 if not, in which case
+         *      the message is still to be printed.
+         */
+
+int errorLimitReached ();
+        /* Returns 1 if the calling thread's sink has as many errors as
+         *      its limit, so that assembly should stop; 0 otherwise.
+         */
+
+void diagKeepArgs (DiagnosticSink * sink, int first);
+        /* Postcondition: the characters of the entries of sink from
+         *      entry first on that are about its source (see
+         *      diagSetSource) have been copied into its own memory, so
+         *      that the source may be overwritten or released.
+         */
+
+int diagFormat (const DiagnosticSink * sink, int i, char * buffer,
+                size_t size);
+        /* Postcondition: buffer holds (up to size - 1 characters of) the
+         *      message for entry i, null-terminated.
+         * Returns the length of the whole message.
+         */
+
+int diagFlush (DiagnosticSink * sink);
+        /* Postcondition: if sink has a stream, its entries have been
+         *      written to it in order (followed, if the limit stopped the
+         *      program, by a note saying so) and sink holds none any
+         *      more; its count of errors is unchanged.
+         * Returns 1 if everything went OK; 0 if the stream failed.
+         */
+
+void diagForward (DiagnosticSink * sink, int mark);
+        /* Postcondition: the entries of sink not forwarded yet, up to
+         *      (not including) entry mark, or all of them if mark is
+         *      negative, have been reported again to the calling
+         *      thread's sink (or printed, if it has none), in order.
+         */
+
+void diagReset (DiagnosticSink * sink);
+        /* Postcondition: sink holds no errors again, but keeps its
+         *      memory and settings.
+         */
+
+void diagFree (DiagnosticSink * sink);
+        /* Postcondition: the memory used by sink has been released and
+         *      sink is empty again (and keeps its settings).
+         */
+
+#endif
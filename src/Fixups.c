@@ -0,0 +1,203 @@
+/*
+ * Fixups: functions to record and patch forward references
+ *
+ * This file provides the definitions of the functions declared in
+ * Fixups.h.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added resolveFixups and releaseOutput.
+ *
+ */
+
+#include <stdlib.h>
+
+#include "Fixups.h"
+#include "printFuncs.h"
+#include "Diagnostics.h"
+#include "Stats.h"
+
+// internal global variables (global to this file only)
+static const char * ERROR0 = "Error: cannot allocate space in memory.\n";
+
+static const int INSTRUCTION_SIZE = 4;		/* in bytes */
+
+// internal functions (visible to this file only)
+static int patchWord (const Fixup * fixup, const LabelEntry * label,
+                      OutputSink * out);
+
+void fixupInit (FixupList * list)
+  /* Postcondition: list is empty. */
+{
+        list->nbrFixups = 0;
+        list->capacity = 0;
+        list->fixups = NULL;
+}
+
+int addFixup (FixupList * list, int symbol, long word, int PC, int line,
+              char opType)
+  /* Postcondition: a fixup for the given label (symbol) and word of
+   *      the output has been added to the list.
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      memory allocation error.
+   */
+{
+        Fixup * fixups;
+        int     capacity;
+
+        if ( list->nbrFixups >= list->capacity )
+        {
+            capacity = list->capacity > 0 ? 2 * list->capacity : 64;
+            countStat (STAT_BYTES, capacity * sizeof(Fixup));
+            fixups = realloc (list->fixups, capacity * sizeof(Fixup));
+            if ( fixups == NULL )
+            {
+                printError ("%s", ERROR0);
+                return 0;
+            }
+            list->fixups = fixups;
+            list->capacity = capacity;
+        }
+
+        list->fixups[list->nbrFixups].symbol = symbol;
+        list->fixups[list->nbrFixups].word = word;
+        list->fixups[list->nbrFixups].PC = PC;
+        list->fixups[list->nbrFixups].line = line;
+        list->fixups[list->nbrFixups].opType = opType;
+        list->fixups[list->nbrFixups].value = 0;
+        list->nbrFixups++;
+        return 1;
+}
+
+int applyFixups (FixupList * list, LabelTable * table, OutputSink * out)
+  /* Postcondition: the offset or target of every word in the list has
+   *      been filled in from the complete label table; fixups for
+   *      labels that are still undefined, or for branches that would
+   *      be too far, have been reported as errors.
+   * Returns the number of errors.
+   */
+{
+        int nbrErrors = 0;
+
+        for ( int i = 0; i < list->nbrFixups; i++ )
+        {
+            Fixup *      fixup = &list->fixups[i];
+            LabelEntry * label = tableEntry (table, fixup->symbol);
+
+            if ( errorLimitReached () )
+                break;          /* too many errors: stop */
+            if ( fixup->word >= out->nbrDropped + out->nbrWords )
+                continue;       /* the word itself was never output */
+
+            if ( label->address == UNDEFINED_ADDRESS )
+            {
+                reportError (DIAG_UNDEFINED_LABEL, fixup->line, label->label,
+                             label->length);
+                nbrErrors++;
+            }
+            else if ( ! patchWord (fixup, label, out) )
+                nbrErrors++;
+        }
+
+        return nbrErrors;
+}
+
+int resolveFixups (FixupList * list, LabelTable * table, OutputSink * out)
+  /* Postcondition: the words of the fixups whose labels are defined
+   *      have been patched (or reported as too far), and those fixups
+   *      removed from the list; the others keep their order.
+   * Returns the number of errors.
+   */
+{
+        int nbrErrors = 0;
+        int nbrLeft = 0;
+
+        for ( int i = 0; i < list->nbrFixups; i++ )
+        {
+            Fixup *      fixup = &list->fixups[i];
+            LabelEntry * label = tableEntry (table, fixup->symbol);
+
+            if ( fixup->word >= out->nbrDropped + out->nbrWords )
+                continue;       /* the word itself was never output */
+            if ( label->address == UNDEFINED_ADDRESS )
+                list->fixups[nbrLeft++] = *fixup;   /* not yet */
+            else if ( ! patchWord (fixup, label, out) )
+                nbrErrors++;
+        }
+
+        list->nbrFixups = nbrLeft;
+        return nbrErrors;
+}
+
+int releaseOutput (FixupList * list, OutputSink * out)
+  /* Postcondition: the words of out that no fixup in the list needs in
+   *      memory any more have been written out and dropped.
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      the output could not be written.
+   */
+{
+        long end = out->nbrDropped + out->nbrWords;
+
+        if ( list->nbrFixups == 0 )
+            return outputRelease (out, 0);
+        if ( ! outputCanPatch (out) )
+            /* the fixups are in the order of their words */
+            return outputRelease (out, end - list->fixups[0].word);
+
+        /* Keep the words of the fixups, to patch them in the file. */
+        for ( int i = list->nbrFixups - 1; i >= 0; i-- )
+        {
+            Fixup * fixup = &list->fixups[i];
+
+            if ( fixup->word < out->nbrDropped )
+                break;          /* and so are all the ones before it */
+            fixup->value = out->words[fixup->word - out->nbrDropped];
+        }
+        return outputRelease (out, 0);
+}
+
+void fixupReset (FixupList * list)
+  /* Postcondition: list is empty again, but keeps its memory. */
+{
+        list->nbrFixups = 0;
+}
+
+void fixupFree (FixupList * list)
+  /* Postcondition: the memory used by list has been released and list
+   *      is empty again.
+   */
+{
+        free (list->fixups);
+        fixupInit (list);
+}
+
+static int patchWord (const Fixup * fixup, const LabelEntry * label,
+                      OutputSink * out)
+  /* Fills the offset or target of the (defined) label into the word of
+   * the fixup, wherever it is (see outputPatch).  Returns 1 if
+   * everything went OK; 0 (after reporting an error) if the branch
+   * would be too far, or the word could not be written.
+   */
+{
+        uint32_t word = fixup->word >= out->nbrDropped
+                        ? out->words[fixup->word - out->nbrDropped]
+                        : fixup->value;
+        int      offset;
+
+        if ( fixup->opType == 'I' )
+        {
+            /* the offset is in instructions, from the next one */
+            offset = (label->address - (fixup->PC + INSTRUCTION_SIZE))
+                     / INSTRUCTION_SIZE;
+            if ( offset < -32768 || offset > 32767 )
+            {
+                reportError (DIAG_TOO_FAR, fixup->line, label->label,
+                             label->length);
+                return 0;
+            }
+            word |= offset & 0xffff;
+        }
+        else
+            word |= (uint32_t) label->address / INSTRUCTION_SIZE & 0x3ffffff;
+
+        return outputPatch (out, fixup->word, word);
+}
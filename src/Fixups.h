@@ -0,0 +1,99 @@
+/*
+ * Fixups: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for the
+ * functions that keep track of forward references when a program is
+ * assembled in a single pass.  A branch or jump to a label that has not
+ * been defined yet is encoded with a zero offset or target, and a fixup
+ * is recorded for it, keyed by the label's position in the label table
+ * (see referenceLabelLen in LabelTable.h).  Once the whole program has
+ * been read, and the label table is complete, applyFixups patches the
+ * offset or target into each of those words in the output.
+ *
+ * A program assembled as it streams in (see streamPass.c) patches the
+ * forward references every so often, with resolveFixups, as soon as
+ * their labels have been defined, and only keeps the rest in the list.
+ * releaseOutput then writes out and drops the words that no fixup still
+ * needs in memory.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added resolveFixups and releaseOutput.
+ *
+ */
+
+#ifndef _FIXUPS_H
+#define _FIXUPS_H
+
+#include "LabelTable.h"
+#include "OutputSink.h"
+
+/* THE DATA STRUCTURES */
+
+typedef struct {
+        int  symbol;            /* position of the label in the table */
+        long word;              /* position of the word in the output
+                                 * (see OutputSink.h) */
+        int  PC;                /* address of the instruction */
+        int  line;              /* line number, for error messages */
+        char opType;            /* 'I' (branch offset) or 'J' (target) */
+        uint32_t value;         /* the word, once releaseOutput has
+                                 * dropped it from the output's memory */
+} Fixup;
+
+typedef struct {
+        int     nbrFixups;      /* actual nbr of fixups in the list */
+        int     capacity;       /* capacity of the list */
+        Fixup * fixups;
+} FixupList;
+
+
+/* THE FUNCTIONS */
+
+void fixupInit (FixupList * list);
+        /* Postcondition: list is empty. */
+
+int addFixup (FixupList * list, int symbol, long word, int PC, int line,
+              char opType);
+        /* Postcondition: a fixup for the given label (symbol) and word
+         *      of the output has been added to the list.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if memory allocation error.
+         */
+
+int applyFixups (FixupList * list, LabelTable * table, OutputSink * out);
+        /* Postcondition: the offset or target of every word in the list
+         *      has been filled in from the complete label table; fixups
+         *      for labels that are still undefined, or for branches that
+         *      would be too far, have been reported as errors.
+         * Returns the number of errors.
+         */
+
+int resolveFixups (FixupList * list, LabelTable * table, OutputSink * out);
+        /* Postcondition: the offset or target of every word in the list
+         *      whose label has been defined by now has been filled in
+         *      (or, for a branch that would be too far, reported as an
+         *      error), and its fixup removed from the list; the others
+         *      are still in the list, in the same order.
+         * Returns the number of errors.
+         */
+
+int releaseOutput (FixupList * list, OutputSink * out);
+        /* Postcondition: the words of out have been written out and
+         *      dropped from memory (see outputRelease) as far as the
+         *      fixups in the list allow: all of them, if out can patch
+         *      them in the output file afterwards (see outputCanPatch),
+         *      with the words of the fixups kept in the list; otherwise
+         *      the words before the word of the first fixup.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if the output could not be written.
+         */
+
+void fixupReset (FixupList * list);
+        /* Postcondition: list is empty again, but keeps its memory. */
+
+void fixupFree (FixupList * list);
+        /* Postcondition: the memory used by list has been released and
+         *      list is empty again.
+         */
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Intermediate Representation: functions to build and release the
+ * array of parsed instructions
+ *
+ * This file provides the definitions of the functions declared in
+ * IR.h.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added the scratch arena.
+ *
+ */
+
+#include <stdlib.h>
+
+#include "IR.h"
+#include "printFuncs.h"
+#include "Stats.h"
+
+// internal global variables (global to this file only)
+static const char * ERROR0 = "Error: cannot allocate space in memory.\n";
+
+static const int FIRST_CAPACITY = 1024;         /* in instructions */
+
+/* Sizes of the chunks of the scratch arena (see Arena.h). */
+static const size_t FIRST_SCRATCH_SIZE = 16 * 1024;
+static const size_t MAX_SCRATCH_SIZE = 1024 * 1024;
+
+void irInit (IRProgram * program)
+  /* Postcondition: program is empty. */
+{
+        program->instrs = NULL;
+        program->nbrInstrs = 0;
+        program->capacity = 0;
+        program->nbrErrors = 0;
+        arenaInit (&program->scratch, FIRST_SCRATCH_SIZE, MAX_SCRATCH_SIZE);
+}
+
+int irAppend (IRProgram * program, const IRInstr * instr)
+  /* Postcondition: a copy of instr has been added to the end of the
+   *      program (and counted as an error if it is invalid).
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      memory allocation error.
+   */
+{
+        IRInstr * instrs;
+        int       capacity;
+
+        if ( program->nbrInstrs >= program->capacity )
+        {
+            capacity = program->capacity > 0 ? 2 * program->capacity
+                                             : FIRST_CAPACITY;
+            countStat (STAT_BYTES, capacity * sizeof(IRInstr));
+            instrs = realloc (program->instrs, capacity * sizeof(IRInstr));
+            if ( instrs == NULL )
+            {
+                printError ("%s", ERROR0);
+                return 0;
+            }
+            program->instrs = instrs;
+            program->capacity = capacity;
+        }
+
+        program->instrs[program->nbrInstrs++] = *instr;
+        if ( instr->id == IR_INVALID )
+            program->nbrErrors++;
+        return 1;
+}
+
+void irReset (IRProgram * program)
+  /* Postcondition: program is empty again, but keeps its memory for the
+   *      next program.
+   */
+{
+        program->nbrInstrs = 0;
+        program->nbrErrors = 0;
+        arenaReset (&program->scratch);
+}
+
+void irFree (IRProgram * program)
+  /* Postcondition: the memory used by program has been released and
+   *      program is empty again.
+   */
+{
+        free (program->instrs);
+        arenaFree (&program->scratch);
+        irInit (program);
+}
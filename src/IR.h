@@ -0,0 +1,88 @@
+/*
+ * Intermediate Representation: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for the
+ * functions that hold a program between the two passes of the
+ * assembler.  pass1 parses each instruction into a small fixed-size
+ * record (see parseLine) and appends it to an IRProgram; pass2 then
+ * only has to encode the records, one after another, without looking
+ * at the source again.  Record i is the instruction at address 4 * i.
+ *
+ * A record holds everything the instruction needs to be encoded: its
+ * opcode id (OP_add, OP_lw, ...; see Instructions.h), its register
+ * numbers, its immediate value (or shift amount), and for a branch or
+ * jump, the position of the target label in the label table, which
+ * need not have been defined yet when the record was made.  An
+ * instruction that could not be parsed keeps its place in the program
+ * (so that the addresses of the instructions after it are right), with
+ * the id IR_INVALID, and its place in the output, as PLACEHOLDER_WORD.
+ *
+ * A program also has a scratch arena (see Arena.h) for the working
+ * arrays the passes need while they build and encode it, which are not
+ * freed one by one: irReset empties it, in constant time, along with
+ * the records, so the next program reuses its memory.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added the scratch arena.
+ *   Modified:  10/14/2026   Added PLACEHOLDER_WORD.
+ *
+ */
+
+#ifndef _IR_H
+#define _IR_H
+
+#include <stdint.h>
+
+#include "Arena.h"
+
+/* The id of an instruction that could not be parsed (the error has
+ * already been reported).
+ */
+#define IR_INVALID 0xff
+
+/* The word output in its place (sll $zero, $zero, 0: a nop). */
+#define PLACEHOLDER_WORD 0
+
+/* THE DATA STRUCTURES */
+
+typedef struct {
+        uint8_t id;             /* opcode id, or IR_INVALID */
+        uint8_t rs, rt, rd;     /* register numbers (0 if not used) */
+        int32_t imm;            /* immediate value or shift amount */
+        int32_t symbol;         /* label table entry of the target, or -1 */
+        int32_t line;           /* line number, for error messages */
+} IRInstr;
+
+typedef struct {
+        IRInstr * instrs;       /* the instructions, in address order */
+        int nbrInstrs;          /* actual nbr of instructions */
+        int capacity;           /* nbr of instructions instrs can hold */
+        int nbrErrors;          /* nbr of instructions that are invalid */
+        Arena scratch;          /* the passes' working memory, for as
+                                 * long as the program is held */
+} IRProgram;
+
+
+/* THE FUNCTIONS */
+
+void irInit (IRProgram * program);
+        /* Postcondition: program is empty. */
+
+int irAppend (IRProgram * program, const IRInstr * instr);
+        /* Postcondition: a copy of instr has been added to the end of
+         *      the program (and counted as an error if it is invalid).
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if memory allocation error.
+         */
+
+void irReset (IRProgram * program);
+        /* Postcondition: program is empty again (and so is its scratch
+         *      arena), but keeps its memory for the next program.
+         */
+
+void irFree (IRProgram * program);
+        /* Postcondition: the memory used by program has been released
+         *      and program is empty again.
+         */
+
+#endif
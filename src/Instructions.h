@@ -0,0 +1,132 @@
+/*
+ * Instructions: the table of MIPS instructions the assembler knows
+ *
+ * This file describes every supported instruction exactly once, in the
+ * MIPS_INSTRUCTIONS list below.  Each entry gives
+ *      the mnemonic (as an identifier, e.g., add),
+ *      the operand form (see INSTRUCTION_FORMS), which also gives the
+ *      instruction type ('R', 'I', or 'J'),
+ *      the opcode (for I and J types) or funct number (for R type), and
+ *      the characters of the mnemonic, one by one.
+ * The characters are spelled out so that the mnemonic can be packed
+ * into a 64-bit integer at compile time (see PACK_MNEMONIC), allowing
+ * getOpType to find a mnemonic with a perfect hash of that integer.
+ *
+ * The forms are listed once as well, in INSTRUCTION_FORMS.  Each one
+ * gives the operands of the instructions of that form, in the order
+ * they are written; the instruction type; and the function that packs
+ * them into a word.  assemble.c has a parser for each form, which fixes
+ * the order of the operands and the range of any immediate value, and
+ * it dispatches each instruction to its form's parser and encoder by
+ * opcode id.
+ *
+ * The lists are "X-macros": code that needs something from each entry
+ * defines INSTR (or FORM) to pick out what it needs, expands the list,
+ * and then undefines INSTR (or FORM) again.  For example, the
+ * enumeration of opcode ids below is generated that way.  To add an
+ * instruction, add one line to MIPS_INSTRUCTIONS (and, if none of the
+ * forms fits it, one line to INSTRUCTION_FORMS and a parser for it).
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added the operand forms.
+ *
+ */
+
+#ifndef _INSTRUCTIONS_H
+#define _INSTRUCTIONS_H
+
+#include <stdint.h>
+
+/*      form          type  encoder          operands, in order */
+#define INSTRUCTION_FORMS \
+    FORM(RD_RS_RT,    'R',  encodeR)         /* $rd, $rs, $rt */ \
+    FORM(RD_RT_SHAMT, 'R',  encodeR)         /* $rd, $rt, 0..31 */ \
+    FORM(RD_RT_RS,    'R',  encodeR)         /* $rd, $rt, $rs */ \
+    FORM(RS,          'R',  encodeR)         /* $rs */ \
+    FORM(RD_OPT_RS,   'R',  encodeR)         /* [$rd,] $rs  ($ra) */ \
+    FORM(RD,          'R',  encodeR)         /* $rd */ \
+    FORM(RS_RT,       'R',  encodeR)         /* $rs, $rt */ \
+    FORM(NONE,        'R',  encodeR)         /* (none) */ \
+    FORM(RS_RT_LABEL, 'I',  encodeBranch)    /* $rs, $rt, label */ \
+    FORM(RS_LABEL,    'I',  encodeBranch)    /* $rs, label */ \
+    FORM(RT_RS_IMM,   'I',  encodeImmediate) /* $rt, $rs, signed */ \
+    FORM(RT_RS_UIMM,  'I',  encodeImmediate) /* $rt, $rs, unsigned */ \
+    FORM(RT_UPPER,    'I',  encodeImmediate) /* $rt, signed or unsigned */ \
+    FORM(RT_MEM,      'I',  encodeImmediate) /* $rt, [signed]($rs) */ \
+    FORM(LABEL,       'J',  encodeJump)      /* label */
+
+/*      mnemonic  form         code  characters of mnemonic */
+#define MIPS_INSTRUCTIONS \
+    INSTR(add,     RD_RS_RT,    0x20, 'a','d','d') \
+    INSTR(addu,    RD_RS_RT,    0x21, 'a','d','d','u') \
+    INSTR(sub,     RD_RS_RT,    0x22, 's','u','b') \
+    INSTR(subu,    RD_RS_RT,    0x23, 's','u','b','u') \
+    INSTR(and,     RD_RS_RT,    0x24, 'a','n','d') \
+    INSTR(or,      RD_RS_RT,    0x25, 'o','r') \
+    INSTR(xor,     RD_RS_RT,    0x26, 'x','o','r') \
+    INSTR(nor,     RD_RS_RT,    0x27, 'n','o','r') \
+    INSTR(slt,     RD_RS_RT,    0x2a, 's','l','t') \
+    INSTR(sltu,    RD_RS_RT,    0x2b, 's','l','t','u') \
+    INSTR(sll,     RD_RT_SHAMT, 0x00, 's','l','l') \
+    INSTR(srl,     RD_RT_SHAMT, 0x02, 's','r','l') \
+    INSTR(sra,     RD_RT_SHAMT, 0x03, 's','r','a') \
+    INSTR(sllv,    RD_RT_RS,    0x04, 's','l','l','v') \
+    INSTR(srlv,    RD_RT_RS,    0x06, 's','r','l','v') \
+    INSTR(srav,    RD_RT_RS,    0x07, 's','r','a','v') \
+    INSTR(jr,      RS,          0x08, 'j','r') \
+    INSTR(jalr,    RD_OPT_RS,   0x09, 'j','a','l','r') \
+    INSTR(syscall, NONE,        0x0c, 's','y','s','c','a','l','l') \
+    INSTR(mfhi,    RD,          0x10, 'm','f','h','i') \
+    INSTR(mthi,    RS,          0x11, 'm','t','h','i') \
+    INSTR(mflo,    RD,          0x12, 'm','f','l','o') \
+    INSTR(mtlo,    RS,          0x13, 'm','t','l','o') \
+    INSTR(mult,    RS_RT,       0x18, 'm','u','l','t') \
+    INSTR(multu,   RS_RT,       0x19, 'm','u','l','t','u') \
+    INSTR(div,     RS_RT,       0x1a, 'd','i','v') \
+    INSTR(divu,    RS_RT,       0x1b, 'd','i','v','u') \
+    INSTR(beq,     RS_RT_LABEL, 0x04, 'b','e','q') \
+    INSTR(bne,     RS_RT_LABEL, 0x05, 'b','n','e') \
+    INSTR(blez,    RS_LABEL,    0x06, 'b','l','e','z') \
+    INSTR(bgtz,    RS_LABEL,    0x07, 'b','g','t','z') \
+    INSTR(addi,    RT_RS_IMM,   0x08, 'a','d','d','i') \
+    INSTR(addiu,   RT_RS_IMM,   0x09, 'a','d','d','i','u') \
+    INSTR(slti,    RT_RS_IMM,   0x0a, 's','l','t','i') \
+    INSTR(sltiu,   RT_RS_IMM,   0x0b, 's','l','t','i','u') \
+    INSTR(andi,    RT_RS_UIMM,  0x0c, 'a','n','d','i') \
+    INSTR(ori,     RT_RS_UIMM,  0x0d, 'o','r','i') \
+    INSTR(xori,    RT_RS_UIMM,  0x0e, 'x','o','r','i') \
+    INSTR(lui,     RT_UPPER,    0x0f, 'l','u','i') \
+    INSTR(lb,      RT_MEM,      0x20, 'l','b') \
+    INSTR(lh,      RT_MEM,      0x21, 'l','h') \
+    INSTR(lw,      RT_MEM,      0x23, 'l','w') \
+    INSTR(lbu,     RT_MEM,      0x24, 'l','b','u') \
+    INSTR(lhu,     RT_MEM,      0x25, 'l','h','u') \
+    INSTR(sb,      RT_MEM,      0x28, 's','b') \
+    INSTR(sh,      RT_MEM,      0x29, 's','h') \
+    INSTR(sw,      RT_MEM,      0x2b, 's','w') \
+    INSTR(j,       LABEL,       0x02, 'j') \
+    INSTR(jal,     LABEL,       0x03, 'j','a','l')
+
+/* The opcode ids: OP_add, OP_addu, ..., in the order of the list. */
+#define INSTR(name, form, code, ...)  OP_##name,
+enum { MIPS_INSTRUCTIONS NBR_OPCODES };
+#undef INSTR
+
+/* The type of each form, as a constant: FORM_TYPE_RD_RS_RT is 'R', ...
+ * (so that FORM_TYPE_##form gives the type of an instruction).
+ */
+#define FORM(form, type, encoder)  FORM_TYPE_##form = type,
+enum { INSTRUCTION_FORMS };
+#undef FORM
+
+/* Pack up to 8 characters into a 64-bit integer, first character in
+ * the lowest byte; missing characters are 0.
+ */
+#define PACK_MNEMONIC(...)  PACK_MNEMONIC8(__VA_ARGS__, 0, 0, 0, 0, 0, 0, 0, 0)
+#define PACK_MNEMONIC8(c0, c1, c2, c3, c4, c5, c6, c7, ...) \
+        ((uint64_t) (c0)       | (uint64_t) (c1) << 8  | \
+         (uint64_t) (c2) << 16 | (uint64_t) (c3) << 24 | \
+         (uint64_t) (c4) << 32 | (uint64_t) (c5) << 40 | \
+         (uint64_t) (c6) << 48 | (uint64_t) (c7) << 56)
+
+#endif
@@ -12,18 +12,47 @@
  *   Modified:  4/19/2013    Modernized call to fprintf for errors.
  *   Modified:  5/25/2015    Updated to use printError function.
  *   Modified:	4/29/1994 	Updated addlabel, and find label (roderick Vogel
+ *   Modified:  10/14/2026   Added hash index used by addLabel and findLabel.
+ *   Modified:  10/14/2026   Intern label names in a string arena; tableFree.
+ *   Modified:  10/14/2026   Probe on cached hashes and lengths first.
+ *   Modified:  10/14/2026   Added addLabelLen and findLabelLen.
+ *   Modified:  10/14/2026   Added referenceLabelLen (undefined entries).
+ *   Modified:  10/14/2026   Pass calls on concurrent tables on; tableEntry.
+ *   Modified:  10/14/2026   Keep each slot's hash in the slot (IndexSlot).
+ *   Modified:  10/14/2026   Report duplicates on their line (reportError).
+ *   Modified:  10/14/2026   Added tableReset.
+ *   Modified:  10/14/2026   Count lookups, probes, and resizes (Stats.h).
+ *   Modified:  10/14/2026   Added tableInitWithCapacity and tableReserve;
+ *                           tableResize grows the entries in place.
+ *   Modified:  10/14/2026   Keep the names in an Arena; tableReset keeps
+ *                           all of its blocks.
 
 */
 
 #include "assembler.h"
+#include "ConcurrentLabelTable.h"
 
 // internal global variables (global to this file only)
 static const char * ERROR0 = "Error: no label table exists.\n";
 static const char * ERROR1 = "Error: a duplicate label was found.\n";
 static const char * ERROR2 = "Error: cannot allocate space in memory.\n";
 
-// internal function (visible to this file only)
+/* Sizes of the blocks in the names' arena: the first block is small,
+ * and each new block is twice as big as the last, up to a maximum.
+ */
+static const size_t FIRST_BLOCK_SIZE = 4096;
+static const size_t MAX_BLOCK_SIZE = 1024 * 1024;
+
+// internal functions (visible to this file only)
 static int verifyTableExists(LabelTable * table);
+static unsigned hashLabel(const char * label, int length);
+static int findSlot(LabelTable * table, const char * label,
+                    unsigned hash, int length);
+static int rebuildIndex(LabelTable * table, int minSlots, int always);
+static void emptyIndex(LabelTable * table);
+static void reportDuplicate(const char * label, int length, int line);
+static int insertLabel(LabelTable * table, const char * label, int length,
+                       unsigned hash, int slot, int PC);
 
 void tableInit (LabelTable * table)
   /* Postcondition: table is initialized to indicate that there
@@ -41,6 +70,86 @@ void tableInit (LabelTable * table)
         entries = malloc(sizeof(LabelEntry));
         table->entries = entries;
         table->nbrLabels =0;
+        table->indexSize = 0;
+        table->index = NULL;
+        arenaInit (&table->names, FIRST_BLOCK_SIZE, MAX_BLOCK_SIZE);
+        table->concurrent = NULL;
+}
+
+int tableInitWithCapacity (LabelTable * table, int capacity)
+  /* Postcondition: table is initialized with no label entries in it,
+   *       with room for capacity entries.
+   * Returns 1 if everything went OK; 0 (with table initialized, but
+   *       empty) if memory allocation error.
+   */
+{
+        tableInit (table);
+        return table == NULL || capacity <= 0 || tableResize (table, capacity);
+}
+
+int tableInitConcurrent (LabelTable * table)
+  /* Postcondition: table is initialized with no label entries in it,
+   *       as a concurrent table (see ConcurrentLabelTable.c).
+   * Returns 1 if everything went OK; 0 (with table initialized as an
+   *       ordinary table) if memory allocation error.
+   */
+{
+        /* verify that current table exists */
+        if ( ! verifyTableExists (table) )
+            return 0;           /* fatal error: table doesn't exist */
+
+        tableInit (table);
+        table->concurrent = concurrentInit ();
+        return table->concurrent != NULL;
+}
+
+void tableFree (LabelTable * table)
+  /* Postcondition: all memory used by the table, including the
+   *       interned label names, has been released and the table
+   *       is once again initialized with no label entries in it.
+   */
+{
+        /* verify that current table exists */
+        if ( ! verifyTableExists (table) )
+            return;           /* fatal error: table doesn't exist */
+
+        if ( table->concurrent != NULL )
+            concurrentFree (table->concurrent);
+        table->concurrent = NULL;
+
+        /* the names were never freed one at a time, so free the blocks */
+        arenaFree (&table->names);
+
+        free (table->entries);
+        free (table->index);
+        table->capacity = 0;
+        table->nbrLabels = 0;
+        table->entries = NULL;
+        table->indexSize = 0;
+        table->index = NULL;
+}
+
+void tableReset (LabelTable * table)
+  /* Postcondition: the table has no label entries in it again, but
+   *       keeps its memory for the next program.
+   */
+{
+        /* verify that current table exists */
+        if ( ! verifyTableExists (table) )
+            return;           /* fatal error: table doesn't exist */
+
+        if ( table->concurrent != NULL )
+        {
+            tableFree (table);
+            (void) tableInitConcurrent (table);
+            return;
+        }
+
+        /* keep the blocks of names, to be filled again from the first */
+        arenaReset (&table->names);
+
+        table->nbrLabels = 0;
+        emptyIndex (table);
 }
 
 void printLabels (LabelTable * table)
@@ -60,7 +169,7 @@ void printLabels (LabelTable * table)
 
             for ( int i = 0; i<table->nbrLabels; i++)
             {
-            	printf("table name: %s                     Address: %d\n", table->entries[i].label,table->entries[i].address);
+            	printf("table name: %s                     Address: %d\n", tableEntry(table, i)->label,tableEntry(table, i)->address);
             }
         }
 }
@@ -76,16 +185,30 @@ int findLabel (LabelTable * table, char * label)
 			}
 	else
 	{
+        return findLabelLen(table, label, strlen(label));
+	}
+}
 
-        for (int i=0; i<table->nbrLabels; i++)
+int findLabelLen (LabelTable * table, const char * label, int length)
+  /* Returns the address associated with the first length characters
+   *      of label; -1 if that label is not in the table or table
+   *      doesn't exist
+   */
+{
+        if ( ! verifyTableExists (table) )
+            return -1;
+
+        unsigned hash = hashLabel(label, length);
+
+        if ( table->concurrent != NULL )
+            return concurrentFind (table, label, length, hash);
+
+        int slot = findSlot(table, label, hash, length);
+        if ( slot >= 0 && table->index[slot].entry >= 0 )
         {
-        	if(strcmp(table->entries[i].label,label)== SAME)
-        	{
-        		return table->entries[i].address;
-        	}
+        	return table->entries[table->index[slot].entry].address;
         }
-       return -1;
-	}
+        return -1;
 }
 
 int addLabel (LabelTable * table, char * label, int PC)
@@ -97,43 +220,84 @@ int addLabel (LabelTable * table, char * label, int PC)
    *      or table doesn't exist.
    */
 {
-        char * labelDuplicate;
+        /* verify that current table exists */
+        if ( ! verifyTableExists (table) )
+            return 0;           /* fatal error: table doesn't exist */
+
+        return addLabelLen (table, label, strlen (label), PC, 0);
+}
 
+int addLabelLen (LabelTable * table, const char * label, int length, int PC,
+                 int line)
+  /* Postcondition: works exactly like addLabel, for the label name made
+   *      up of the first length characters of label, defined on the
+   *      given line (0 if unknown), which an error about a duplicate
+   *      label is reported with.
+   */
+{
+        LabelEntry * entry;
+        int          slot;
+        unsigned     hash;
 
         /* verify that current table exists */
         if ( ! verifyTableExists (table) )
             return 0;           /* fatal error: table doesn't exist */
-        /* Create a dynamically allocated version of label that will persist. */
-        /*   NOTE: on some machines you may need to make this _strdup !  */
-        if ((labelDuplicate = strdup (label)) == NULL)
-        {
-            printError ("%s", ERROR1);
-            return 0;           /* fatal error: couldn't allocate memory */
-        }
 
         /* Was the label already in the table? */
-        if ( findLabel(table, label) != -1 )  /* REAL CODE MISSING ! */
+        countStat (STAT_LABELS_ADDED, 1);
+        hash = hashLabel(label, length);
+        if ( table->concurrent != NULL )
+        {
+            int added = concurrentAdd (table, label, length, hash, PC);
+
+            if ( added == 2 )
+                reportDuplicate (label, length, line);
+            return added != 0;
+        }
+        slot = findSlot(table, label, hash, length);
+        if ( slot >= 0 && table->index[slot].entry >= 0 )
         {
-            /* This is an error (ERROR1), but not a fatal one.
+            entry = &table->entries[table->index[slot].entry];
+
+            /* A label that was referenced before it was defined. */
+            if ( entry->address == UNDEFINED_ADDRESS )
+            {
+                entry->address = PC;
+                return 1;
+            }
+
+            /* This is an error, but not a fatal one.
              * Report error; don't add the label to the table again.
              */
-            printError("%s", ERROR2);
-            free(labelDuplicate);
+            reportDuplicate (label, length, line);
             return 1;
         }
 
+        return insertLabel (table, label, length, hash, slot, PC) >= 0;
+}
 
-        /* Resize the table if necessary. */
-        if ( table->nbrLabels >= table->capacity )
-        {
-           tableResize(table, 2*(table->nbrLabels+1));
-        }
+int referenceLabelLen (LabelTable * table, const char * label, int length)
+  /* Returns the position in the table of the entry for the first length
+   *      characters of label, adding an entry with an undefined address
+   *      (UNDEFINED_ADDRESS) if the label is not in the table yet;
+   *      returns -1 if memory allocation error or table doesn't exist.
+   */
+{
+        int      slot;
+        unsigned hash;
 
-        	table->entries[table->nbrLabels].label = label;
-        	table->entries[table->nbrLabels].address = PC;
-        	table->nbrLabels++;
+        /* verify that current table exists */
+        if ( ! verifyTableExists (table) )
+            return -1;          /* fatal error: table doesn't exist */
+
+        hash = hashLabel(label, length);
+        if ( table->concurrent != NULL )
+            return concurrentReference (table, label, length, hash);
+        slot = findSlot(table, label, hash, length);
+        if ( slot >= 0 && table->index[slot].entry >= 0 )
+            return table->index[slot].entry;
 
-        return 1;               /* everything worked great! */
+        return insertLabel (table, label, length, hash, slot, UNDEFINED_ADDRESS);
 }
 
 int tableResize (LabelTable * table, int newSize)
@@ -145,36 +309,65 @@ int tableResize (LabelTable * table, int newSize)
    *      or table doesn't exist.
    */
 {
-        char * ptr;               /* points to any byte in memory */
         LabelEntry * newEntryList;
-        int          smaller;
+        int          truncated;
 
         /* verify that current table exists */
         if ( ! verifyTableExists (table) )
             return 0;           /* fatal error: table doesn't exist */
 
-        /* create a new internal table of the specified size */
-        if ((newEntryList = malloc (newSize * sizeof(LabelEntry))) == NULL)
+        if ( table->concurrent != NULL )
+            return concurrentReserve (table, newSize);
+
+        /* grow (or shrink) the internal table, in place if realloc can;
+         * the entries up to the new size stay as they are
+         */
+        countStat (STAT_RESIZES, 1);
+        countStat (STAT_BYTES, newSize * sizeof(LabelEntry));
+        newEntryList = realloc (table->entries,
+                                (newSize > 0 ? newSize : 1) * sizeof(LabelEntry));
+        if ( newEntryList == NULL )
         {
             printError ("%s", ERROR2);
             return 0;           /* fatal error: couldn't allocate memory */
         }
 
-        if ( table->entries )           /* if there were entries */
-        {
-            /* move contents of internal table to new internal table */
-            smaller = table->nbrLabels < newSize ? table->nbrLabels : newSize;
-            (void) memcpy (newEntryList, table->entries,
-                           smaller * sizeof(LabelEntry));
-
-            /* free the space taken up by the old internal table */
-            free (table->entries);
-            table->nbrLabels = smaller;
-        }
-
         table->entries = newEntryList;
         table->capacity = newSize;
-        return 1;
+        truncated = table->nbrLabels > newSize;
+        if ( truncated )
+            table->nbrLabels = newSize;
+
+        /* keep the hash index at least twice the size of the table (it
+         * only has to be rebuilt if it changes size or lost entries)
+         */
+        return rebuildIndex(table, 2 * newSize, truncated);
+}
+
+int tableReserve (LabelTable * table, int nbrLabels)
+  /* Postcondition: table has the capacity to hold at least nbrLabels
+   *      label entries.
+   * Returns 1 if everything went OK; 0 if memory allocation error
+   *      or table doesn't exist.
+   */
+{
+        /* verify that current table exists */
+        if ( ! verifyTableExists (table) )
+            return 0;           /* fatal error: table doesn't exist */
+
+        if ( table->concurrent == NULL && nbrLabels <= table->capacity )
+            return 1;
+        return tableResize (table, nbrLabels);
+}
+
+LabelEntry * tableEntry (LabelTable * table, int position)
+  /* Returns the entry at the given position in the table, which must be
+   *      between 0 and nbrLabels - 1.
+   */
+{
+        if ( table->concurrent != NULL )
+            return concurrentEntry (table, position);
+        return &table->entries[position];
 }
 
 static int verifyTableExists(LabelTable * table)
@@ -191,3 +384,155 @@ static int verifyTableExists(LabelTable * table)
 
         return 1;
 }
+
+static unsigned hashLabel(const char * label, int length)
+ /* Returns the 32-bit FNV-1a hash of the first length characters of
+  * the label name.
+  */
+{
+        unsigned hash = 2166136261u;
+
+        for ( int i = 0; i < length; i++ )
+        {
+            hash ^= (unsigned char) label[i];
+            hash *= 16777619u;
+        }
+
+        return hash;
+}
+
+static int findSlot(LabelTable * table, const char * label,
+                    unsigned hash, int length)
+ /* Returns the slot of the hash index that holds the entry for label
+  * (whose hash and length have already been computed) or, if label is
+  * not in the table, the empty slot where its entry belongs.  Returns
+  * -1 if the table has no index yet.
+  */
+{
+        unsigned     mask;
+        unsigned     slot;
+        int          entry;
+        int          probes = 0;
+
+        if ( table->indexSize == 0 )
+            return -1;
+
+        /* linear probing; the index is never full, so this terminates */
+        mask = table->indexSize - 1;
+        for ( slot = hash & mask; ; slot = (slot + 1) & mask )
+        {
+            probes++;
+            entry = table->index[slot].entry;
+            if ( entry < 0 )
+                break;
+
+            /* only look at the entry itself if the hashes match */
+            if ( table->index[slot].hash == hash &&
+                 table->entries[entry].length == length &&
+                 memcmp(table->entries[entry].label, label, length) == SAME )
+                break;
+        }
+
+        countStat (STAT_LOOKUPS, 1);
+        countStat (STAT_PROBES, probes);
+        return slot;
+}
+
+static int rebuildIndex(LabelTable * table, int minSlots, int always)
+ /* Postcondition: the hash index has at least minSlots slots (rounded
+  *      up to a power of 2) and holds every entry in the table.  (If
+  *      always is 0 and the index was already that size, it is left as
+  *      it was, since it is still up to date.)
+  * Returns 1 if everything went OK; 0 if memory allocation error.
+  */
+{
+        int         newSize = 1;
+        IndexSlot * newIndex;
+        unsigned    mask;
+        unsigned    slot;
+
+        while ( newSize < minSlots )
+            newSize *= 2;
+
+        if ( newSize == table->indexSize && ! always )
+            return 1;
+        if ( newSize != table->indexSize )
+        {
+            countStat (STAT_BYTES, newSize * sizeof(IndexSlot));
+            if ( (newIndex = malloc (newSize * sizeof(IndexSlot))) == NULL )
+            {
+                printError ("%s", ERROR2);
+                return 0;       /* fatal error: couldn't allocate memory */
+            }
+            free (table->index);
+            table->index = newIndex;
+            table->indexSize = newSize;
+        }
+
+        /* Re-insert every entry into the (now empty) index.  The names
+         * are all different, so each one just goes in the first empty
+         * slot of its probe sequence, using the hash cached in its entry.
+         */
+        emptyIndex (table);
+        mask = table->indexSize - 1;
+        for ( int i = 0; i < table->nbrLabels; i++ )
+        {
+            slot = table->entries[i].hash & mask;
+            while ( table->index[slot].entry >= 0 )
+                slot = (slot + 1) & mask;
+            table->index[slot].entry = i;
+            table->index[slot].hash = table->entries[i].hash;
+        }
+
+        return 1;
+}
+
+static void emptyIndex(LabelTable * table)
+ /* Postcondition: every slot of the hash index is empty. */
+{
+        for ( int slot = 0; slot < table->indexSize; slot++ )
+            table->index[slot].entry = -1;
+}
+
+static void reportDuplicate(const char * label, int length, int line)
+ /* Reports the first length characters of label, defined on the given
+  * line, as a duplicate label (with ERROR1, if the line is not known).
+  */
+{
+        if ( line > 0 )
+            reportError (DIAG_DUPLICATE_LABEL, line, label, length);
+        else
+            printError("%s", ERROR1);
+}
+
+static int insertLabel(LabelTable * table, const char * label, int length,
+                       unsigned hash, int slot, int PC)
+ /* Adds a new entry for label (whose hash and length have already been
+  * computed, and which belongs in the given empty slot of the index)
+  * with the address PC, resizing the table if necessary.  Returns the
+  * position of the new entry, or -1 if memory allocation error.
+  */
+{
+        char * labelCopy;
+
+        /* Intern a copy of label that will persist with the table. */
+        if ((labelCopy = arenaCopy (&table->names, label, length)) == NULL)
+            return -1;          /* fatal error: couldn't allocate memory */
+
+        /* Resize the table if necessary. */
+        if ( table->nbrLabels >= table->capacity )
+        {
+           if ( ! tableResize(table, 2*(table->nbrLabels+1)) )
+               return -1;       /* fatal error: couldn't allocate memory */
+           /* the index was rebuilt, so the free slot has moved */
+           slot = findSlot(table, label, hash, length);
+        }
+
+        table->entries[table->nbrLabels].label = labelCopy;
+        table->entries[table->nbrLabels].address = PC;
+        table->entries[table->nbrLabels].length = length;
+        table->entries[table->nbrLabels].hash = hash;
+        table->index[slot].entry = table->nbrLabels;
+        table->index[slot].hash = hash;
+        return table->nbrLabels++;
+}
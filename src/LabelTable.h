@@ -10,27 +10,91 @@
  *
  * Creation Date:   2/16/99
  *   Modified:  12/20/2000   Updated postcondition information.
+ *   Modified:  10/14/2026   Added a hash index over the entries.
+ *   Modified:  10/14/2026   Label names are interned in a string arena.
+ *   Modified:  10/14/2026   Entries cache the hash and length of names.
+ *   Modified:  10/14/2026   Added addLabelLen and findLabelLen.
+ *   Modified:  10/14/2026   Added referenceLabelLen (undefined entries).
+ *   Modified:  10/14/2026   Added concurrent tables and tableEntry.
+ *   Modified:  10/14/2026   Added tableReset.
+ *   Modified:  10/14/2026   Added tableInitWithCapacity and tableReserve.
+ *   Modified:  10/14/2026   The names are kept in an Arena (see Arena.h).
+ *   Modified:  10/14/2026   Index slots hold the hash next to the entry.
+ *   Modified:  10/14/2026   addLabelLen reports duplicates on their line.
  *
 */
 
 #ifndef LABEL_H
 #define LABEL_H
 
+#include <stddef.h>
+
+#include "Arena.h"
+
+/* The address of a label that has been referenced but not defined
+ * (see referenceLabelLen).
+ */
+#define UNDEFINED_ADDRESS (-1)
+
 /* THE DATA STRUCTURES */
 
 /* The first type definition defines the type for a single entry in the
  * table.  The second defines the type for the table as a whole.
+ *
+ * Besides the entries themselves, the table keeps an open-addressing
+ * hash index over them so that addLabel and findLabel do not have to
+ * scan every entry.  Each slot of the index holds the position of an
+ * entry in the entries array, or -1 if the slot is empty.  The number
+ * of slots is always a power of 2 and at least twice the capacity of
+ * the table, so the index is never more than half full.
+ *
+ * Each entry caches the hash and length of its label name, and each
+ * slot holds the hash of its entry's name next to the entry's position
+ * (see IndexSlot), so a probe reads both from the same cache line, and
+ * a probe sequence walks the slots alone until it finds a hash that
+ * matches.  Only then are the entry's length and, finally, its name
+ * compared.
+ *
+ * The label names themselves are copied into an arena owned by the
+ * table (see Arena.h): a chain of large blocks that names are packed
+ * into one after another.  The names stay where they are until
+ * tableReset empties the arena (in constant time, keeping its blocks
+ * for the next program's names) or tableFree releases all of the
+ * blocks at once, so callers may reuse their own buffers as soon as
+ * addLabel returns.
+ *
+ * A table made with tableInitConcurrent instead keeps its entries, index,
+ * and names in a ConcurrentLabelTable of its own (see
+ * ConcurrentLabelTable.c) that many threads can add labels to and look
+ * them up in at once, without locks; only nbrLabels is kept up to date
+ * in the LabelTable itself.  Everything else is the same, except that
+ * the entries can only be reached through tableEntry, which works for
+ * both kinds of table.
  */
 
+typedef struct ConcurrentLabelTable ConcurrentLabelTable;
+
 typedef struct {
         char * label;           /* label name */
         int   address;           /* address of label */
+        int   length;            /* length of label name */
+        unsigned hash;           /* hash of label name */
 } LabelEntry;
 
+typedef struct {
+        int entry;              /* position of entry (-1 = empty slot) */
+        unsigned hash;          /* hash of its label name */
+} IndexSlot;
+
 typedef struct {
         int capacity;           /* capacity of the table */
         int nbrLabels;          /* actual nbr of entries in table */
         LabelEntry * entries;
+        int indexSize;          /* nbr of slots in hash index */
+        IndexSlot * index;      /* hash index into entries */
+        Arena names;            /* storage for the label names */
+        ConcurrentLabelTable * concurrent;  /* NULL unless made with
+                                             * tableInitConcurrent */
 } LabelTable;
 
 
@@ -41,11 +105,55 @@ void tableInit  (LabelTable * table);
          *       are no label entries in it.
          */
 
+int tableInitWithCapacity (LabelTable * table, int capacity);
+        /* Postcondition: table is initialized with no label entries in
+         *       it, with room (and a hash index big enough) for
+         *       capacity entries, so that adding that many labels
+         *       allocates nothing but their names.
+         * Returns 1 if everything went OK; 0 (with table initialized,
+         *       but empty) if memory allocation error.
+         */
+
+int tableInitConcurrent (LabelTable * table);
+        /* Postcondition: table is initialized with no label entries in
+         *       it, as a concurrent table: any number of threads may
+         *       call addLabel, addLabelLen, findLabel, findLabelLen,
+         *       referenceLabelLen, and tableEntry on it at the same
+         *       time.  (The other functions, and tableEntry for
+         *       positions nobody has been told about, may only be called
+         *       when no other thread is using the table.)
+         * Returns 1 if everything went OK; 0 (with table initialized as
+         *       an ordinary table) if memory allocation error.
+         */
+
+void tableFree  (LabelTable * table);
+        /* Postcondition: all memory used by the table, including the
+         *       interned label names, has been released and the table
+         *       is once again initialized with no label entries in it.
+         */
+
+void tableReset (LabelTable * table);
+        /* Postcondition: the table has no label entries in it again,
+         *       but keeps its memory (the entries, the index, and the
+         *       biggest block of names) for the next program.  (A
+         *       concurrent table is freed and made again.)
+         */
+
 int tableResize (LabelTable * table, int newSize);
         /* Postcondition: table now has the capacity to hold newSize
          *      label entries.  If the new size is smaller than the
          *      old size, the table is truncated after the first
-         *      newSize entries.
+         *      newSize entries.  (A concurrent table never gives up an
+         *      entry: its index is made big enough for newSize entries,
+         *      unless it has more than that already.)
+         * Returns 1 if everything went OK; 0 if memory allocation error
+         *      or table doesn't exist (or a concurrent table would have
+         *      had to be truncated).
+         */
+
+int tableReserve (LabelTable * table, int nbrLabels);
+        /* Postcondition: table has the capacity to hold at least
+         *      nbrLabels label entries; it is never made smaller.
          * Returns 1 if everything went OK; 0 if memory allocation error
          *      or table doesn't exist.
          */
@@ -53,8 +161,9 @@ int tableResize (LabelTable * table, int newSize);
 int addLabel    (LabelTable * table, char * labelName, int memLoc);
         /* Postcondition: if label was already in table, the table is
          *      unchanged; otherwise a new entry has been added to the
-         *      table with the specified label name and instruction address
-         *      (memory location) and the table has been resized if necessary.
+         *      table with a copy of the specified label name and
+         *      instruction address (memory location) and the table has
+         *      been resized if necessary.
          * Returns 1 if no fatal errors occurred; 0 if memory allocation error
          *      or table doesn't exist.
          */
@@ -64,6 +173,41 @@ int findLabel (LabelTable * table, char * label);
          *      not in the table or if table doesn't exist
          */
 
+int addLabelLen  (LabelTable * table, const char * labelName, int length,
+                  int memLoc, int line);
+int findLabelLen (LabelTable * table, const char * labelName, int length);
+        /* These work exactly like addLabel and findLabel, except that
+         *      the label name is given as the first length characters
+         *      of labelName, which need not be null-terminated (e.g.,
+         *      a token in a line of a memory-mapped source file).
+         *      In addition, addLabelLen defines a label that is in the
+         *      table with an undefined address, rather than reporting it
+         *      as a duplicate, and reports a duplicate with reportError
+         *      (DIAG_DUPLICATE_LABEL, see Diagnostics.h), on the line
+         *      it was defined on again; if line is 0 (as for addLabel,
+         *      which does not know it), the error is printed without a
+         *      line number, as before.
+         */
+
+int referenceLabelLen (LabelTable * table, const char * labelName,
+                       int length);
+        /* Postcondition: the label made up of the first length
+         *      characters of labelName is in the table; if it was not
+         *      there already, it has been added with an undefined
+         *      address (UNDEFINED_ADDRESS), for addLabelLen to define
+         *      later.  (Used when assembling in a single pass, for
+         *      branches and jumps to labels further down.)
+         * Returns the position of the label's entry in the table (see
+         *      tableEntry); -1 if memory allocation error or table
+         *      doesn't exist.
+         */
+
+LabelEntry * tableEntry (LabelTable * table, int position);
+        /* Returns the entry at the given position in the table (as
+         *      returned by referenceLabelLen, for example), which must
+         *      be between 0 and nbrLabels - 1.
+         */
+
 void printLabels (LabelTable * table);
         /* Postcondition: all the labels in the table, with their
          *      associated addresses, have been printed to the standard
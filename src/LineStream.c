@@ -0,0 +1,254 @@
+/*
+ * Line Stream: functions to hand out the lines of an input as it is
+ * read, a chunk at a time
+ *
+ * This file provides the definitions of the functions declared in
+ * LineStream.h.  Each chunk is read straight into the free part of the
+ * ring buffer after the bytes still to be handed out, and newlines are
+ * found with memchr, on the (at most two) contiguous pieces of the ring
+ * that have not been searched yet.  Only a line that wraps around the
+ * end of the ring, or fills all of it, is ever copied.  streamNextCodeLine
+ * classifies each line with the scanner's comment and whitespace masks
+ * (see scanCodeLength in Scanner.h), up to its first '#'.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added streamNextCodeLine.
+ *
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "LineStream.h"
+#include "Scanner.h"
+#include "printFuncs.h"
+#include "Stats.h"
+
+// internal global variables (global to this file only)
+static const char * ERROR0 = "Error: Cannot read file %s.\n";
+static const char * ERROR1 = "Error: cannot allocate space in memory.\n";
+
+// internal functions (visible to this file only)
+static int findNewline (LineStream * stream, size_t * offset);
+static int readChunk (LineStream * stream);
+static int spillBytes (LineStream * stream, size_t begin, size_t end);
+
+int streamOpen (LineStream * stream, int fd, const char * name)
+  /* Postcondition: stream hands out the lines read from fd, from its
+   *      current position.
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      memory allocation error.
+   */
+{
+        stream->fd = fd;
+        stream->name = name;
+        stream->head = stream->scanned = stream->tail = 0;
+        stream->spill = NULL;
+        stream->spillLength = stream->spillSize = 0;
+        stream->lineNbr = 0;
+        stream->atEnd = 0;
+        stream->failed = 0;
+
+        countStat (STAT_BYTES, STREAM_RING_SIZE);
+        if ( (stream->ring = malloc (STREAM_RING_SIZE)) == NULL )
+        {
+            printError ("%s", ERROR1);
+            return 0;
+        }
+        return 1;
+}
+
+int streamNextLine (LineStream * stream, LineView * line)
+  /* Postcondition: if there is another line in the input, line
+   *      describes it (until the next call).  A final line without a
+   *      newline is still a line.
+   * Returns 1 if a line was found; 0 at the end of the input or (after
+   *      printing an error) if it could not be read.
+   */
+{
+        size_t end;             /* offset of the newline, or of the end */
+        size_t start;
+        int    found;
+        int    nbrRead;
+
+        /* Read chunks until the line's newline, or the end, is in. */
+        while ( ! (found = findNewline (stream, &end)) )
+        {
+            if ( stream->atEnd )
+            {
+                if ( stream->head == stream->tail &&
+                     stream->spillLength == 0 )
+                    return 0;
+                end = stream->tail;     /* the last line has no newline */
+                break;
+            }
+            if ( stream->tail - stream->head == STREAM_RING_SIZE )
+            {
+                /* The line fills the ring: move what there is of it. */
+                if ( ! spillBytes (stream, stream->head, stream->tail) )
+                    return 0;
+                stream->head = stream->tail;
+            }
+            if ( (nbrRead = readChunk (stream)) < 0 )
+                return 0;
+            stream->atEnd = nbrRead == 0;
+        }
+
+        /* The line is a view into the ring, unless it is in pieces. */
+        start = stream->head % STREAM_RING_SIZE;
+        if ( stream->spillLength == 0 &&
+             start + (end - stream->head) <= STREAM_RING_SIZE )
+        {
+            line->ptr = stream->ring + start;
+            line->length = end - stream->head;
+        }
+        else
+        {
+            if ( ! spillBytes (stream, stream->head, end) )
+                return 0;
+            line->ptr = stream->spill;
+            line->length = stream->spillLength;
+            stream->spillLength = 0;
+        }
+        line->lineNbr = ++stream->lineNbr;
+
+        /* Treat "\r\n" line endings like "\n". */
+        if ( line->length > 0 && line->ptr[line->length - 1] == '\r' )
+            line->length--;
+
+        stream->head = found ? end + 1 : end;
+        if ( stream->scanned < stream->head )
+            stream->scanned = stream->head;
+        return 1;
+}
+
+int streamNextCodeLine (LineStream * stream, LineView * line)
+  /* Postcondition: the same as for streamNextLine, except that the
+   *      lines with nothing but whitespace before their first '#' are
+   *      skipped, and line ends just before its '#'.
+   * Returns the same as streamNextLine.
+   */
+{
+        long nbrSkipped = 0;
+        int  length;
+
+        while ( streamNextLine (stream, line) )
+        {
+            if ( (length = scanCodeLength (line->ptr, line->length)) > 0 )
+            {
+                countStat (STAT_SKIPPED, nbrSkipped);
+                line->length = length;
+                return 1;
+            }
+            nbrSkipped++;
+        }
+        countStat (STAT_SKIPPED, nbrSkipped);
+        return 0;
+}
+
+void streamClose (LineStream * stream)
+  /* Postcondition: the memory used by stream has been released; line
+   *      views into it are no longer valid.
+   */
+{
+        free (stream->ring);
+        free (stream->spill);
+        stream->ring = stream->spill = NULL;
+        stream->head = stream->scanned = stream->tail = 0;
+        stream->spillLength = stream->spillSize = 0;
+}
+
+static int findNewline (LineStream * stream, size_t * offset)
+ /* Searches the bytes read in but not searched yet for a newline.
+  * Returns 1, with *offset set to the offset of the first one, if there
+  * is one; 0 if not (and all of the bytes have been searched).
+  */
+{
+        while ( stream->scanned < stream->tail )
+        {
+            size_t       start = stream->scanned % STREAM_RING_SIZE;
+            size_t       length = stream->tail - stream->scanned;
+            const char * newline;
+
+            /* one piece at a time, up to the end of the ring */
+            if ( length > STREAM_RING_SIZE - start )
+                length = STREAM_RING_SIZE - start;
+            newline = memchr (stream->ring + start, '\n', length);
+            if ( newline != NULL )
+            {
+                *offset = stream->scanned + (newline - (stream->ring + start));
+                stream->scanned = *offset + 1;
+                return 1;
+            }
+            stream->scanned += length;
+        }
+        return 0;
+}
+
+static int readChunk (LineStream * stream)
+ /* Reads up to STREAM_READ_SIZE more bytes of the input into the free
+  * part of the ring (there must be some), up to the end of the ring.
+  * Returns the number of bytes read (0 at the end of the input), or -1
+  * (after printing an error) if the input could not be read.
+  */
+{
+        size_t  start = stream->tail % STREAM_RING_SIZE;
+        size_t  size = STREAM_RING_SIZE - (stream->tail - stream->head);
+        ssize_t nbrRead;
+
+        if ( size > STREAM_RING_SIZE - start )
+            size = STREAM_RING_SIZE - start;
+        if ( size > STREAM_READ_SIZE )
+            size = STREAM_READ_SIZE;
+
+        while ( (nbrRead = read (stream->fd, stream->ring + start, size)) < 0 )
+            if ( errno != EINTR )
+            {
+                printError (ERROR0, stream->name);
+                stream->failed = 1;
+                return -1;
+            }
+        stream->tail += nbrRead;
+        return nbrRead;
+}
+
+static int spillBytes (LineStream * stream, size_t begin, size_t end)
+ /* Appends the bytes of the ring from offset begin up to offset end to
+  * the spill buffer, which doubles in size as often as it must.
+  * Returns 1 if everything went OK; prints an error and returns 0
+  * otherwise.
+  */
+{
+        size_t length = end - begin;
+        size_t size = stream->spillSize > 0 ? stream->spillSize : 1024;
+        size_t start = begin % STREAM_RING_SIZE;
+        size_t first = length;
+        char * spill;
+
+        while ( size < stream->spillLength + length )
+            size *= 2;
+        if ( size != stream->spillSize )
+        {
+            countStat (STAT_BYTES, size);
+            if ( (spill = realloc (stream->spill, size)) == NULL )
+            {
+                printError ("%s", ERROR1);
+                stream->failed = 1;
+                return 0;
+            }
+            stream->spill = spill;
+            stream->spillSize = size;
+        }
+
+        /* The bytes may wrap around the end of the ring. */
+        if ( first > STREAM_RING_SIZE - start )
+            first = STREAM_RING_SIZE - start;
+        memcpy (stream->spill + stream->spillLength, stream->ring + start,
+                first);
+        memcpy (stream->spill + stream->spillLength + first, stream->ring,
+                length - first);
+        stream->spillLength += length;
+        return 1;
+}
@@ -0,0 +1,113 @@
+/*
+ * Line Stream: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for a group
+ * of functions that hand out the lines of an input of any length, such
+ * as a pipe into the standard input, without ever holding all of it in
+ * memory (unlike a SourceFile; see SourceFile.h).  The input is read in
+ * STREAM_READ_SIZE-byte chunks into a ring buffer of STREAM_RING_SIZE
+ * bytes, and each line is handed out as soon as its newline has been
+ * read.  A line is usually a view straight into the ring; one that
+ * wraps around its end, or is longer than the whole ring, is gathered
+ * into a separate buffer (which only grows as big as the longest such
+ * line) instead.  Either way, the memory used does not depend on the
+ * size of the input.
+ *
+ * The line views are like the ones sourceNextLine hands out, and are
+ * split the same way (a final line without a newline is still a line,
+ * and "\r\n" is treated like "\n"), but each one is only valid until
+ * the next call to streamNextLine: the input is read into the same
+ * memory again and again.  Anything that has to outlast the line, such
+ * as a label name or the argument of an error, must be copied (the
+ * label table and diagKeepArgs in Diagnostics.h do so).
+ *
+ * EXAMPLE:
+ *      LineStream stream;
+ *      LineView   line;
+ *      if ( streamOpen (&stream, STDIN_FILENO, "<stdin>") )
+ *      {
+ *          while ( streamNextLine (&stream, &line) )
+ *              printf ("%d: %.*s\n", line.lineNbr, line.length, line.ptr);
+ *          streamClose (&stream);
+ *      }
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added streamNextCodeLine.
+ *
+ */
+
+#ifndef _LINE_STREAM_H
+#define _LINE_STREAM_H
+
+#include <stddef.h>
+
+#include "SourceFile.h"
+
+/* The size of the ring buffer, a power of 2... */
+#define STREAM_RING_SIZE (64 * 1024)
+/* ...and the most bytes read into it at a time. */
+#define STREAM_READ_SIZE (16 * 1024)
+
+/* THE DATA STRUCTURES */
+
+/* The offsets in the stream are counted from the start of the input;
+ * the byte at offset i is in ring[i % STREAM_RING_SIZE] for as long as
+ * it is in the ring at all.
+ */
+
+typedef struct {
+        int fd;                 /* file descriptor the input comes from */
+        const char * name;      /* its name, for error messages */
+        char * ring;            /* STREAM_RING_SIZE bytes of the input */
+        size_t head;            /* offset of the next byte to hand out */
+        size_t scanned;         /* offset of first byte not searched for
+                                 * a newline yet */
+        size_t tail;            /* offset of first byte not read yet */
+        char * spill;           /* the start of a line too long for the
+                                 * ring, or the line that wraps */
+        size_t spillLength;     /* nbr of bytes of the line in spill */
+        size_t spillSize;       /* nbr of bytes spill can hold */
+        int lineNbr;            /* nbr of lines handed out so far */
+        int atEnd;              /* 1 once the end of the input was read */
+        int failed;             /* 1 if it could not be read (or there
+                                 * was no memory for a line) */
+} LineStream;
+
+
+/* THE FUNCTIONS */
+
+int streamOpen (LineStream * stream, int fd, const char * name);
+        /* Postcondition: stream hands out the lines read from the file
+         *      descriptor fd (which still belongs to the caller), from
+         *      its current position; name is what error messages call
+         *      it.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if memory allocation error.
+         */
+
+int streamNextLine (LineStream * stream, LineView * line);
+        /* Postcondition: if there is another line in the input, line
+         *      describes it, until the next call; the line after it is
+         *      the next one to be handed out.  A final line without a
+         *      newline is still a line.
+         * Returns 1 if a line was found; 0 at the end of the input or
+         *      (after printing an error, and setting stream->failed) if
+         *      it could not be read.
+         */
+
+int streamNextCodeLine (LineStream * stream, LineView * line);
+        /* Postcondition: the same as for streamNextLine, except that
+         *      the lines with nothing but whitespace before their first
+         *      '#' (if any) are skipped (but still numbered), and line
+         *      ends just before the '#' of the one it describes (see
+         *      sourceNextCodeLine).
+         * Returns the same as streamNextLine.
+         */
+
+void streamClose (LineStream * stream);
+        /* Postcondition: the memory used by stream has been released;
+         *      line views into it are no longer valid.  The file
+         *      descriptor is not closed.
+         */
+
+#endif
@@ -0,0 +1,524 @@
+/*
+ * Output Sink: functions to collect and write machine code output
+ *
+ * This file provides the definitions of the functions declared in
+ * OutputSink.h.  The encoded words are only formatted when the output
+ * is flushed, all at once: when the output is a regular file opened
+ * for reading and writing, it is extended to its final size and the
+ * words are formatted straight into a shared memory mapping of it;
+ * otherwise they are formatted into a large staging buffer that is
+ * written with one write() call each time it fills.  (On systems
+ * without mmap, the staging buffer is always used.)  Output that only
+ * updates the words of an earlier run goes through the staging buffer
+ * too, one run of changed words at a time, each with one pwrite() call.
+ * Words outputRelease has dropped are found from the current offset in
+ * the output file, after the last word written out.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added outputSetPrevious.
+ *   Modified:  10/14/2026   Added outputRelease, outputCanPatch, and
+ *                           outputPatch.
+ *
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if ! defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "OutputSink.h"
+#include "printFuncs.h"
+#include "Stats.h"
+
+// internal global variables (global to this file only)
+static const char * ERROR0 = "Error: cannot write the output.\n";
+static const char * ERROR1 = "Error: cannot allocate space in memory.\n";
+
+static const long FIRST_CAPACITY = 1024;        /* in words */
+static const size_t BATCH_SIZE = 256 * 1024;    /* in bytes */
+/* Unchanged words that are rewritten rather than split a run in two. */
+static const long MAX_GAP = 16;
+
+/* The 4 binary digits of each nibble, for the text mode. */
+static const char NIBBLE[16][4] =
+{
+        "0000", "0001", "0010", "0011", "0100", "0101", "0110", "0111",
+        "1000", "1001", "1010", "1011", "1100", "1101", "1110", "1111",
+};
+
+// internal functions (visible to this file only)
+static size_t wordSize (OutputMode mode);
+static void formatWords (OutputMode mode, const uint32_t * words, long n,
+                         unsigned char * dest);
+static int writeAll (int fd, const void * buffer, size_t size);
+#if ! defined(_WIN32)
+static int writeAllAt (int fd, const void * buffer, size_t size,
+                       off_t offset);
+#endif
+static int flushWords (OutputSink * out, long n);
+static int flushChanged (OutputSink * out);
+static int flushMapped (OutputSink * out, long n);
+static int flushBatches (OutputSink * out, long n);
+
+void outputInit (OutputSink * out, int fd, OutputMode mode)
+  /* Postcondition: out is empty and will write to the file
+   *      descriptor fd in the given mode.
+   */
+{
+        out->fd = fd;
+        out->mode = mode;
+        out->words = NULL;
+        out->nbrWords = 0;
+        out->capacity = 0;
+        out->nbrFlushed = 0;
+        out->nbrDropped = 0;
+        out->previous = NULL;
+        out->nbrPrevious = 0;
+}
+
+int outputReserve (OutputSink * out, long nbrWords)
+  /* Postcondition: out can hold at least nbrWords words without
+   *      allocating any more memory.
+   * Returns 1 if everything went OK; 0 (after printing an error)
+   *      if memory allocation error.
+   */
+{
+        uint32_t * words;
+
+        if ( nbrWords <= out->capacity )
+            return 1;
+
+        countStat (STAT_BYTES, nbrWords * sizeof(uint32_t));
+        words = realloc (out->words, nbrWords * sizeof(uint32_t));
+        if ( words == NULL )
+        {
+            printError ("%s", ERROR1);
+            return 0;
+        }
+        out->words = words;
+        out->capacity = nbrWords;
+        return 1;
+}
+
+void outputSlice (OutputSink * slice, OutputSink * out, long first,
+                  long count)
+  /* Postcondition: slice is an empty sink over words first through
+   *      first + count - 1 of out's array.
+   */
+{
+        outputInit (slice, -1, out->mode);
+        slice->words = out->words + first;
+        slice->capacity = count;
+}
+
+int outputGrow (OutputSink * out)
+  /* Postcondition: out can hold at least one more word.
+   * Returns 1 if everything went OK; 0 (after printing an error)
+   *      if memory allocation error.
+   */
+{
+        return outputReserve (out, out->capacity > 0 ? 2 * out->capacity
+                                                     : FIRST_CAPACITY);
+}
+
+void outputSetPrevious (OutputSink * out, const uint32_t * words,
+                        long nbrWords)
+  /* Postcondition: the first flush only writes the words that differ
+   *      from the nbrWords words the output file holds.
+   */
+{
+        out->previous = words;
+        out->nbrPrevious = nbrWords;
+}
+
+int outputFlush (OutputSink * out)
+  /* Postcondition: every word added since the last flush has been
+   *      formatted and written to the output.
+   * Returns 1 if everything went OK; 0 (after printing an error)
+   *      if the output could not be written.
+   */
+{
+        int ok;
+
+        if ( out->previous != NULL && out->fd >= 0 )
+        {
+            /* Anything already printed to the same descriptor goes
+             * first (see flushWords).
+             */
+            if ( out->fd == fileno (stdout) )
+                (void) fflush (stdout);
+            ok = flushChanged (out);
+            out->previous = NULL;
+            if ( ok >= 0 )
+            {
+                out->nbrFlushed = out->nbrWords;
+                if ( ! ok )
+                    printError ("%s", ERROR0);
+                return ok;
+            }
+        }
+        return flushWords (out, out->nbrWords - out->nbrFlushed);
+}
+
+int outputRelease (OutputSink * out, long keep)
+  /* Postcondition: all but the last keep words in memory have been
+   *      written out and dropped (unless out has no file descriptor).
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      the output could not be written.
+   */
+{
+        long drop = out->nbrWords - keep;
+
+        if ( out->fd < 0 || drop <= 0 )
+            return 1;
+        if ( drop > out->nbrFlushed &&
+             ! flushWords (out, drop - out->nbrFlushed) )
+            return 0;
+
+        memmove (out->words, out->words + drop, keep * sizeof(uint32_t));
+        out->nbrWords = keep;
+        out->nbrFlushed -= drop;
+        out->nbrDropped += drop;
+        return 1;
+}
+
+int outputCanPatch (const OutputSink * out)
+  /* Returns 1 if words of out already written can still be changed in
+   *      the output; 0 otherwise.
+   */
+{
+#if ! defined(_WIN32)
+        struct stat info;
+        int         flags = fcntl (out->fd, F_GETFL);
+
+        return out->fd >= 0 && flags >= 0 && ! (flags & O_APPEND) &&
+               fstat (out->fd, &info) == 0 && S_ISREG(info.st_mode) &&
+               lseek (out->fd, 0, SEEK_CUR) >= 0;
+#else
+        (void) out;
+        return 0;
+#endif
+}
+
+int outputPatch (OutputSink * out, long word, uint32_t value)
+  /* Postcondition: the word at the given position in the output is
+   *      value, in memory and, if it was written out, in the file.
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      the output could not be written.
+   */
+{
+        long written = out->nbrDropped + out->nbrFlushed;
+
+        if ( word >= out->nbrDropped )
+            out->words[word - out->nbrDropped] = value;
+        if ( word >= written )
+            return 1;
+
+#if ! defined(_WIN32)
+        {
+            /* The file offset is just after the last word written. */
+            unsigned char buffer[33];
+            size_t        size = wordSize (out->mode);
+            off_t         end = lseek (out->fd, 0, SEEK_CUR);
+
+            formatWords (out->mode, &value, 1, buffer);
+            if ( end >= 0 && end >= (off_t) ((written - word) * size) &&
+                 writeAllAt (out->fd, buffer, size,
+                             end - (off_t) ((written - word) * size)) )
+                return 1;
+        }
+#endif
+        printError ("%s", ERROR0);
+        return 0;
+}
+
+void outputReset (OutputSink * out)
+  /* Postcondition: out is empty again, but keeps its memory for the
+   *      next program.
+   */
+{
+        out->nbrWords = 0;
+        out->nbrFlushed = 0;
+        out->nbrDropped = 0;
+        out->previous = NULL;
+        out->nbrPrevious = 0;
+}
+
+void outputFree (OutputSink * out)
+  /* Postcondition: the memory used by out has been released; out is
+   *      empty again (and still writes to the same fd).
+   */
+{
+        free (out->words);
+        outputInit (out, out->fd, out->mode);
+}
+
+static size_t wordSize (OutputMode mode)
+  /* Returns the number of bytes each word takes in the given mode. */
+{
+        return mode == OUTPUT_TEXT ? 33 : 4;
+}
+
+static void formatWords (OutputMode mode, const uint32_t * words, long n,
+                         unsigned char * dest)
+  /* Postcondition: the n words have been formatted into dest, which
+   *      has room for n * wordSize(mode) bytes.
+   */
+{
+        switch ( mode )
+        {
+            case OUTPUT_TEXT:
+                /* 32 binary digits, most significant first */
+                for ( long i = 0; i < n; i++, dest += 33 )
+                {
+                    for ( int j = 0; j < 8; j++ )
+                        memcpy (dest + 4 * j,
+                                NIBBLE[(words[i] >> (28 - 4 * j)) & 0xf], 4);
+                    dest[32] = '\n';
+                }
+                break;
+
+            case OUTPUT_BINARY_BE:
+                for ( long i = 0; i < n; i++, dest += 4 )
+                {
+                    dest[0] = words[i] >> 24;
+                    dest[1] = words[i] >> 16;
+                    dest[2] = words[i] >> 8;
+                    dest[3] = words[i];
+                }
+                break;
+
+            case OUTPUT_BINARY_LE:
+                for ( long i = 0; i < n; i++, dest += 4 )
+                {
+                    dest[0] = words[i];
+                    dest[1] = words[i] >> 8;
+                    dest[2] = words[i] >> 16;
+                    dest[3] = words[i] >> 24;
+                }
+                break;
+        }
+}
+
+static int writeAll (int fd, const void * buffer, size_t size)
+  /* Writes all size bytes of buffer to fd, however many write() calls
+   * it takes.  Returns 1 if everything went OK; 0 otherwise.
+   */
+{
+        const char * next = buffer;
+        ssize_t      written;
+
+        while ( size > 0 )
+        {
+            written = write (fd, next, size);
+            if ( written < 0 && errno == EINTR )
+                continue;
+            if ( written <= 0 )
+                return 0;
+            next += written;
+            size -= written;
+        }
+        return 1;
+}
+
+#if ! defined(_WIN32)
+static int writeAllAt (int fd, const void * buffer, size_t size,
+                       off_t offset)
+  /* Writes all size bytes of buffer to fd, at the given offset in the
+   * file, however many pwrite() calls it takes.  Returns 1 if
+   * everything went OK; 0 otherwise.
+   */
+{
+        const char * next = buffer;
+        ssize_t      written;
+
+        while ( size > 0 )
+        {
+            written = pwrite (fd, next, size, offset);
+            if ( written < 0 && errno == EINTR )
+                continue;
+            if ( written <= 0 )
+                return 0;
+            next += written;
+            size -= written;
+            offset += written;
+        }
+        return 1;
+}
+#endif
+
+static int flushWords (OutputSink * out, long n)
+  /* Formats and writes out the first n words of out not written yet,
+   * straight into a mapping of the output file if it can, or through the
+   * staging buffer if not.  Returns 1 if everything went OK (or there is
+   * no file descriptor, so that the words are only kept in memory);
+   * prints an error and returns 0 otherwise.
+   */
+{
+        int ok;
+
+        /* Anything already printed to the same descriptor goes first. */
+        if ( out->fd == fileno (stdout) )
+            (void) fflush (stdout);
+        if ( n == 0 || out->fd < 0 )
+            return 1;
+
+        ok = flushMapped (out, n) || flushBatches (out, n);
+        out->nbrFlushed += n;
+        if ( ! ok )
+            printError ("%s", ERROR0);
+        return ok;
+}
+
+static int flushChanged (OutputSink * out)
+  /* If the output is a regular file, positioned at its start and not
+   * open for appending, whose size is that of the previous words, writes
+   * the runs of words that differ from those where they go in the file,
+   * makes the file the size of the words, and positions it at its end.
+   * Returns 1 if that worked and 0 if not; or, if the output is not such
+   * a file, empties it (if it is a regular file) and returns -1, for the
+   * words to be written out as usual.
+   */
+{
+#if ! defined(_WIN32)
+        struct stat     info;
+        int             flags = fcntl (out->fd, F_GETFL);
+        size_t          size = wordSize (out->mode);
+        long            perBatch = BATCH_SIZE / size;
+        long            nbrWritten = 0;
+        long            last;
+        long            gap;
+        unsigned char * batch;
+        int             ok = 1;
+
+        if ( flags < 0 || (flags & O_APPEND) ||
+             lseek (out->fd, 0, SEEK_CUR) != 0 ||
+             fstat (out->fd, &info) != 0 || ! S_ISREG(info.st_mode) )
+            return -1;
+        if ( info.st_size != (off_t) (out->nbrPrevious * size) ||
+             (batch = malloc (perBatch * size)) == NULL )
+            /* not the words it is said to hold: start over */
+            return ftruncate (out->fd, 0) == 0 ? -1 : 0;
+
+        for ( long i = 0; ok && i < out->nbrWords; i = last )
+        {
+            last = i + 1;
+            if ( i < out->nbrPrevious && out->words[i] == out->previous[i] )
+                continue;
+
+            /* A run of changed words ends after the last changed one
+             * before more than MAX_GAP unchanged ones (or a batch).
+             */
+            gap = 0;
+            for ( long j = last; j < out->nbrWords && j - i < perBatch &&
+                                 gap <= MAX_GAP; j++ )
+            {
+                if ( j < out->nbrPrevious &&
+                     out->words[j] == out->previous[j] )
+                    gap++;
+                else
+                {
+                    gap = 0;
+                    last = j + 1;
+                }
+            }
+
+            formatWords (out->mode, out->words + i, last - i, batch);
+            ok = writeAllAt (out->fd, batch, (last - i) * size,
+                             (off_t) i * size);
+            nbrWritten += last - i;
+        }
+        free (batch);
+
+        printDebug ("outputFlush: %ld of %ld words written\n", nbrWritten,
+                    out->nbrWords);
+        return ok && ftruncate (out->fd, out->nbrWords * size) == 0 &&
+               lseek (out->fd, out->nbrWords * size, SEEK_SET) >= 0;
+#else
+        (void) out;
+        return -1;
+#endif
+}
+
+static int flushMapped (OutputSink * out, long n)
+  /* Formats the last n words straight into a shared mapping of the
+   * output file, positioned at the current file offset, and advances
+   * the offset past them.  Returns 1 if that worked; 0 (without
+   * printing anything and without writing any output) if the output
+   * is not a regular file opened for reading and writing (a writable
+   * shared mapping needs both), or is open for appending, or is not
+   * positioned on a page boundary.
+   */
+{
+#if ! defined(_WIN32)
+        struct stat     info;
+        int             flags = fcntl (out->fd, F_GETFL);
+        off_t           offset = lseek (out->fd, 0, SEEK_CUR);
+        size_t          size = n * wordSize (out->mode);
+        unsigned char * map;
+
+        if ( flags < 0 || (flags & O_ACCMODE) != O_RDWR ||
+             (flags & O_APPEND) || offset < 0 ||
+             offset % sysconf (_SC_PAGESIZE) != 0 ||
+             fstat (out->fd, &info) != 0 || ! S_ISREG(info.st_mode) )
+            return 0;
+
+        if ( info.st_size < offset + (off_t) size &&
+             ftruncate (out->fd, offset + size) != 0 )
+            return 0;
+        map = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    out->fd, offset);
+        if ( map == MAP_FAILED )
+            return 0;
+
+        formatWords (out->mode, out->words + out->nbrFlushed, n, map);
+        if ( munmap (map, size) != 0 )
+            return 0;
+        return lseek (out->fd, offset + size, SEEK_SET) >= 0;
+#else
+        (void) out;  (void) n;
+        return 0;
+#endif
+}
+
+static int flushBatches (OutputSink * out, long n)
+  /* Formats the last n words into a staging buffer, writing it out
+   * each time it fills.  Returns 1 if everything went OK; 0 otherwise.
+   */
+{
+        const uint32_t  one = 1;
+        const uint32_t * words = out->words + out->nbrFlushed;
+        long            perBatch = BATCH_SIZE / wordSize (out->mode);
+        unsigned char * batch;
+        int             ok = 1;
+
+        /* Little-endian words on a little-endian machine are already
+         * in their final form.
+         */
+        if ( out->mode == OUTPUT_BINARY_LE && *(const char *) &one == 1 )
+            return writeAll (out->fd, words, n * sizeof(uint32_t));
+
+        if ( n < perBatch )
+            perBatch = n;
+        batch = malloc (perBatch * wordSize (out->mode));
+        if ( batch == NULL )
+            return 0;
+
+        for ( long i = 0; ok && i < n; i += perBatch )
+        {
+            long count = n - i < perBatch ? n - i : perBatch;
+
+            formatWords (out->mode, words + i, count, batch);
+            ok = writeAll (out->fd, batch, count * wordSize (out->mode));
+        }
+
+        free (batch);
+        return ok;
+}
@@ -0,0 +1,165 @@
+/*
+ * Output Sink: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for the
+ * functions that write the assembled machine code.  Pass 2 hands each
+ * encoded 32-bit instruction to outputWord, which just stores it in an
+ * array of words (preallocated with outputReserve, once pass 1 knows
+ * roughly how many instructions there are).  Nothing is formatted or
+ * written until outputFlush, which formats all the words at once,
+ * according to the sink's mode, and writes them either straight into
+ * a memory mapping of the output file (when the output is a regular
+ * file) or with a few large write() calls (e.g., to a pipe).
+ *
+ * The modes are:
+ *      OUTPUT_TEXT       each instruction as 32 '0'/'1' characters and
+ *                        a newline (the format printBin was designed to
+ *                        produce), e.g. 00000010001100100100000000100000
+ *      OUTPUT_BINARY_BE  each instruction as 4 bytes, most significant
+ *                        byte first (big-endian, as MIPS itself)
+ *      OUTPUT_BINARY_LE  each instruction as 4 bytes, least significant
+ *                        byte first (little-endian)
+ * The binary modes produce a raw image that a loader can use directly,
+ * an eighth of the size of the text.
+ *
+ * When the output file already holds the words of an earlier run of the
+ * same program (see outputSetPrevious), the first flush only writes the
+ * words that differ from those, in place, and then cuts the file to its
+ * new size.
+ *
+ * A program too big to keep in memory (see streamPass.c) is written out
+ * a part at a time instead: outputRelease writes out the words at the
+ * front of the array and drops them, and the words added after them
+ * take their place.  The positions of words in the output (as given to
+ * outputPatch) are counted from the first word ever added, whether or
+ * not it is still in memory; word i is out->words[i - out->nbrDropped].
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added outputSetPrevious.
+ *   Modified:  10/14/2026   Added outputRelease, outputCanPatch, and
+ *                           outputPatch.
+ *
+ */
+
+#ifndef _OUTPUT_SINK_H
+#define _OUTPUT_SINK_H
+
+#include <stdint.h>
+
+/* THE DATA STRUCTURES */
+
+typedef enum { OUTPUT_TEXT, OUTPUT_BINARY_BE, OUTPUT_BINARY_LE } OutputMode;
+
+typedef struct {
+        int fd;                 /* file descriptor the output goes to */
+        OutputMode mode;        /* how each word is formatted */
+        uint32_t * words;       /* the encoded instructions */
+        long nbrWords;          /* nbr of words in the words array */
+        long capacity;          /* nbr of words the array can hold */
+        long nbrFlushed;        /* nbr of words in it already written */
+        long nbrDropped;        /* nbr of words written out and dropped
+                                 * from the front of the array */
+        const uint32_t * previous;  /* words the file holds, or NULL */
+        long nbrPrevious;       /* nbr of words in previous */
+} OutputSink;
+
+
+/* THE FUNCTIONS */
+
+void outputInit (OutputSink * out, int fd, OutputMode mode);
+        /* Postcondition: out is empty and will write to the file
+         *      descriptor fd in the given mode.  (With an fd of -1, the
+         *      words are only kept in memory; flushing does nothing.)
+         */
+
+int outputReserve (OutputSink * out, long nbrWords);
+        /* Postcondition: out can hold at least nbrWords words without
+         *      allocating any more memory.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if memory allocation error.
+         */
+
+void outputSlice (OutputSink * slice, OutputSink * out, long first,
+                  long count);
+        /* Precondition: out can hold at least first + count words.
+         * Postcondition: slice is an empty sink whose words are words
+         *      first through first + count - 1 of out's array, so that
+         *      several threads can each add up to count words to a
+         *      slice of their own at once.  A slice must never be given
+         *      more than count words, flushed, or freed; the words it
+         *      holds are moved into place in out by whoever made it.
+         */
+
+int outputGrow (OutputSink * out);
+        /* Postcondition: out can hold at least one more word.  (Used
+         *      by outputWord; there is no need to call it directly.)
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if memory allocation error.
+         */
+
+static inline void outputWord (OutputSink * out, uint32_t word)
+        /* Postcondition: word has been added to the output. */
+{
+        if ( out->nbrWords < out->capacity || outputGrow (out) )
+            out->words[out->nbrWords++] = word;
+}
+
+void outputSetPrevious (OutputSink * out, const uint32_t * words,
+                        long nbrWords);
+        /* Precondition: nothing has been flushed yet, and the output
+         *      file (from its start) holds the nbrWords words, formatted
+         *      in out's mode, unless it has a different size.  The words
+         *      belong to the caller and must stay where they are until
+         *      the output has been flushed.
+         * Postcondition: the first flush only writes the words that
+         *      differ from those (if the file is a regular file of that
+         *      size; otherwise the file is emptied and written out as
+         *      usual).
+         */
+
+int outputFlush (OutputSink * out);
+        /* Postcondition: every word added since the last flush has
+         *      been formatted and written to the output.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if the output could not be written.
+         */
+
+int outputRelease (OutputSink * out, long keep);
+        /* Precondition: out has no previous words, and keep is at most
+         *      out->nbrWords.
+         * Postcondition: if out has a file descriptor, all but the last
+         *      keep words in memory have been written to the output (as
+         *      by outputFlush) and dropped from memory; the last keep
+         *      words are now the first in the array.  (With an fd of -1,
+         *      nothing is dropped.)
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if the output could not be written.
+         */
+
+int outputCanPatch (const OutputSink * out);
+        /* Returns 1 if words of out that have already been written to
+         *      the output can still be changed by outputPatch (the output
+         *      is a regular file, not open for appending); 0 otherwise.
+         */
+
+int outputPatch (OutputSink * out, long word, uint32_t value);
+        /* Precondition: word is the position of a word added to out
+         *      (counted from the first word ever added); if that word
+         *      has already been written out, outputCanPatch (out).
+         * Postcondition: the word is value, in memory and, if it has
+         *      been written out, in the output file.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if the output could not be written.
+         */
+
+void outputReset (OutputSink * out);
+        /* Postcondition: out is empty again, but keeps its memory for
+         *      the next program (and has no previous words).
+         */
+
+void outputFree (OutputSink * out);
+        /* Postcondition: the memory used by out has been released;
+         *      out is empty again (and still writes to the same fd).
+         */
+
+#endif
@@ -0,0 +1,440 @@
+/*
+ * Scanner: bulk classification of source bytes, 64 at a time
+ *
+ * This file provides the definitions of the functions declared in
+ * Scanner.h.  The SIMD versions of scanBlock all work the same way:
+ * compare a vector of bytes against each interesting character (and
+ * the range '\t'..'\r' for whitespace), then gather the top bit of
+ * every byte of each comparison into one bit of a mask.  The vector
+ * instructions are enabled per function with target attributes, so
+ * the file needs no special compiler flags and still runs on a CPU
+ * without AVX2.
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#include <string.h>
+
+#include "Scanner.h"
+#include "CharClass.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCAN_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
+// internal functions (visible to this file only)
+static void scanBlockScalar (const char * block, ScanMasks * masks);
+static void scanBlockDetect (const char * block, ScanMasks * masks);
+static void chooseScanBlock (void) __attribute__ ((constructor));
+
+/* The scanBlock implementation in use; chosen when the program starts. */
+void (* scanBlock) (const char * block, ScanMasks * masks) = scanBlockDetect;
+static const char * implementationName = "scalar";
+
+
+/**
+ * scanBlockScalar -- the portable implementation, one table lookup per
+ *                    byte
+ */
+static void scanBlockScalar (const char * block, ScanMasks * masks)
+{
+    uint64_t space = 0, delim = 0, comment = 0, newline = 0, colons = 0;
+
+    for ( int i = 0; i < SCAN_BLOCK_SIZE; i++ )
+    {
+        unsigned char class = CHAR_CLASS_OF (block[i]);
+        uint64_t      bit = (uint64_t) 1 << i;
+
+        if ( class & CC_SPACE )   space |= bit;
+        if ( class & CC_DELIM )   delim |= bit;
+        if ( class & CC_COMMENT ) comment |= bit;
+        if ( class & CC_NEWLINE ) newline |= bit;
+        if ( class & CC_COLON )   colons |= bit;
+    }
+
+    masks->space = space;
+    masks->delim = delim;
+    masks->comment = comment;
+    masks->newline = newline;
+    masks->colon = colons;
+}
+
+#if SCAN_X86
+
+/**
+ * scanBlockSSE2 -- four 16-byte vectors per block
+ */
+__attribute__((target("sse2")))
+static void scanBlockSSE2 (const char * block, ScanMasks * masks)
+{
+    const __m128i spaceChar = _mm_set1_epi8 (' ');
+    const __m128i tabChar = _mm_set1_epi8 ('\t');
+    const __m128i four = _mm_set1_epi8 (4);
+    const __m128i comma = _mm_set1_epi8 (',');
+    const __m128i lparen = _mm_set1_epi8 ('(');
+    const __m128i rparen = _mm_set1_epi8 (')');
+    const __m128i colon = _mm_set1_epi8 (':');
+    const __m128i hash = _mm_set1_epi8 ('#');
+    const __m128i nl = _mm_set1_epi8 ('\n');
+    uint64_t space = 0, delim = 0, comment = 0, newline = 0, colons = 0;
+
+    for ( int i = 0; i < SCAN_BLOCK_SIZE; i += 16 )
+    {
+        __m128i bytes = _mm_loadu_si128 ((const __m128i *) (block + i));
+
+        /* '\t'..'\r' is the range 0..4 after subtracting '\t' */
+        __m128i offset = _mm_sub_epi8 (bytes, tabChar);
+        __m128i ctrl = _mm_cmpeq_epi8 (_mm_min_epu8 (offset, four), offset);
+        __m128i isSpace = _mm_or_si128 (ctrl,
+                                        _mm_cmpeq_epi8 (bytes, spaceChar));
+        __m128i isColon = _mm_cmpeq_epi8 (bytes, colon);
+        __m128i isDelim = _mm_or_si128 (
+                _mm_or_si128 (_mm_cmpeq_epi8 (bytes, comma),
+                              _mm_cmpeq_epi8 (bytes, lparen)),
+                _mm_or_si128 (_mm_cmpeq_epi8 (bytes, rparen), isColon));
+
+        space |= (uint64_t) (uint16_t) _mm_movemask_epi8 (isSpace) << i;
+        delim |= (uint64_t) (uint16_t) _mm_movemask_epi8 (isDelim) << i;
+        comment |= (uint64_t) (uint16_t)
+                _mm_movemask_epi8 (_mm_cmpeq_epi8 (bytes, hash)) << i;
+        newline |= (uint64_t) (uint16_t)
+                _mm_movemask_epi8 (_mm_cmpeq_epi8 (bytes, nl)) << i;
+        colons |= (uint64_t) (uint16_t) _mm_movemask_epi8 (isColon) << i;
+    }
+
+    masks->space = space;
+    masks->delim = delim;
+    masks->comment = comment;
+    masks->newline = newline;
+    masks->colon = colons;
+}
+
+/**
+ * scanBlockAVX2 -- two 32-byte vectors per block
+ */
+__attribute__((target("avx2")))
+static void scanBlockAVX2 (const char * block, ScanMasks * masks)
+{
+    const __m256i spaceChar = _mm256_set1_epi8 (' ');
+    const __m256i tabChar = _mm256_set1_epi8 ('\t');
+    const __m256i four = _mm256_set1_epi8 (4);
+    const __m256i comma = _mm256_set1_epi8 (',');
+    const __m256i lparen = _mm256_set1_epi8 ('(');
+    const __m256i rparen = _mm256_set1_epi8 (')');
+    const __m256i colon = _mm256_set1_epi8 (':');
+    const __m256i hash = _mm256_set1_epi8 ('#');
+    const __m256i nl = _mm256_set1_epi8 ('\n');
+    uint64_t space = 0, delim = 0, comment = 0, newline = 0, colons = 0;
+
+    for ( int i = 0; i < SCAN_BLOCK_SIZE; i += 32 )
+    {
+        __m256i bytes = _mm256_loadu_si256 ((const __m256i *) (block + i));
+
+        /* '\t'..'\r' is the range 0..4 after subtracting '\t' */
+        __m256i offset = _mm256_sub_epi8 (bytes, tabChar);
+        __m256i ctrl = _mm256_cmpeq_epi8 (_mm256_min_epu8 (offset, four),
+                                          offset);
+        __m256i isSpace = _mm256_or_si256 (ctrl,
+                                   _mm256_cmpeq_epi8 (bytes, spaceChar));
+        __m256i isColon = _mm256_cmpeq_epi8 (bytes, colon);
+        __m256i isDelim = _mm256_or_si256 (
+                _mm256_or_si256 (_mm256_cmpeq_epi8 (bytes, comma),
+                                 _mm256_cmpeq_epi8 (bytes, lparen)),
+                _mm256_or_si256 (_mm256_cmpeq_epi8 (bytes, rparen), isColon));
+
+        space |= (uint64_t) (uint32_t) _mm256_movemask_epi8 (isSpace) << i;
+        delim |= (uint64_t) (uint32_t) _mm256_movemask_epi8 (isDelim) << i;
+        comment |= (uint64_t) (uint32_t)
+                _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (bytes, hash)) << i;
+        newline |= (uint64_t) (uint32_t)
+                _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (bytes, nl)) << i;
+        colons |= (uint64_t) (uint32_t) _mm256_movemask_epi8 (isColon) << i;
+    }
+
+    masks->space = space;
+    masks->delim = delim;
+    masks->comment = comment;
+    masks->newline = newline;
+    masks->colon = colons;
+}
+
+#endif /* SCAN_X86 */
+
+#if SCAN_NEON
+
+/**
+ * neonMovemask -- gather the top bit of each of 16 bytes (each of which
+ *                 is 0x00 or 0xFF) into a 16-bit mask
+ */
+static inline uint16_t neonMovemask (uint8x16_t bytes)
+{
+    static const uint8_t weights[16] =
+        { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t bits = vandq_u8 (bytes, vld1q_u8 (weights));
+    uint8x8_t  sums = vpadd_u8 (vget_low_u8 (bits), vget_high_u8 (bits));
+
+    sums = vpadd_u8 (sums, sums);
+    sums = vpadd_u8 (sums, sums);
+    return vget_lane_u16 (vreinterpret_u16_u8 (sums), 0);
+}
+
+/**
+ * scanBlockNEON -- four 16-byte vectors per block
+ */
+static void scanBlockNEON (const char * block, ScanMasks * masks)
+{
+    uint64_t space = 0, delim = 0, comment = 0, newline = 0, colons = 0;
+
+    for ( int i = 0; i < SCAN_BLOCK_SIZE; i += 16 )
+    {
+        uint8x16_t bytes = vld1q_u8 ((const uint8_t *) (block + i));
+
+        /* '\t'..'\r' is the range 0..4 after subtracting '\t' */
+        uint8x16_t ctrl = vcleq_u8 (vsubq_u8 (bytes, vdupq_n_u8 ('\t')),
+                                    vdupq_n_u8 (4));
+        uint8x16_t isSpace = vorrq_u8 (ctrl, vceqq_u8 (bytes, vdupq_n_u8 (' ')));
+        uint8x16_t isColon = vceqq_u8 (bytes, vdupq_n_u8 (':'));
+        uint8x16_t isDelim = vorrq_u8 (
+                vorrq_u8 (vceqq_u8 (bytes, vdupq_n_u8 (',')),
+                          vceqq_u8 (bytes, vdupq_n_u8 ('('))),
+                vorrq_u8 (vceqq_u8 (bytes, vdupq_n_u8 (')')), isColon));
+
+        space |= (uint64_t) neonMovemask (isSpace) << i;
+        delim |= (uint64_t) neonMovemask (isDelim) << i;
+        comment |= (uint64_t)
+                neonMovemask (vceqq_u8 (bytes, vdupq_n_u8 ('#'))) << i;
+        newline |= (uint64_t)
+                neonMovemask (vceqq_u8 (bytes, vdupq_n_u8 ('\n'))) << i;
+        colons |= (uint64_t) neonMovemask (isColon) << i;
+    }
+
+    masks->space = space;
+    masks->delim = delim;
+    masks->comment = comment;
+    masks->newline = newline;
+    masks->colon = colons;
+}
+
+#endif /* SCAN_NEON */
+
+/**
+ * scanBlockDetect -- choose the best implementation for this CPU, then
+ *                    scan the block with it (only if chooseScanBlock
+ *                    has not been run yet)
+ */
+static void scanBlockDetect (const char * block, ScanMasks * masks)
+{
+    chooseScanBlock ();
+    scanBlock (block, masks);
+}
+
+/**
+ * chooseScanBlock -- choose the best implementation for this CPU; run
+ *                    before main, while there is only one thread
+ */
+static void chooseScanBlock (void)
+{
+    void (* best) (const char *, ScanMasks *) = scanBlockScalar;
+    const char * name = "scalar";
+
+#if SCAN_X86
+    __builtin_cpu_init ();
+    if ( __builtin_cpu_supports ("avx2") )
+    {
+        best = scanBlockAVX2;
+        name = "avx2";
+    }
+    else if ( __builtin_cpu_supports ("sse2") )
+    {
+        best = scanBlockSSE2;
+        name = "sse2";
+    }
+#elif SCAN_NEON
+    best = scanBlockNEON;       /* NEON is always there on these CPUs */
+    name = "neon";
+#endif
+
+    implementationName = name;
+    scanBlock = best;
+}
+
+void scanPartialBlock (const char * block, int length, ScanMasks * masks)
+{
+    char     padded[SCAN_BLOCK_SIZE];
+    uint64_t valid;
+
+    if ( length >= SCAN_BLOCK_SIZE )
+    {
+        scanBlock (block, masks);
+        return;
+    }
+
+    /* Scan a copy, then clear the bits beyond the real bytes. */
+    memcpy (padded, block, length);
+    memset (padded + length, 0, SCAN_BLOCK_SIZE - length);
+    scanBlock (padded, masks);
+
+    valid = ((uint64_t) 1 << length) - 1;
+    masks->space &= valid;
+    masks->delim &= valid;
+    masks->comment &= valid;
+    masks->newline &= valid;
+    masks->colon &= valid;
+}
+
+const char * scanImplementation ()
+{
+    if ( scanBlock == scanBlockDetect )
+        chooseScanBlock ();             /* make the choice now */
+    return implementationName;
+}
+
+int scanSelect (const char * name)
+{
+    void (* chosen) (const char *, ScanMasks *) = NULL;
+    const char * chosenName = "scalar";
+
+    if ( strcmp (name, "scalar") == 0 )
+        chosen = scanBlockScalar;
+#if SCAN_X86
+    __builtin_cpu_init ();
+    if ( strcmp (name, "avx2") == 0 && __builtin_cpu_supports ("avx2") )
+    {
+        chosen = scanBlockAVX2;
+        chosenName = "avx2";
+    }
+    else if ( strcmp (name, "sse2") == 0 && __builtin_cpu_supports ("sse2") )
+    {
+        chosen = scanBlockSSE2;
+        chosenName = "sse2";
+    }
+#elif SCAN_NEON
+    if ( strcmp (name, "neon") == 0 )
+    {
+        chosen = scanBlockNEON;
+        chosenName = "neon";
+    }
+#endif
+
+    if ( chosen == NULL )
+        return 0;
+    implementationName = chosenName;
+    scanBlock = chosen;
+    return 1;
+}
+
+int scanTokens (const char * line, int length, TokenSpan spans[],
+                int maxSpans)
+{
+    ScanMasks    masks;
+    uint64_t     inToken;       /* bit i set if byte i is part of a token */
+    uint64_t     starts;        /* bit i set if a token starts at byte i */
+    uint64_t     ends;          /* bit i set if a token ended before byte i */
+    uint64_t     carry = 0;     /* 1 if previous block ended inside a token */
+    uint64_t     valid;
+    const char * start = NULL;  /* start of the token still open, if any */
+    int          count = 0;
+    int          blockLength;
+
+    for ( int offset = 0; offset < length; offset += SCAN_BLOCK_SIZE )
+    {
+        blockLength = length - offset;
+        if ( blockLength >= SCAN_BLOCK_SIZE )
+        {
+            scanBlock (line + offset, &masks);
+            valid = ~(uint64_t) 0;
+        }
+        else
+        {
+            scanPartialBlock (line + offset, blockLength, &masks);
+            valid = ((uint64_t) 1 << blockLength) - 1;
+        }
+
+        inToken = ~(masks.space | masks.delim) & valid;
+        starts = inToken & ~((inToken << 1) | carry);
+        ends = ~inToken & ((inToken << 1) | carry);
+
+        /* Token starts and ends alternate; take whichever comes next. */
+        for ( ;; )
+        {
+            if ( start != NULL )
+            {
+                if ( ends == 0 )
+                    break;
+                const char * end = line + offset + __builtin_ctzll (ends);
+                ends &= ends - 1;
+                if ( end - start > UINT16_MAX )
+                    return -1;
+                if ( count < maxSpans )
+                {
+                    spans[count].ptr = start;
+                    spans[count].len = end - start;
+                }
+                count++;
+                start = NULL;
+            }
+            else
+            {
+                if ( starts == 0 )
+                    break;
+                start = line + offset + __builtin_ctzll (starts);
+                starts &= starts - 1;
+            }
+        }
+
+        carry = inToken >> (SCAN_BLOCK_SIZE - 1);
+    }
+
+    /* A token that runs to the end of the line ends there. */
+    if ( start != NULL )
+    {
+        if ( line + length - start > UINT16_MAX )
+            return -1;
+        if ( count < maxSpans )
+        {
+            spans[count].ptr = start;
+            spans[count].len = line + length - start;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+int scanCodeLength (const char * line, int length)
+{
+    ScanMasks masks;
+    uint64_t  code = 0;         /* bits of the non-whitespace bytes */
+    uint64_t  valid;
+    int       blockLength;
+
+    for ( int offset = 0; offset < length; offset += SCAN_BLOCK_SIZE )
+    {
+        blockLength = length - offset;
+        if ( blockLength >= SCAN_BLOCK_SIZE )
+        {
+            scanBlock (line + offset, &masks);
+            valid = ~(uint64_t) 0;
+        }
+        else
+        {
+            scanPartialBlock (line + offset, blockLength, &masks);
+            valid = ((uint64_t) 1 << blockLength) - 1;
+        }
+
+        /* Only what comes before the first '#' can be code. */
+        if ( masks.comment != 0 )
+        {
+            valid &= (masks.comment & -masks.comment) - 1;
+            code |= ~masks.space & valid;
+            return code != 0 ? offset + __builtin_ctzll (masks.comment) : 0;
+        }
+        code |= ~masks.space & valid;
+    }
+    return code != 0 ? length : 0;
+}
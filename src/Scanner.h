@@ -0,0 +1,95 @@
+/*
+ * Scanner: bulk classification of source bytes, 64 at a time
+ *
+ * This file declares the functions that classify a block of up to 64
+ * source bytes at once and return, for each character class the
+ * tokenizer cares about (see CharClass.h), a 64-bit mask with bit i
+ * set if byte i of the block is in that class.  Line boundaries and
+ * token boundaries can then be found for a whole block with a few
+ * bit operations instead of one byte at a time.
+ *
+ * There are several implementations of scanBlock: SSE2 and AVX2 on
+ * x86, NEON on ARM, and a portable scalar one that uses the CHAR_CLASS
+ * table.  The fastest one the CPU supports is chosen at run time, when
+ * the program starts (or, failing that, the first time scanBlock is
+ * called), so threads never race to choose it.
+ *
+ * EXAMPLE:
+ *      ScanMasks masks;
+ *      scanBlock (ptr, &masks);            // ptr has >= 64 bytes left
+ *      if ( masks.newline != 0 )
+ *          lineEnd = ptr + __builtin_ctzll (masks.newline);
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#ifndef _SCANNER_H
+#define _SCANNER_H
+
+#include <stdint.h>
+
+#include "getToken.h"
+
+#define SCAN_BLOCK_SIZE 64
+
+typedef struct {
+        uint64_t space;         /* whitespace (CC_SPACE) */
+        uint64_t delim;         /* token delimiters (CC_DELIM) */
+        uint64_t comment;       /* '#' (CC_COMMENT) */
+        uint64_t newline;       /* '\n' (CC_NEWLINE) */
+        uint64_t colon;         /* ':', which ends a label (CC_COLON) */
+} ScanMasks;
+
+extern void (* scanBlock) (const char * block, ScanMasks * masks);
+        /* Precondition: block points to at least SCAN_BLOCK_SIZE bytes.
+         * Postcondition: masks describes the SCAN_BLOCK_SIZE bytes
+         *      starting at block.
+         */
+
+void scanPartialBlock (const char * block, int length, ScanMasks * masks);
+        /* Precondition: 0 <= length <= SCAN_BLOCK_SIZE.
+         * Postcondition: masks describes the first length bytes
+         *      starting at block; no bits are set for the bytes beyond
+         *      them.  Never reads beyond block + length.
+         */
+
+const char * scanImplementation ();
+        /* Returns the name of the scanBlock implementation in use
+         *      ("avx2", "sse2", "neon", or "scalar").
+         */
+
+int scanSelect (const char * name);
+        /* Postcondition: if this CPU supports the named implementation
+         *      of scanBlock (see scanImplementation), it is the one in
+         *      use from now on.  For tests and benchmarks that compare
+         *      the implementations; not safe while other threads scan.
+         * Returns 1 if the implementation was chosen; 0 if not.
+         */
+
+int scanTokens (const char * line, int length, TokenSpan spans[],
+                int maxSpans);
+        /* Finds the tokens in the first length characters of line, and
+         *      fills spans with the first maxSpans of them.  A token is
+         *      a run of characters that are neither whitespace nor
+         *      delimiters (see CharClass.h).  Unlike getToken, which
+         *      only skips whitespace before a token, scanTokens never
+         *      makes a delimiter part of one: where getToken, started
+         *      on a delimiter (a leading one, one after a space, or
+         *      the second of two), finds "," or ",$t1", scanTokens
+         *      finds nothing or "$t1".
+         * Returns the total number of tokens found (which may be more
+         *      than maxSpans), or -1 if a token is too long for a
+         *      TokenSpan.
+         */
+
+int scanCodeLength (const char * line, int length);
+        /* Returns the number of characters of the first length
+         *      characters of line that come before its comment (the
+         *      first '#'), or length if it has none; or 0 if those are
+         *      all whitespace (a blank line, or a comment on its own).
+         *      The line is classified a block at a time, with the
+         *      comment and whitespace masks, up to its first '#'.
+         */
+
+#endif
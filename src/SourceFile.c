@@ -0,0 +1,420 @@
+/*
+ * Source File: functions to load an assembly language source file and
+ * hand it out one line at a time
+ *
+ * This file provides the definitions of the functions declared in
+ * SourceFile.h.  A regular, non-empty file is memory-mapped read-only;
+ * the standard input, pipes, and empty files are read into a single
+ * allocated buffer instead.  (On systems without mmap, every file is
+ * read into a buffer.)  Lines are found with the newline masks from
+ * the scanner, one 64-byte block at a time, and each line's comment,
+ * and whether anything but whitespace comes before it, with the
+ * comment and whitespace masks of the same blocks.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added sourceNextCodeLine.
+ *   Modified:  10/14/2026   Slices may leave the skipped lines uncounted.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#if ! defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "SourceFile.h"
+#include "Scanner.h"
+#include "printFuncs.h"
+#include "Stats.h"
+
+// internal global variables (global to this file only)
+static const char * ERROR0 = "Error: Cannot open file %s.\n";
+static const char * ERROR1 = "Error: Cannot read file %s.\n";
+static const char * ERROR2 = "Error: cannot allocate space in memory.\n";
+
+static const size_t FIRST_READ_SIZE = 64 * 1024;
+
+// internal functions (visible to this file only)
+static int readWholeStream(SourceFile * source, FILE * fp, const char * name);
+static const char * nextNewline(SourceFile * source, const char ** comment,
+                               int * hasCode);
+
+int sourceOpen (SourceFile * source, const char * filename)
+  /* Postcondition: the contents of the named file (or of the
+   *      standard input, if filename is NULL) are in memory and
+   *      source is positioned at the first line.
+   * Returns 1 if everything went OK; 0 (after printing an error)
+   *      if the file could not be opened or read.
+   */
+{
+        FILE * fp;
+        int    ok;
+
+        source->data = NULL;
+        source->size = 0;
+        source->mapped = 0;
+        source->countSkipped = 1;
+
+        if ( filename == NULL )
+            ok = readWholeStream (source, stdin, "<stdin>");
+        else
+        {
+#if ! defined(_WIN32)
+            /* Map a regular file straight into memory. */
+            struct stat info;
+            int         fd;
+            void *      data;
+
+            if ( (fd = open (filename, O_RDONLY)) < 0 )
+            {
+                printError (ERROR0, filename);
+                return 0;
+            }
+            if ( fstat (fd, &info) == 0 && S_ISREG (info.st_mode) &&
+                 info.st_size > 0 )
+            {
+                data = mmap (NULL, info.st_size, PROT_READ, MAP_PRIVATE,
+                             fd, 0);
+                if ( data != MAP_FAILED )
+                {
+                    (void) close (fd);
+                    source->data = data;
+                    source->size = info.st_size;
+                    source->mapped = 1;
+                    sourceRewind (source);
+                    return 1;
+                }
+            }
+            (void) close (fd);
+#endif
+            /* Not a regular file (or it couldn't be mapped); read it. */
+            if ( (fp = fopen (filename, "rb")) == NULL )
+            {
+                printError (ERROR0, filename);
+                return 0;
+            }
+            ok = readWholeStream (source, fp, filename);
+            (void) fclose (fp);
+        }
+
+        sourceRewind (source);
+        return ok;
+}
+
+int sourceNextLine (SourceFile * source, LineView * line)
+  /* Postcondition: if there is another line in the source, line
+   *      describes it and source is positioned at the line after
+   *      it.  A final line without a newline is still a line.
+   * Returns 1 if a line was found; 0 at the end of the source.
+   */
+{
+        const char * end = source->data + source->size;
+        const char * newline;
+        const char * comment;
+        int          hasCode;
+
+        if ( source->next == NULL || source->next >= end )
+            return 0;
+
+        line->ptr = source->next;
+        newline = nextNewline (source, &comment, &hasCode);
+        line->length = newline - source->next;
+        line->lineNbr = ++source->lineNbr;
+
+        /* Treat "\r\n" line endings like "\n". */
+        if ( line->length > 0 && line->ptr[line->length - 1] == '\r' )
+            line->length--;
+
+        source->next = newline + 1;
+        return 1;
+}
+
+int sourceNextCodeLine (SourceFile * source, LineView * line)
+  /* Postcondition: the same as for sourceNextLine, except that the
+   *      lines with nothing but whitespace before their first '#' are
+   *      skipped, and line ends just before its '#'.
+   * Returns 1 if a line was found; 0 at the end of the source.
+   */
+{
+        const char * end = source->data + source->size;
+        const char * newline = NULL;
+        const char * comment = NULL;
+        int          hasCode = 0;
+        long         nbrSkipped = 0;
+
+        while ( source->next != NULL && source->next < end )
+        {
+            line->ptr = source->next;
+            newline = nextNewline (source, &comment, &hasCode);
+            source->lineNbr++;
+            source->next = newline + 1;
+            if ( hasCode )
+                break;
+            nbrSkipped++;
+        }
+        if ( source->countSkipped )
+            countStat (STAT_SKIPPED, nbrSkipped);
+        if ( ! hasCode )
+            return 0;
+
+        line->length = comment - line->ptr;
+        line->lineNbr = source->lineNbr;
+
+        /* Treat "\r\n" line endings like "\n". */
+        if ( comment == newline && line->ptr[line->length - 1] == '\r' )
+            line->length--;
+        return 1;
+}
+
+void sourceFromMemory (SourceFile * source, const char * data,
+                       size_t size)
+  /* Postcondition: source hands out the lines of the size bytes at
+   *      data, which belong to the caller.
+   */
+{
+        source->data = data;
+        source->size = size;
+        source->mapped = 0;
+        source->countSkipped = 1;
+        sourceRewind (source);
+}
+
+void sourceSlice (SourceFile * slice, const SourceFile * source,
+                  size_t begin, size_t end, int firstLineNbr,
+                  int countSkipped)
+  /* Postcondition: slice hands out the lines of source from offset
+   *      begin up to offset end, the first of them with the line
+   *      number firstLineNbr, and counts the lines it skips only if
+   *      countSkipped is 1.
+   */
+{
+        sourceFromMemory (slice, source->data + begin, end - begin);
+        slice->lineNbr = firstLineNbr - 1;
+        slice->countSkipped = countSkipped;
+}
+
+int sourceCountLabels (const SourceFile * source)
+  /* Returns the number of colons in the source that are not in
+   *      comments, or the number of lines if that is smaller (there is
+   *      at most one label per line): an upper bound on the number of
+   *      labels.
+   */
+{
+        ScanMasks masks;
+        size_t    length;
+        uint64_t  later;            /* bits after the current position */
+        uint64_t  inComment;        /* bits of the block in comments */
+        int       commentOpen = 0;  /* 1 if the block starts in one */
+        long      nbrColons = 0;
+        long      nbrLines = 1;       /* newlines, plus the last line */
+
+        for ( size_t offset = 0; offset < source->size; offset += length )
+        {
+            length = source->size - offset;
+            if ( length > SCAN_BLOCK_SIZE )
+                length = SCAN_BLOCK_SIZE;
+            scanPartialBlock (source->data + offset, length, &masks);
+            nbrLines += __builtin_popcountll (masks.newline);
+
+            /* Most blocks have no comment in them: just count. */
+            if ( ! commentOpen && masks.comment == 0 )
+            {
+                nbrColons += __builtin_popcountll (masks.colon);
+                continue;
+            }
+
+            /* Otherwise mark the bytes from each '#' (or the start of
+             * the block) up to the next newline (or the end).
+             */
+            inComment = 0;
+            later = ~(uint64_t) 0;
+            for ( ;; )
+            {
+                uint64_t bound = (commentOpen ? masks.newline
+                                              : masks.comment) & later;
+                uint64_t before = bound != 0
+                                  ? (bound & -bound) - 1 : ~(uint64_t) 0;
+
+                if ( commentOpen )
+                    inComment |= later & before;
+                if ( bound == 0 )
+                    break;
+
+                /* the newline itself ends the comment; a '#' starts one */
+                later = ~before & ~(bound & -bound);
+                if ( ! commentOpen )
+                    later |= bound & -bound;
+                commentOpen = ! commentOpen;
+            }
+            nbrColons += __builtin_popcountll (masks.colon & ~inComment);
+        }
+
+        if ( nbrColons > nbrLines )
+            nbrColons = nbrLines;
+        return nbrColons < INT_MAX ? (int) nbrColons : INT_MAX;
+}
+
+void sourceRewind (SourceFile * source)
+  /* Postcondition: source is positioned at the first line again.
+   */
+{
+        source->next = source->data;
+        source->lineNbr = 0;
+        source->scanned = 0;
+        source->maskBase = 0;
+        source->newlines = 0;
+        source->comments = 0;
+        source->code = 0;
+}
+
+void sourceClose (SourceFile * source)
+  /* Postcondition: the memory holding the source has been
+   *      released; line views into it are no longer valid.
+   */
+{
+#if ! defined(_WIN32)
+        if ( source->mapped )
+            (void) munmap ((void *) source->data, source->size);
+        else
+#endif
+            free ((void *) source->data);
+
+        source->data = NULL;
+        source->size = 0;
+        source->mapped = 0;
+        source->next = NULL;
+}
+
+static const char * nextNewline(SourceFile * source, const char ** comment,
+                               int * hasCode)
+ /* Returns a pointer to the next newline in the source that hasn't
+  * been used yet, or to the end of the source if there is none; that
+  * is, to the end of the line starting at source->next.  Sets *comment
+  * to the line's first '#' (or to its end, if it has none), and
+  * *hasCode to 1 if anything but whitespace comes before that, or to 0
+  * if not.  Blocks are scanned only when their newlines are needed.
+  */
+{
+        ScanMasks    masks;
+        size_t       start = source->next - source->data;
+        size_t       length;
+        uint64_t     inLine;    /* the bits of the block in the line */
+        uint64_t     found;
+        const char * end = NULL;
+
+        *comment = NULL;
+        *hasCode = 0;
+        while ( end == NULL )
+        {
+            if ( start >= source->scanned )
+            {
+                if ( source->scanned >= source->size )
+                {
+                    end = source->data + source->size;
+                    break;
+                }
+
+                length = source->size - source->scanned;
+                if ( length > SCAN_BLOCK_SIZE )
+                    length = SCAN_BLOCK_SIZE;
+                scanPartialBlock (source->data + source->scanned, length,
+                                  &masks);
+                source->maskBase = source->scanned;
+                source->newlines = masks.newline;
+                source->comments = masks.comment;
+                source->code = ~masks.space &
+                               (length < SCAN_BLOCK_SIZE
+                                    ? ((uint64_t) 1 << length) - 1
+                                    : ~(uint64_t) 0);
+                source->scanned += length;
+            }
+
+            /* the part of the line in the block: from its start (or the
+             * start of the block) up to the first newline left, if any
+             */
+            inLine = ~(uint64_t) 0 << (start - source->maskBase);
+            if ( source->newlines != 0 )
+                inLine &= (source->newlines & -source->newlines) - 1;
+
+            /* only what comes before the first '#' can be code */
+            if ( *comment == NULL )
+            {
+                if ( (found = source->comments & inLine) != 0 )
+                {
+                    *comment = source->data + source->maskBase +
+                               __builtin_ctzll (found);
+                    inLine &= (found & -found) - 1;
+                }
+                *hasCode |= (source->code & inLine) != 0;
+            }
+
+            /* use up the first newline left in the block, if any */
+            if ( source->newlines != 0 )
+            {
+                end = source->data + source->maskBase +
+                      __builtin_ctzll (source->newlines);
+                source->newlines &= source->newlines - 1;
+            }
+            start = source->scanned;
+        }
+
+        if ( *comment == NULL )
+            *comment = end;
+        return end;
+}
+
+static int readWholeStream(SourceFile * source, FILE * fp, const char * name)
+ /* Reads everything remaining in fp into one allocated buffer, which
+  * doubles in size whenever it fills up.  Returns 1 if everything went
+  * OK; prints an error and returns 0 otherwise.
+  */
+{
+        size_t capacity = FIRST_READ_SIZE;
+        size_t size = 0;
+        size_t nbrRead;
+        char * buffer;
+        char * bigger;
+
+        countStat (STAT_BYTES, capacity);
+        if ( (buffer = malloc (capacity)) == NULL )
+        {
+            printError ("%s", ERROR2);
+            return 0;
+        }
+
+        while ( (nbrRead = fread (buffer + size, 1, capacity - size, fp)) > 0 )
+        {
+            size += nbrRead;
+            if ( size == capacity )
+            {
+                countStat (STAT_BYTES, 2 * capacity);
+                if ( (bigger = realloc (buffer, 2 * capacity)) == NULL )
+                {
+                    free (buffer);
+                    printError ("%s", ERROR2);
+                    return 0;
+                }
+                buffer = bigger;
+                capacity *= 2;
+            }
+        }
+
+        if ( ferror (fp) )
+        {
+            free (buffer);
+            printError (ERROR1, name);
+            return 0;
+        }
+
+        source->data = buffer;
+        source->size = size;
+        source->mapped = 0;
+        return 1;
+}
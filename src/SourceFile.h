@@ -0,0 +1,141 @@
+/*
+ * Source File: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for a group
+ * of functions that read an assembly language source file into memory
+ * once and then hand it out, one line at a time, to the passes of the
+ * assembler.  A regular file is memory-mapped (read-only); anything
+ * else, such as the standard input or a pipe, is read into a single
+ * buffer.  Either way, the lines handed out are views straight into
+ * that memory: nothing is copied, and nothing may be written through
+ * them.  A line view is NOT null-terminated; use its length instead.
+ *
+ * The source is split into lines 64 bytes at a time: the newline mask
+ * of each block (see Scanner.h) is kept, and the lines in the block are
+ * handed out straight from it.  So are its comment and whitespace
+ * masks, with which sourceNextCodeLine skips the lines that have
+ * nothing but whitespace or a comment on them, and leaves the comment
+ * off the others, without looking at their bytes again: the passes
+ * only ever see the code.
+ *
+ * Since the whole source stays in memory, the second pass can start
+ * again from the first line with sourceRewind instead of reading the
+ * file a second time.
+ *
+ * EXAMPLE:
+ *      SourceFile source;
+ *      LineView   line;
+ *      if ( sourceOpen (&source, filename) )
+ *      {
+ *          while ( sourceNextLine (&source, &line) )
+ *              printf ("%d: %.*s\n", line.lineNbr, line.length, line.ptr);
+ *          sourceClose (&source);
+ *      }
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added sourceNextCodeLine.
+ *   Modified:  10/14/2026   Slices may leave the skipped lines uncounted.
+ *
+ */
+
+#ifndef _SOURCE_FILE_H
+#define _SOURCE_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* THE DATA STRUCTURES */
+
+/* The first type definition defines the type for a view of a single
+ * line in the source (without its newline character).  The second
+ * defines the type for the source file as a whole.
+ */
+
+typedef struct {
+        const char * ptr;       /* first character of the line */
+        int length;             /* nbr of characters in the line */
+        int lineNbr;            /* line number, starting from 1 */
+} LineView;
+
+typedef struct {
+        const char * data;      /* contents of the whole source */
+        size_t size;            /* nbr of bytes in data */
+        int mapped;             /* 1 if data is mapped; 0 if allocated */
+        const char * next;      /* start of the next line to hand out */
+        int lineNbr;            /* nbr of lines handed out so far */
+        size_t scanned;         /* offset of first byte not yet scanned */
+        size_t maskBase;        /* offset of block described by newlines */
+        uint64_t newlines;      /* newlines in that block not yet used */
+        uint64_t comments;      /* '#'s in that block */
+        uint64_t code;          /* non-whitespace bytes in that block */
+        int countSkipped;       /* 1 if the lines sourceNextCodeLine
+                                 * skips count in STAT_SKIPPED */
+} SourceFile;
+
+
+/* THE FUNCTIONS */
+
+int sourceOpen (SourceFile * source, const char * filename);
+        /* Postcondition: the contents of the named file (or of the
+         *      standard input, if filename is NULL) are in memory and
+         *      source is positioned at the first line.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if the file could not be opened or read.
+         */
+
+int sourceNextLine (SourceFile * source, LineView * line);
+        /* Postcondition: if there is another line in the source, line
+         *      describes it and source is positioned at the line after
+         *      it.  A final line without a newline is still a line.
+         * Returns 1 if a line was found; 0 at the end of the source.
+         */
+
+int sourceNextCodeLine (SourceFile * source, LineView * line);
+        /* Postcondition: the same as for sourceNextLine, except that
+         *      the lines with nothing but whitespace before their first
+         *      '#' (if any) are skipped (but still numbered), and line
+         *      ends just before the '#' of the one it describes.
+         * Returns 1 if a line was found; 0 at the end of the source.
+         */
+
+void sourceFromMemory (SourceFile * source, const char * data,
+                       size_t size);
+        /* Postcondition: source hands out the lines of the size bytes
+         *      at data, which belong to the caller (and must stay there
+         *      as long as source is used); it must not be closed.
+         */
+
+void sourceSlice (SourceFile * slice, const SourceFile * source,
+                  size_t begin, size_t end, int firstLineNbr,
+                  int countSkipped);
+        /* Precondition: begin and end are offsets in source, each at
+         *      the start of a line (or the end of the source).
+         * Postcondition: slice hands out the lines of source from
+         *      offset begin up to offset end, the first of them with
+         *      the line number firstLineNbr.  The slice shares source's
+         *      memory; it must not be closed, and is only valid as long
+         *      as source is open.  (Used to split a source among
+         *      threads.)  The lines it skips count in STAT_SKIPPED
+         *      only if countSkipped is 1, so that a slice that is read
+         *      more than once need not count them every time.
+         */
+
+int sourceCountLabels (const SourceFile * source);
+        /* Returns an upper bound on the number of labels in the whole
+         *      source: the number of colons that are not in comments,
+         *      or the number of lines, if that is smaller.  They are
+         *      counted with the scanner's masks (see Scanner.h), 64
+         *      bytes at a time.  (Used to size the label table before
+         *      the labels are added to it.)
+         */
+
+void sourceRewind (SourceFile * source);
+        /* Postcondition: source is positioned at the first line again.
+         */
+
+void sourceClose (SourceFile * source);
+        /* Postcondition: the memory holding the source has been
+         *      released; line views into it are no longer valid.
+         */
+
+#endif
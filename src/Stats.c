@@ -0,0 +1,91 @@
+/*
+ * Stats: instrumentation counters and phase timing
+ *
+ * This file provides the definitions of the functions declared in
+ * Stats.h.  The counters and phase times are plain arrays of 64-bit
+ * integers, added to with relaxed atomic additions: nothing is ever
+ * read from them until statsPrint (or statsCount), after the threads
+ * are done.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added statsCount.
+ *
+ */
+
+#include <time.h>
+
+#include "Stats.h"
+
+int statsEnabled = 0;
+
+static long long counters[NBR_COUNTERS];
+static long long phaseTimes[NBR_PHASES];       /* in nanoseconds */
+
+static const char * PHASE_NAMES[NBR_PHASES] =
+        { "load", "pass1", "labels", "pass2", "flush" };
+static const char * COUNTER_NAMES[NBR_COUNTERS] =
+        { "lines", "skipped", "tokens", "labels", "lookups", "probes",
+          "resizes", "bytes" };
+
+void statsAdd (StatCounter counter, long long n)
+  /* Postcondition: n has been added to the counter. */
+{
+        __atomic_fetch_add (&counters[counter], n, __ATOMIC_RELAXED);
+}
+
+long long statsClock (void)
+  /* Returns the time on the monotonic clock, in nanoseconds, if
+   *      statistics are being recorded; 0 otherwise.
+   */
+{
+        struct timespec now;
+
+        if ( ! statsEnabled || clock_gettime (CLOCK_MONOTONIC, &now) != 0 )
+            return 0;
+        return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+void statsTime (StatPhase phase, long long start)
+  /* Postcondition: if statistics are being recorded, the time since
+   *      start has been added to the phase.
+   */
+{
+        if ( statsEnabled )
+            __atomic_fetch_add (&phaseTimes[phase], statsClock () - start,
+                                __ATOMIC_RELAXED);
+}
+
+long long statsCount (StatCounter counter)
+  /* Returns the total of the counter so far. */
+{
+        return counters[counter];
+}
+
+void statsClear (void)
+  /* Postcondition: every counter and phase is back at 0. */
+{
+        for ( int i = 0; i < NBR_COUNTERS; i++ )
+            counters[i] = 0;
+        for ( int i = 0; i < NBR_PHASES; i++ )
+            phaseTimes[i] = 0;
+}
+
+void statsPrint (FILE * stream, int json)
+  /* Postcondition: the phase times (in milliseconds) and the counters
+   *      have been printed to stream on one line, as text or JSON.
+   */
+{
+        double probesPerLookup = counters[STAT_LOOKUPS] > 0
+                ? (double) counters[STAT_PROBES] / counters[STAT_LOOKUPS]
+                : 0;
+
+        for ( int i = 0; i < NBR_PHASES; i++ )
+            fprintf (stream, json ? "%s\"%s_ms\": %.3f" : "%s%s %.3f ms",
+                     i == 0 ? (json ? "{" : "stats: ") : ", ",
+                     PHASE_NAMES[i], phaseTimes[i] / 1e6);
+        for ( int i = 0; i < NBR_COUNTERS; i++ )
+            fprintf (stream, json ? ", \"%s\": %lld" : ", %s %lld",
+                     COUNTER_NAMES[i], counters[i]);
+        fprintf (stream, json ? ", \"probes_per_lookup\": %.2f}\n"
+                              : ", probes/lookup %.2f\n", probesPerLookup);
+}
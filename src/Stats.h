@@ -0,0 +1,108 @@
+/*
+ * Stats: instrumentation counters and phase timing
+ *
+ * This file provides the declarations for an opt-in record of where an
+ * assembly spends its time and how much work it does.  Nothing is
+ * recorded unless statsEnabled has been set (the assembler's -p and -P
+ * options do this), so the counting in the hot paths costs no more
+ * than a test of a flag that is almost always 0.  Code that counts a
+ * lot in a loop should count into a local variable and add it up once
+ * at the end.
+ *
+ * The phases are timed with a monotonic clock:
+ *      STAT_LOAD       reading (or mapping) the input
+ *      STAT_PASS1      pass 1 (or, with -s, the whole single pass)
+ *      STAT_LABELS     the part of pass 1 (or of the single pass) spent
+ *                      adding labels to the label table; it is included
+ *                      in STAT_PASS1 as well
+ *      STAT_PASS2      pass 2, encoding the instructions
+ *      STAT_FLUSH      formatting and writing out the machine code
+ * and the counters are:
+ *      STAT_LINES      source lines parsed
+ *      STAT_SKIPPED    comment and blank lines the input skipped before
+ *                      they got to be parsed (see sourceNextCodeLine)
+ *      STAT_TOKENS     tokens found on them
+ *      STAT_LABELS_ADDED   labels defined (with addLabel or addLabelLen)
+ *      STAT_LOOKUPS    searches of the hash index of a label table
+ *      STAT_PROBES     index slots those searches looked at
+ *      STAT_RESIZES    calls to tableResize
+ *      STAT_BYTES      bytes requested from malloc and realloc for the
+ *                      label tables, the intermediate representation,
+ *                      the output, the fixups, and the input
+ * The totals are for the whole process: threads add to them at once
+ * (with atomic additions), and nothing but statsClear ever sets them
+ * back to 0.
+ *
+ * EXAMPLE:
+ *      long long start = statsClock ();
+ *      ... pass 1 ...
+ *      statsTime (STAT_PASS1, start);
+ *      countStat (STAT_LINES, nbrLines);
+ *      ...
+ *      statsPrint (stderr, 0);
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added statsCount.
+ *
+ */
+
+#ifndef _STATS_H
+#define _STATS_H
+
+#include <stdio.h>
+
+/* THE DATA STRUCTURES */
+
+typedef enum {
+        STAT_LOAD, STAT_PASS1, STAT_LABELS, STAT_PASS2, STAT_FLUSH,
+        NBR_PHASES
+} StatPhase;
+
+typedef enum {
+        STAT_LINES, STAT_SKIPPED, STAT_TOKENS, STAT_LABELS_ADDED,
+        STAT_LOOKUPS, STAT_PROBES, STAT_RESIZES, STAT_BYTES,
+        NBR_COUNTERS
+} StatCounter;
+
+extern int statsEnabled;        /* 1 to record anything; set it before
+                                 * starting any threads */
+
+
+/* THE FUNCTIONS */
+
+#define countStat(counter, n) \
+        do { if ( statsEnabled ) statsAdd ((counter), (n)); } while (0)
+        /* Adds n to the counter, if statistics are being recorded. */
+
+void statsAdd (StatCounter counter, long long n);
+        /* Postcondition: n has been added to the counter.  (Use
+         *      countStat, which does not call this when statistics are
+         *      not being recorded.)
+         */
+
+long long statsClock (void);
+        /* Returns the time on the monotonic clock, in nanoseconds, if
+         *      statistics are being recorded; 0 otherwise.
+         */
+
+void statsTime (StatPhase phase, long long start);
+        /* Precondition: start was returned by statsClock.
+         * Postcondition: if statistics are being recorded, the time
+         *      since start has been added to the phase.
+         */
+
+long long statsCount (StatCounter counter);
+        /* Returns the total of the counter so far (read once the
+         *      threads adding to it are done).
+         */
+
+void statsClear (void);
+        /* Postcondition: every counter and phase is back at 0. */
+
+void statsPrint (FILE * stream, int json);
+        /* Postcondition: the phase times (in milliseconds) and the
+         *      counters have been printed to stream on one line, as
+         *      text or, if json is 1, as a JSON object.
+         */
+
+#endif
@@ -0,0 +1,694 @@
+/*
+ * Symbol Cache: functions to keep a program's labels between runs
+ *
+ * This file provides the definitions of the functions declared in
+ * SymbolCache.h.  The file written by cacheSave is laid out as in
+ * memory:
+ *      a CacheHeader
+ *      nbrChunks CacheChunk records
+ *      nbrLabels CacheLabel records
+ *      nbrTargets CacheLabel records
+ *      nbrInstrs IRInstr records
+ *      nbrInstrs words of machine code
+ *      namesSize bytes of label names (not null-terminated)
+ * so cacheLoad only has to map it, check that the sizes add up, and
+ * check that the positions in the records are within bounds.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added the instructions, targets, words,
+ *                           and output image (version 2 of the file).
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+
+#if ! defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "SymbolCache.h"
+#include "Instructions.h"
+#include "printFuncs.h"
+
+// internal global variables (global to this file only)
+static const char * ERROR0 = "Error: Cannot write file %s.\n";
+static const char * ERROR1 = "Error: cannot allocate space in memory.\n";
+
+static const char MAGIC[8] = "MIPSSYM";
+static const uint32_t VERSION = 2;
+static const uint32_t ORDER_MARK = 0x01020304;     /* as written */
+
+/* The start of a cache file. */
+typedef struct {
+        char     magic[8];      /* MAGIC */
+        uint32_t version;       /* VERSION */
+        uint32_t byteOrder;     /* ORDER_MARK, in the writer's order */
+        uint32_t nbrChunks;
+        uint32_t nbrLabels;
+        uint32_t nbrTargets;
+        uint32_t nbrInstrs;
+        uint64_t namesSize;     /* nbr of bytes of label names */
+        CacheImage image;
+} CacheHeader;
+
+/* Instruction records translated at a time by cacheSave. */
+#define SAVE_BATCH 1024
+
+// internal functions (visible to this file only)
+static uint64_t hashLine(const char * line, int length);
+static int readCacheFile(SymbolCache * cache, const char * filename);
+static int recordsFit(const SymbolCache * cache, uint32_t nbrLabels,
+                      uint64_t namesSize);
+static int buildIndex(SymbolCache * cache);
+static int addName(SymbolCache * cache, const char * name, int length);
+static int writeInstrs(const SymbolCache * cache, FILE * fp);
+
+void cacheInit (SymbolCache * cache)
+  /* Postcondition: cache is empty: nothing has been read in, and
+   *      nothing built.
+   */
+{
+        cache->file = NULL;
+        cache->fileSize = 0;
+        cache->mapped = 0;
+        cache->chunks = NULL;
+        cache->nbrChunks = 0;
+        cache->labels = NULL;
+        cache->nbrLabels = 0;
+        cache->targets = NULL;
+        cache->nbrTargets = 0;
+        cache->instrs = NULL;
+        cache->words = NULL;
+        cache->nbrInstrs = 0;
+        cache->names = NULL;
+        memset (&cache->image, 0, sizeof cache->image);
+        cache->indexSize = 0;
+        cache->index = NULL;
+        cache->targetEntries = NULL;
+
+        cache->newChunks = NULL;
+        cache->nbrNewChunks = 0;
+        cache->chunkCapacity = 0;
+        cache->newLabels = NULL;
+        cache->nbrNewLabels = 0;
+        cache->labelCapacity = 0;
+        cache->newNames = NULL;
+        cache->namesLength = 0;
+        cache->namesSize = 0;
+        cache->newTargets = NULL;
+        cache->nbrNewTargets = 0;
+        cache->targetCapacity = 0;
+        cache->program = NULL;
+        cache->programWords = NULL;
+        cache->table = NULL;
+        cache->targetOf = NULL;
+        cache->nbrReused = 0;
+        cache->saved = 0;
+}
+
+int cacheLoad (SymbolCache * cache, const char * filename)
+  /* Postcondition: if the named file holds a cache, it is mapped in as
+   *      the cache read in; if not, there is none.
+   * Returns 1 if a cache was read in; 0 if not.
+   */
+{
+        const CacheHeader * header;
+        size_t              expected;
+
+        if ( ! readCacheFile (cache, filename) )
+            return 0;
+
+        /* Is it a cache, written by a machine like this one? */
+        header = cache->file;
+        if ( cache->fileSize >= sizeof(CacheHeader) &&
+             memcmp (header->magic, MAGIC, sizeof MAGIC) == 0 &&
+             header->version == VERSION && header->byteOrder == ORDER_MARK )
+        {
+            expected = sizeof(CacheHeader) +
+                       (size_t) header->nbrChunks * sizeof(CacheChunk) +
+                       ((size_t) header->nbrLabels + header->nbrTargets) *
+                         sizeof(CacheLabel) +
+                       (size_t) header->nbrInstrs *
+                         (sizeof(IRInstr) + sizeof(uint32_t)) +
+                       header->namesSize;
+            if ( expected == cache->fileSize &&
+                 header->nbrChunks <= INT_MAX / 2 &&
+                 header->nbrLabels <= INT_MAX &&
+                 header->nbrTargets <= INT_MAX &&
+                 header->nbrInstrs <= INT_MAX )
+            {
+                cache->chunks = (const CacheChunk *) (header + 1);
+                cache->nbrChunks = header->nbrChunks;
+                cache->labels = (const CacheLabel *)
+                                (cache->chunks + cache->nbrChunks);
+                cache->nbrLabels = header->nbrLabels;
+                cache->targets = cache->labels + cache->nbrLabels;
+                cache->nbrTargets = header->nbrTargets;
+                cache->instrs = (const IRInstr *)
+                                (cache->targets + cache->nbrTargets);
+                cache->nbrInstrs = header->nbrInstrs;
+                cache->words = (const uint32_t *)
+                               (cache->instrs + cache->nbrInstrs);
+                cache->names = (const char *)
+                               (cache->words + cache->nbrInstrs);
+                cache->image = header->image;
+                if ( recordsFit (cache, header->nbrLabels,
+                                 header->namesSize) &&
+                     buildIndex (cache) )
+                    return 1;
+            }
+        }
+
+        /* No use: forget it. */
+        cacheFree (cache);
+        return 0;
+}
+
+size_t cacheNextChunk (SourceFile * source, uint64_t * hash,
+                       int * nbrLines)
+  /* Postcondition: source is positioned after the last line of the
+   *      chunk it was positioned at, *hash is the hash of the chunk,
+   *      and *nbrLines the number of lines in it.
+   * Returns the offset in the source of the end of the chunk.
+   */
+{
+        LineView line;
+        uint64_t lineHash;
+        uint64_t chunkHash = 0;
+        int      count = 0;
+        size_t   end;
+
+        while ( count < MAX_CHUNK_LINES && sourceNextLine (source, &line) )
+        {
+            lineHash = hashLine (line.ptr, line.length);
+            chunkHash = (chunkHash ^ lineHash) * 0x100000001b3ULL + count;
+            count++;
+            if ( lineHash >> (64 - CHUNK_BITS) == 0 )
+                break;          /* a line that ends a chunk */
+        }
+
+        *hash = chunkHash;
+        *nbrLines = count;
+        end = source->next != NULL ? source->next - source->data : 0;
+        return end < source->size ? end : source->size;
+}
+
+const CacheChunk * cacheFindChunk (SymbolCache * cache, uint64_t hash,
+                                   size_t size)
+  /* Returns the chunk with the given hash and size in the cache read
+   *      in, or NULL if there is none.
+   */
+{
+        unsigned mask;
+        unsigned slot;
+        int      chunk;
+
+        if ( cache->indexSize == 0 )
+            return NULL;
+
+        /* linear probing; the index is never full, so this terminates */
+        mask = cache->indexSize - 1;
+        for ( slot = hash & mask; ; slot = (slot + 1) & mask )
+        {
+            if ( (chunk = cache->index[slot]) < 0 )
+                return NULL;
+            if ( cache->chunks[chunk].hash == hash &&
+                 cache->chunks[chunk].size == size )
+                return &cache->chunks[chunk];
+        }
+}
+
+int cacheAddChunk (SymbolCache * cache, const CacheChunk * chunk)
+  /* Postcondition: a copy of chunk is the next chunk of the cache being
+   *      built.
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      memory allocation error.
+   */
+{
+        CacheChunk * chunks;
+        int          capacity;
+
+        if ( cache->nbrNewChunks >= cache->chunkCapacity )
+        {
+            capacity = cache->chunkCapacity > 0 ? 2 * cache->chunkCapacity
+                                                : 256;
+            chunks = realloc (cache->newChunks, capacity * sizeof(CacheChunk));
+            if ( chunks == NULL )
+            {
+                printError ("%s", ERROR1);
+                return 0;
+            }
+            cache->newChunks = chunks;
+            cache->chunkCapacity = capacity;
+        }
+
+        cache->newChunks[cache->nbrNewChunks++] = *chunk;
+        return 1;
+}
+
+int cacheAddLabel (SymbolCache * cache, const char * name, int length,
+                   int PC)
+  /* Postcondition: the label made up of the first length characters of
+   *      name, at the address PC from the start of its chunk, is the
+   *      next label of the cache being built.
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      memory allocation error.
+   */
+{
+        CacheLabel * labels;
+        int          capacity;
+
+        if ( cache->nbrNewLabels >= cache->labelCapacity )
+        {
+            capacity = cache->labelCapacity > 0 ? 2 * cache->labelCapacity
+                                                : 256;
+            labels = realloc (cache->newLabels, capacity * sizeof(CacheLabel));
+            if ( labels == NULL )
+            {
+                printError ("%s", ERROR1);
+                return 0;
+            }
+            cache->newLabels = labels;
+            cache->labelCapacity = capacity;
+        }
+
+        cache->newLabels[cache->nbrNewLabels].name = cache->namesLength;
+        cache->newLabels[cache->nbrNewLabels].length = length;
+        cache->newLabels[cache->nbrNewLabels].PC = PC;
+        if ( ! addName (cache, name, length) )
+            return 0;
+        cache->nbrNewLabels++;
+        return 1;
+}
+
+int cacheTarget (SymbolCache * cache, LabelTable * table, int target)
+  /* Returns the position in table of the entry for the label the given
+   *      target record of the cache read in names; -1 if memory
+   *      allocation error.
+   */
+{
+        const CacheLabel * name = &cache->targets[target];
+
+        /* Each target is only looked up once. */
+        if ( cache->targetEntries[target] < 0 )
+            cache->targetEntries[target] =
+                referenceLabelLen (table, cache->names + name->name,
+                                   name->length);
+        return cache->targetEntries[target];
+}
+
+int cacheAddProgram (SymbolCache * cache, const IRProgram * program,
+                     LabelTable * table, const uint32_t * words)
+  /* Postcondition: the instructions of program (whose labels are in
+   *      table) and their words are part of the cache being built, with
+   *      a target record for each label they refer to.
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      memory allocation error.
+   */
+{
+        CacheLabel * targets;
+        LabelEntry * entry;
+        int          capacity;
+        int          symbol;
+        size_t       size = (table->nbrLabels + 1) * sizeof(int);
+
+        free (cache->targetOf);
+        if ( (cache->targetOf = malloc (size)) == NULL )
+        {
+            printError ("%s", ERROR1);
+            return 0;
+        }
+        (void) memset (cache->targetOf, -1, size);
+        cache->nbrNewTargets = 0;
+
+        /* One target record for each label that is branched or jumped to,
+         * in the order they are first referred to.
+         */
+        for ( int i = 0; i < program->nbrInstrs; i++ )
+        {
+            if ( (symbol = program->instrs[i].symbol) < 0 ||
+                 cache->targetOf[symbol] >= 0 )
+                continue;
+            if ( cache->nbrNewTargets >= cache->targetCapacity )
+            {
+                capacity = cache->targetCapacity > 0
+                           ? 2 * cache->targetCapacity : 256;
+                targets = realloc (cache->newTargets,
+                                   capacity * sizeof(CacheLabel));
+                if ( targets == NULL )
+                {
+                    printError ("%s", ERROR1);
+                    return 0;
+                }
+                cache->newTargets = targets;
+                cache->targetCapacity = capacity;
+            }
+            entry = tableEntry (table, symbol);
+            cache->newTargets[cache->nbrNewTargets].name = cache->namesLength;
+            cache->newTargets[cache->nbrNewTargets].length = entry->length;
+            cache->newTargets[cache->nbrNewTargets].PC = entry->address;
+            if ( ! addName (cache, entry->label, entry->length) )
+                return 0;
+            cache->targetOf[symbol] = cache->nbrNewTargets++;
+        }
+
+        cache->program = program;
+        cache->programWords = words;
+        cache->table = table;
+        return 1;
+}
+
+int cacheSave (SymbolCache * cache, const char * filename)
+  /* Postcondition: the cache being built has been written to the named
+   *      file, which is replaced as a whole (or not at all).
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      the file could not be written.
+   */
+{
+        CacheHeader header;
+        size_t      length = strlen (filename);
+        char *      temporary;
+        FILE *      fp;
+        int         ok;
+
+        memset (&header, 0, sizeof header);
+        memcpy (header.magic, MAGIC, sizeof MAGIC);
+        header.version = VERSION;
+        header.byteOrder = ORDER_MARK;
+        header.nbrChunks = cache->nbrNewChunks;
+        header.nbrLabels = cache->nbrNewLabels;
+        header.nbrTargets = cache->nbrNewTargets;
+        header.nbrInstrs = cache->program->nbrInstrs;
+        header.namesSize = cache->namesLength;
+
+        /* Write a new file next to the old one, then put it in its place,
+         * so that a run that is cut short leaves the old cache alone.
+         */
+        if ( (temporary = malloc (length + 5)) == NULL )
+        {
+            printError ("%s", ERROR1);
+            return 0;
+        }
+        sprintf (temporary, "%s.tmp", filename);
+        ok = (fp = fopen (temporary, "wb")) != NULL;
+        if ( ok )
+        {
+            ok = fwrite (&header, sizeof header, 1, fp) == 1 &&
+                 fwrite (cache->newChunks, sizeof(CacheChunk),
+                         cache->nbrNewChunks, fp) ==
+                    (size_t) cache->nbrNewChunks &&
+                 fwrite (cache->newLabels, sizeof(CacheLabel),
+                         cache->nbrNewLabels, fp) ==
+                    (size_t) cache->nbrNewLabels &&
+                 fwrite (cache->newTargets, sizeof(CacheLabel),
+                         cache->nbrNewTargets, fp) ==
+                    (size_t) cache->nbrNewTargets &&
+                 writeInstrs (cache, fp) &&
+                 fwrite (cache->programWords, sizeof(uint32_t),
+                         header.nbrInstrs, fp) == header.nbrInstrs &&
+                 fwrite (cache->newNames, 1, cache->namesLength, fp) ==
+                    cache->namesLength;
+            ok = fclose (fp) == 0 && ok;
+            ok = ok && rename (temporary, filename) == 0;
+            if ( ! ok )
+                (void) remove (temporary);
+        }
+        if ( ! ok )
+            printError (ERROR0, filename);
+
+        free (temporary);
+        cache->saved = ok;
+        return ok;
+}
+
+int cacheSetImage (const char * filename, const CacheImage * image)
+  /* Postcondition: the cache in the named file (if there is one)
+   *      records that the output file described by image (or, if image
+   *      is NULL, no file) holds its words.
+   * Returns 1 if everything went OK; 0 (after printing an error) if
+   *      the file could not be written.
+   */
+{
+        CacheHeader header;
+        CacheImage  none;
+        FILE *      fp;
+        int         ok = 1;
+
+        if ( image == NULL )
+        {
+            memset (&none, 0, sizeof none);
+            image = &none;
+        }
+
+        /* Only the image in the header is rewritten, in place. */
+        if ( (fp = fopen (filename, "r+b")) == NULL )
+            return 1;               /* no cache: nothing to record */
+        if ( fread (&header, sizeof header, 1, fp) == 1 &&
+             memcmp (header.magic, MAGIC, sizeof MAGIC) == 0 &&
+             header.version == VERSION && header.byteOrder == ORDER_MARK )
+            ok = fseek (fp, offsetof (CacheHeader, image), SEEK_SET) == 0 &&
+                 fwrite (image, sizeof *image, 1, fp) == 1;
+        ok = fclose (fp) == 0 && ok;
+        if ( ! ok )
+            printError (ERROR0, filename);
+        return ok;
+}
+
+void cacheFree (SymbolCache * cache)
+  /* Postcondition: the cache read in has been unmapped and the memory
+   *      used by the cache being built released; cache is empty again.
+   */
+{
+#if ! defined(_WIN32)
+        if ( cache->mapped )
+            (void) munmap (cache->file, cache->fileSize);
+        else
+#endif
+            free (cache->file);
+        free (cache->index);
+        free (cache->targetEntries);
+        free (cache->newChunks);
+        free (cache->newLabels);
+        free (cache->newNames);
+        free (cache->newTargets);
+        free (cache->targetOf);
+        cacheInit (cache);
+}
+
+static uint64_t hashLine(const char * line, int length)
+ /* Returns a 64-bit hash of the first length characters of line, taken
+  * 8 of them at a time, whose top bits are as good as any others.
+  */
+{
+        uint64_t hash = 0x9e3779b97f4a7c15ULL ^ length;
+        uint64_t word;
+        int      i;
+
+        for ( i = 0; i + 8 <= length; i += 8 )
+        {
+            (void) memcpy (&word, line + i, 8);
+            hash = (hash ^ word) * 0xff51afd7ed558ccdULL;
+            hash ^= hash >> 32;
+        }
+        if ( i < length )
+        {
+            word = 0;
+            (void) memcpy (&word, line + i, length - i);
+            hash = (hash ^ word) * 0xff51afd7ed558ccdULL;
+        }
+
+        /* mix the last word into every bit */
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+}
+
+static int readCacheFile(SymbolCache * cache, const char * filename)
+ /* Maps the named file in (or, where it cannot be mapped, reads it into
+  * memory) as cache->file.  Returns 1 if everything went OK; 0 (without
+  * printing anything) otherwise.
+  */
+{
+        FILE * fp;
+        long   size;
+
+#if ! defined(_WIN32)
+        struct stat info;
+        int         fd;
+        void *      data;
+
+        if ( (fd = open (filename, O_RDONLY)) < 0 )
+            return 0;
+        if ( fstat (fd, &info) == 0 && S_ISREG (info.st_mode) &&
+             info.st_size > 0 )
+        {
+            data = mmap (NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if ( data != MAP_FAILED )
+            {
+                (void) close (fd);
+                cache->file = data;
+                cache->fileSize = info.st_size;
+                cache->mapped = 1;
+                return 1;
+            }
+        }
+        (void) close (fd);
+#endif
+
+        if ( (fp = fopen (filename, "rb")) == NULL )
+            return 0;
+        if ( fseek (fp, 0, SEEK_END) == 0 && (size = ftell (fp)) > 0 &&
+             fseek (fp, 0, SEEK_SET) == 0 &&
+             (cache->file = malloc (size)) != NULL )
+        {
+            if ( fread (cache->file, 1, size, fp) == (size_t) size )
+                cache->fileSize = size;
+            else
+            {
+                free (cache->file);
+                cache->file = NULL;
+            }
+        }
+        (void) fclose (fp);
+        return cache->file != NULL;
+}
+
+static int recordsFit(const SymbolCache * cache, uint32_t nbrLabels,
+                      uint64_t namesSize)
+ /* Returns 1 if every chunk's labels are among the nbrLabels label
+  * records and its instructions among the instruction records, every
+  * label's and target's name among the namesSize bytes of names, and
+  * every instruction's opcode and target exist, in the cache read in;
+  * 0 if not (so the file is damaged).
+  */
+{
+        for ( int i = 0; i < cache->nbrChunks; i++ )
+            if ( (uint64_t) cache->chunks[i].firstLabel +
+                   cache->chunks[i].nbrLabels > nbrLabels ||
+                 (uint64_t) cache->chunks[i].firstInstr +
+                   cache->chunks[i].nbrInstrs > (uint64_t) cache->nbrInstrs )
+                return 0;
+        for ( uint32_t i = 0; i < nbrLabels; i++ )
+            if ( (uint64_t) cache->labels[i].name +
+                 cache->labels[i].length > namesSize )
+                return 0;
+        for ( int i = 0; i < cache->nbrTargets; i++ )
+            if ( (uint64_t) cache->targets[i].name +
+                 cache->targets[i].length > namesSize )
+                return 0;
+        for ( int i = 0; i < cache->nbrInstrs; i++ )
+            if ( cache->instrs[i].id >= NBR_OPCODES ||
+                 cache->instrs[i].symbol < -1 ||
+                 cache->instrs[i].symbol >= cache->nbrTargets )
+                return 0;
+        return 1;
+}
+
+static int buildIndex(SymbolCache * cache)
+ /* Postcondition: the hash index has at least twice as many slots as
+  *      there are chunks (rounded up to a power of 2) and holds every
+  *      chunk of the cache read in.
+  * Returns 1 if everything went OK; 0 if memory allocation error.
+  */
+{
+        int      size = 1;
+        unsigned mask;
+        unsigned slot;
+
+        while ( size < 2 * cache->nbrChunks )
+            size *= 2;
+        if ( (cache->index = malloc (size * sizeof(int))) == NULL ||
+             (cache->targetEntries = malloc ((cache->nbrTargets + 1) *
+                                             sizeof(int))) == NULL )
+            return 0;
+        cache->indexSize = size;
+        (void) memset (cache->targetEntries, -1,
+                       (cache->nbrTargets + 1) * sizeof(int));
+
+        (void) memset (cache->index, -1, size * sizeof(int));
+        mask = size - 1;
+        for ( int i = 0; i < cache->nbrChunks; i++ )
+        {
+            slot = cache->chunks[i].hash & mask;
+            while ( cache->index[slot] >= 0 )
+                slot = (slot + 1) & mask;
+            cache->index[slot] = i;
+        }
+
+        return 1;
+}
+
+static int addName(SymbolCache * cache, const char * name, int length)
+ /* Adds the first length characters of name to the names of the cache
+  * being built.  Returns 1 if everything went OK; 0 (after printing an
+  * error) if memory allocation error.
+  */
+{
+        char * names;
+        size_t size;
+
+        if ( cache->namesLength + length > cache->namesSize )
+        {
+            size = cache->namesSize > 0 ? 2 * cache->namesSize : 4096;
+            while ( size < cache->namesLength + length )
+                size *= 2;
+            if ( (names = realloc (cache->newNames, size)) == NULL )
+            {
+                printError ("%s", ERROR1);
+                return 0;
+            }
+            cache->newNames = names;
+            cache->namesSize = size;
+        }
+
+        (void) memcpy (cache->newNames + cache->namesLength, name, length);
+        cache->namesLength += length;
+        return 1;
+}
+
+static int writeInstrs(const SymbolCache * cache, FILE * fp)
+ /* Writes the instructions of the program being saved to fp, a batch at
+  * a time, with their targets replaced by target records and their line
+  * numbers counted from the start of their chunks.  Returns 1 if
+  * everything went OK; 0 otherwise.
+  */
+{
+        IRInstr batch[SAVE_BATCH];
+        int     nbrInBatch = 0;
+        int     firstLine = 1;
+        int     i = 0;
+
+        for ( int c = 0; c < cache->nbrNewChunks; c++ )
+        {
+            const CacheChunk * chunk = &cache->newChunks[c];
+
+            for ( uint32_t j = 0; j < chunk->nbrInstrs; j++, i++ )
+            {
+                batch[nbrInBatch] = cache->program->instrs[i];
+                if ( batch[nbrInBatch].symbol >= 0 )
+                    batch[nbrInBatch].symbol =
+                        cache->targetOf[batch[nbrInBatch].symbol];
+                batch[nbrInBatch].line -= firstLine - 1;
+                if ( ++nbrInBatch == SAVE_BATCH )
+                {
+                    if ( fwrite (batch, sizeof(IRInstr), nbrInBatch, fp)
+                         != (size_t) nbrInBatch )
+                        return 0;
+                    nbrInBatch = 0;
+                }
+            }
+            firstLine += chunk->nbrLines;
+        }
+
+        return i == cache->program->nbrInstrs &&
+               fwrite (batch, sizeof(IRInstr), nbrInBatch, fp)
+                 == (size_t) nbrInBatch;
+}
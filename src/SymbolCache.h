@@ -0,0 +1,253 @@
+/*
+ * Symbol Cache: data structure and associated functions
+ *
+ * This file provides the data structure and declarations for the
+ * functions that keep the label table of a program in a file between
+ * runs of the assembler, so that a large program can be assembled
+ * again after a small edit without finding all of its labels again.
+ *
+ * The source is cut into chunks of whole lines.  Where a chunk ends
+ * depends only on the lines themselves: a chunk ends after a line whose
+ * hash has its top CHUNK_BITS bits clear (about one line in 64), or
+ * after MAX_CHUNK_LINES lines.  So an edit only changes the chunk (or,
+ * now and then, the two chunks) it is in, and every other chunk is cut
+ * the same way, and hashes the same, as before.  For each chunk the
+ * cache keeps a hash of its lines, its size in bytes, how many lines
+ * and instructions it has, and its labels, with their addresses
+ * relative to the start of the chunk.  The cache also keeps the rest of
+ * the last run: the parsed instructions of every chunk (see IR.h), with
+ * the branch and jump targets by name and old address, and the machine
+ * code they were encoded into.
+ *
+ * The cache file is a header followed by the chunk records, the label
+ * records, the target records, the instruction records, the words of
+ * machine code, and the names of the labels and targets, all in the
+ * byte order and layout of the machine that wrote it.  It is
+ * memory-mapped as it is when it is read back in; nothing in it is
+ * parsed, and only an open-addressing hash index over the chunk hashes
+ * (like the label table's) is made from it.  See pass1Cached in
+ * pass1.c for how the chunks are used: the labels of a chunk that is in
+ * the cache are added to the label table straight from the mapping, at
+ * their address in the chunk plus the address the chunk starts at now,
+ * and its instructions are copied from the cache without being parsed.
+ * Only the chunks that are not in the cache are looked at at all.
+ * pass2Cached (in pass2.c) then only encodes the instructions of those
+ * chunks, and of the others only the branches and jumps that, or whose
+ * targets, have moved; the rest of the words are copied.  If the
+ * output file is still the one the last run wrote (see CacheImage),
+ * only the words that changed are written to it (see
+ * outputSetPrevious).
+ *
+ * EXAMPLE:
+ *      SymbolCache cache;
+ *      cacheInit (&cache);
+ *      (void) cacheLoad (&cache, "prog.sym");     // 0: no cache yet
+ *      ... pass1Cached (&source, &table, &program, &cache) ...
+ *      ... pass2Cached (&program, &table, &out, &cache) ...
+ *      if ( no errors && cacheAddProgram (&cache, &program, &table,
+ *                                         out.words) )
+ *          (void) cacheSave (&cache, "prog.sym");
+ *      ... write out the words to the output file ...
+ *      (void) cacheSetImage ("prog.sym", cache.saved ? &image : NULL);
+ *      cacheFree (&cache);
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Added the instructions, targets, words,
+ *                           and output image (version 2 of the file).
+ *
+ */
+
+#ifndef _SYMBOL_CACHE_H
+#define _SYMBOL_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "SourceFile.h"
+#include "LabelTable.h"
+#include "IR.h"
+
+/* A chunk ends after a line whose hash has this many top bits clear... */
+#define CHUNK_BITS 6
+/* ...or after this many lines. */
+#define MAX_CHUNK_LINES 4096
+
+/* THE DATA STRUCTURES */
+
+/* The first three type definitions are records in the cache file: one
+ * for each chunk, in the order of the source, and one for each label,
+ * in the order of the chunks (and of the lines in each chunk), and the
+ * description of the output file the last run wrote.  The label records
+ * also serve for the targets, with the (absolute) address each target
+ * had.  The instructions are IRInstr records, one for each word of
+ * machine code, whose symbol is the position of a target record (or
+ * -1) and whose line is counted from the start of the chunk (the first
+ * line is 1).  The last type definition defines the type for the cache
+ * as a whole: the cache read in from a file (if any) and the cache
+ * being built for the program that is being assembled, to be saved in
+ * its place.
+ */
+
+typedef struct {
+        uint64_t hash;          /* hash of the lines of the chunk */
+        uint32_t size;          /* nbr of bytes in the chunk */
+        uint32_t nbrLines;      /* nbr of lines in the chunk */
+        uint32_t nbrInstrs;     /* nbr of instructions in the chunk */
+        uint32_t firstLabel;    /* position of its first label record */
+        uint32_t nbrLabels;     /* nbr of labels defined in the chunk */
+        uint32_t firstInstr;    /* position of its first instruction */
+} CacheChunk;
+
+typedef struct {
+        uint32_t name;          /* offset of the name in the names */
+        uint32_t length;        /* nbr of characters in the name */
+        uint32_t PC;            /* address, from the start of its chunk */
+} CacheLabel;
+
+typedef struct {
+        uint64_t device;        /* the output file, as in fstat (all 0 */
+        uint64_t inode;         /*   if no file is known to hold the */
+        uint64_t size;          /*   words) */
+        uint64_t modified;      /* its modification time, in ns */
+        uint32_t mode;          /* its OutputMode */
+        uint32_t nbrWords;      /* nbr of words written to it */
+} CacheImage;
+
+typedef struct {
+        /* the cache read in by cacheLoad (all NULL or 0 if none) */
+        void * file;            /* the contents of the cache file */
+        size_t fileSize;
+        int mapped;             /* 1 if file is mapped; 0 if allocated */
+        const CacheChunk * chunks;
+        int nbrChunks;
+        const CacheLabel * labels;
+        int nbrLabels;
+        const CacheLabel * targets;
+        int nbrTargets;
+        const IRInstr * instrs;
+        const uint32_t * words; /* machine code, one word per instr */
+        int nbrInstrs;
+        const char * names;
+        CacheImage image;       /* where the words were written */
+        int indexSize;          /* nbr of slots in the hash index */
+        int * index;            /* hash index into chunks (-1 = empty) */
+        int * targetEntries;    /* label table entry of each target, or
+                                 * -1 if not looked up yet */
+
+        /* the cache being built, for cacheSave */
+        CacheChunk * newChunks;
+        int nbrNewChunks;
+        int chunkCapacity;
+        CacheLabel * newLabels;
+        int nbrNewLabels;
+        int labelCapacity;
+        char * newNames;
+        size_t namesLength;
+        size_t namesSize;
+        CacheLabel * newTargets;
+        int nbrNewTargets;
+        int targetCapacity;
+        const IRProgram * program;  /* the instructions to save */
+        const uint32_t * programWords;  /* and their machine code */
+        LabelTable * table;     /* the labels of program */
+        int * targetOf;         /* target of each entry in table, or -1 */
+        int nbrReused;          /* nbr of chunks found in the cache */
+        int saved;              /* 1 once cacheSave has saved it */
+} SymbolCache;
+
+
+/* THE FUNCTIONS */
+
+void cacheInit (SymbolCache * cache);
+        /* Postcondition: cache is empty: nothing has been read in, and
+         *      nothing built.
+         */
+
+int cacheLoad (SymbolCache * cache, const char * filename);
+        /* Postcondition: if the named file holds a cache (written by
+         *      cacheSave on a machine like this one), it is mapped in as
+         *      the cache read in; if not, there is none.  Nothing is
+         *      printed either way: a missing or unusable cache file just
+         *      means that every chunk has to be looked at.
+         * Returns 1 if a cache was read in; 0 if not.
+         */
+
+size_t cacheNextChunk (SourceFile * source, uint64_t * hash,
+                       int * nbrLines);
+        /* Precondition: source is positioned at the start of a chunk
+         *      (its first line, to begin with).
+         * Postcondition: source is positioned after the last line of
+         *      the chunk, *hash is the hash of the chunk, and *nbrLines
+         *      the number of lines in it.
+         * Returns the offset in the source of the end of the chunk.
+         */
+
+const CacheChunk * cacheFindChunk (SymbolCache * cache, uint64_t hash,
+                                   size_t size);
+        /* Returns the chunk with the given hash and size in the cache
+         *      read in, or NULL if there is none.
+         */
+
+int cacheAddChunk (SymbolCache * cache, const CacheChunk * chunk);
+        /* Postcondition: a copy of chunk, whose labels are the ones
+         *      added since the last chunk, is the next chunk of the cache
+         *      being built.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if memory allocation error.
+         */
+
+int cacheAddLabel (SymbolCache * cache, const char * name, int length,
+                   int PC);
+        /* Postcondition: the label made up of the first length
+         *      characters of name, at the address PC from the start of
+         *      its chunk, is the next label of the cache being built.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if memory allocation error.
+         */
+
+int cacheTarget (SymbolCache * cache, LabelTable * table, int target);
+        /* Precondition: target is the position of a target record in
+         *      the cache read in.
+         * Returns the position in the table of the entry for the label
+         *      the target names (added, undefined, if it was not there;
+         *      see referenceLabelLen); -1 if memory allocation error.
+         */
+
+int cacheAddProgram (SymbolCache * cache, const IRProgram * program,
+                     LabelTable * table, const uint32_t * words);
+        /* Precondition: program is the program the chunks of the cache
+         *      being built were made from, without errors, its labels
+         *      are in table, and words is its machine code (one word
+         *      for each instruction).
+         * Postcondition: the instructions and words are part of the
+         *      cache being built (program, table, and words must stay
+         *      as they are until it has been saved).
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if memory allocation error.
+         */
+
+int cacheSave (SymbolCache * cache, const char * filename);
+        /* Precondition: cacheAddProgram has been called on the cache
+         *      being built.
+         * Postcondition: the cache being built has been written to the
+         *      named file, which is replaced as a whole (or not at all),
+         *      without an output file that holds its words.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if the file could not be written.
+         */
+
+int cacheSetImage (const char * filename, const CacheImage * image);
+        /* Postcondition: the cache in the named file (if there is one)
+         *      records that the output file described by image holds its
+         *      words, or, if image is NULL, that no file is known to.
+         * Returns 1 if everything went OK; 0 (after printing an error)
+         *      if the file could not be written.
+         */
+
+void cacheFree (SymbolCache * cache);
+        /* Postcondition: the cache read in has been unmapped and the
+         *      memory used by the cache being built released; cache is
+         *      empty again.
+         */
+
+#endif
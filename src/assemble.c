@@ -0,0 +1,502 @@
+/*
+ * This file contains the parseOperands function, which parses the
+ * operands of one instruction into an intermediate representation
+ * record (see IR.h), and the encodeInstr function, which encodes such a
+ * record into a 32-bit machine instruction and adds it to the output
+ * (encodeInstrs encodes a whole run of records).  parseOperands takes
+ * the opcode id found by getOpType, the operand tokens that followed the
+ * mnemonic, the line number (for error messages), and the label table,
+ * in which it looks up (or adds, if they are not defined yet) the
+ * labels that branches and jumps refer to.
+ *
+ * encodeInstr needs the addresses of those labels.  When the label
+ * table is complete (pass2), a label that is still undefined is an
+ * error.  When assembling in a single pass, a target that is not
+ * defined yet is instead encoded as zero and recorded in a list of
+ * fixups, to be patched once the whole program has been read (see
+ * Fixups.h).
+ *
+ * Every instruction takes up one word of the output, in either case,
+ * so that word i is always the instruction at address 4 * i: one that
+ * could not be parsed (IR_INVALID) is output as PLACEHOLDER_WORD, and
+ * one whose target is undefined or too far away with a target that
+ * encodes as zero, as an unpatched forward reference is.
+ *
+ * The operand order depends on the instruction's form (see
+ * INSTRUCTION_FORMS in Instructions.h), e.g.:
+ *      add  $rd, $rs, $rt          sll  $rd, $rt, shamt
+ *      jr   $rs                    mult $rs, $rt
+ *      addi $rt, $rs, imm          lw   $rt, imm($rs)
+ *      beq  $rs, $rt, label        j    label
+ * Each form has a parser of its own, in which the operand order and the
+ * range of any immediate value are fixed, and an encoder of its own,
+ * which packs the fields the way its type does.  Both are generated from
+ * the table, and found by opcode id, in the PARSE and ENCODE jump
+ * tables, so nothing is decided by a switch on the type or the opcode.
+ * The fixed bits of each word (the opcode, or the funct number) are
+ * worked out at compile time as well, in OP_BITS.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Parse and encode by form, through tables.
+ *   Modified:  10/14/2026   Output a word for every instruction, even
+ *                           one that could not be parsed or encoded.
+ *
+ */
+
+#include "assembler.h"
+#include "Instructions.h"
+
+static const int INSTRUCTION_SIZE = 4;		/* in bytes */
+
+/* The type of each instruction, indexed by opcode id. */
+#define INSTR(name, form, code, ...)  FORM_TYPE_##form,
+static const char OP_TYPE[NBR_OPCODES] = { MIPS_INSTRUCTIONS };
+#undef INSTR
+
+/* The fixed bits of each instruction's word, indexed by opcode id: the
+ * opcode in the top 6 bits, or for R type, the funct number in the
+ * bottom 6 (the opcode being 0).
+ */
+#define INSTR(name, form, code, ...) \
+        FORM_TYPE_##form == 'R' ? (uint32_t) (code) : (uint32_t) (code) << 26,
+static const uint32_t OP_BITS[NBR_OPCODES] = { MIPS_INSTRUCTIONS };
+#undef INSTR
+
+// internal functions (visible to this file only)
+static int checkOperands (int nbrOperands, int expected, int line);
+static int reg (TokenSpan operand, int line, uint8_t * regNbr);
+static int immediate (TokenSpan operand, long min, long max, int line,
+                      int32_t * value);
+static int symbol (LabelTable * table, TokenSpan operand, int32_t * entry);
+static int encode (const IRInstr * instr, int PC, LabelTable * table,
+                   FixupList * fixups, OutputSink * out, int report);
+static int labelAddress (const IRInstr * instr, int PC, LabelTable * table,
+                         FixupList * fixups, OutputSink * out, int report);
+static int zeroTarget (const IRInstr * instr, int PC);
+static int encodeR (const IRInstr * instr, int PC, int target,
+                    uint32_t * word);
+static int encodeImmediate (const IRInstr * instr, int PC, int target,
+                            uint32_t * word);
+static int encodeBranch (const IRInstr * instr, int PC, int target,
+                         uint32_t * word);
+static int encodeJump (const IRInstr * instr, int PC, int target,
+                       uint32_t * word);
+
+/* A parser for each form (parse_RD_RS_RT, ...), for the operands that
+ * followed the mnemonic; each one returns 1 if they are valid, or 0
+ * (after printing an error) otherwise.
+ */
+#define PARSER(form)  static int parse_##form (TokenSpan operands[], \
+                                               int nbrOperands, int line, \
+                                               LabelTable * table, \
+                                               IRInstr * instr)
+#define FORM(form, type, encoder)  PARSER(form);
+INSTRUCTION_FORMS
+#undef FORM
+
+/* An encoder for each form (encode_RD_RS_RT, ...): each one calls the
+ * encoder for the form's type, which the compiler can put in its place.
+ * It sets *word to the instruction at address PC, with the label it
+ * refers to (if any) at address target, and returns 1; or returns 0 if
+ * the target is too far away.
+ */
+#define FORM(form, type, encoder) \
+        static int encode_##form (const IRInstr * instr, int PC, int target, \
+                                  uint32_t * word) \
+        { \
+            return encoder (instr, PC, target, word); \
+        }
+INSTRUCTION_FORMS
+#undef FORM
+
+/* The parser and encoder of each instruction, indexed by opcode id. */
+typedef int (* Parser) (TokenSpan operands[], int nbrOperands, int line,
+                        LabelTable * table, IRInstr * instr);
+typedef int (* Encoder) (const IRInstr * instr, int PC, int target,
+                         uint32_t * word);
+
+#define INSTR(name, form, code, ...)  parse_##form,
+static const Parser PARSE[NBR_OPCODES] = { MIPS_INSTRUCTIONS };
+#undef INSTR
+
+#define INSTR(name, form, code, ...)  encode_##form,
+static const Encoder ENCODE[NBR_OPCODES] = { MIPS_INSTRUCTIONS };
+#undef INSTR
+
+/**
+ * parseOperands -- parse the operands of an instruction
+ * Parameters:  id -- the opcode id of the instruction (see getOpType)
+ *              operands -- the tokens that followed the mnemonic
+ *              nbrOperands -- the number of tokens in operands
+ *              line -- the line number, for error messages
+ *              table -- the label table, to refer to labels in
+ *              instr -- the record the operands go in
+ * Postcondition: instr holds the registers, the immediate value or shift
+ *      amount (if any), and, for a branch or jump, the label table entry
+ *      of the target.
+ * Returns 1 if the operands are valid; 0 (after printing an error)
+ *      otherwise.
+ */
+int parseOperands (int id, TokenSpan operands[], int nbrOperands, int line,
+                   LabelTable * table, IRInstr * instr)
+{
+    return PARSE[id] (operands, nbrOperands, line, table, instr);
+}
+
+/* The parsers, one for each form.  Only the ones for branches and jumps
+ * use the table.
+ */
+
+PARSER(RD_RS_RT)
+{
+    (void) table;
+    return checkOperands (nbrOperands, 3, line) &&
+           reg (operands[0], line, &instr->rd) &&
+           reg (operands[1], line, &instr->rs) &&
+           reg (operands[2], line, &instr->rt);
+}
+
+PARSER(RD_RT_SHAMT)
+{
+    (void) table;
+    return checkOperands (nbrOperands, 3, line) &&
+           reg (operands[0], line, &instr->rd) &&
+           reg (operands[1], line, &instr->rt) &&
+           immediate (operands[2], 0, 31, line, &instr->imm);
+}
+
+PARSER(RD_RT_RS)
+{
+    (void) table;
+    return checkOperands (nbrOperands, 3, line) &&
+           reg (operands[0], line, &instr->rd) &&
+           reg (operands[1], line, &instr->rt) &&
+           reg (operands[2], line, &instr->rs);
+}
+
+PARSER(RS)
+{
+    (void) table;
+    return checkOperands (nbrOperands, 1, line) &&
+           reg (operands[0], line, &instr->rs);
+}
+
+PARSER(RD_OPT_RS)
+{
+    (void) table;
+    if ( nbrOperands == 1 )             /* rd is $ra */
+    {
+        instr->rd = 31;
+        return reg (operands[0], line, &instr->rs);
+    }
+    return checkOperands (nbrOperands, 2, line) &&
+           reg (operands[0], line, &instr->rd) &&
+           reg (operands[1], line, &instr->rs);
+}
+
+PARSER(RD)
+{
+    (void) table;
+    return checkOperands (nbrOperands, 1, line) &&
+           reg (operands[0], line, &instr->rd);
+}
+
+PARSER(RS_RT)
+{
+    (void) table;
+    return checkOperands (nbrOperands, 2, line) &&
+           reg (operands[0], line, &instr->rs) &&
+           reg (operands[1], line, &instr->rt);
+}
+
+PARSER(NONE)
+{
+    (void) operands;
+    (void) table;
+    (void) instr;
+    return checkOperands (nbrOperands, 0, line);
+}
+
+PARSER(RS_RT_LABEL)
+{
+    return checkOperands (nbrOperands, 3, line) &&
+           reg (operands[0], line, &instr->rs) &&
+           reg (operands[1], line, &instr->rt) &&
+           symbol (table, operands[2], &instr->symbol);
+}
+
+PARSER(RS_LABEL)
+{
+    return checkOperands (nbrOperands, 2, line) &&
+           reg (operands[0], line, &instr->rs) &&
+           symbol (table, operands[1], &instr->symbol);
+}
+
+PARSER(RT_RS_IMM)
+{
+    (void) table;
+    return checkOperands (nbrOperands, 3, line) &&
+           reg (operands[0], line, &instr->rt) &&
+           reg (operands[1], line, &instr->rs) &&
+           immediate (operands[2], -32768, 32767, line, &instr->imm);
+}
+
+PARSER(RT_RS_UIMM)
+{
+    (void) table;
+    return checkOperands (nbrOperands, 3, line) &&
+           reg (operands[0], line, &instr->rt) &&
+           reg (operands[1], line, &instr->rs) &&
+           immediate (operands[2], 0, 65535, line, &instr->imm);
+}
+
+PARSER(RT_UPPER)
+{
+    (void) table;
+    return checkOperands (nbrOperands, 2, line) &&
+           reg (operands[0], line, &instr->rt) &&
+           immediate (operands[1], -32768, 65535, line, &instr->imm);
+}
+
+PARSER(RT_MEM)
+{
+    (void) table;
+    if ( nbrOperands == 2 )             /* rt, ($rs) */
+        return reg (operands[0], line, &instr->rt) &&
+               reg (operands[1], line, &instr->rs);
+    return checkOperands (nbrOperands, 3, line) &&
+           reg (operands[0], line, &instr->rt) &&
+           immediate (operands[1], -32768, 32767, line, &instr->imm) &&
+           reg (operands[2], line, &instr->rs);
+}
+
+PARSER(LABEL)
+{
+    return checkOperands (nbrOperands, 1, line) &&
+           symbol (table, operands[0], &instr->symbol);
+}
+
+#undef PARSER
+
+/**
+ * encodeInstr -- encode a parsed instruction at address PC
+ * (fixups is NULL unless assembling in a single pass)
+ * Postcondition: the instruction, or a placeholder for it (see above),
+ *      has been added to out.
+ * Returns 1 if the instruction was encoded; 0 (after printing an error,
+ *      unless it was IR_INVALID, whose error was printed already)
+ *      otherwise.
+ */
+int encodeInstr (const IRInstr * instr, int PC, LabelTable * table,
+                 FixupList * fixups, OutputSink * out)
+{
+    if ( instr->id == IR_INVALID )
+    {
+        outputWord (out, PLACEHOLDER_WORD);
+        return 0;
+    }
+    return encode (instr, PC, table, fixups, out, 1);
+}
+
+/**
+ * encodeInstrs -- encode n parsed instructions, the first at address
+ *      firstPC, with a complete label table
+ * Postcondition: the instructions, or placeholders for those that are
+ *      IR_INVALID or could not be encoded (see above), have been added
+ *      to out, in order.  If report is 0, nothing is printed (and
+ *      nothing is changed, so encodeInstrs is safe to call from several
+ *      threads at once, each with its own out) and encoding stops after
+ *      the first instruction that cannot be encoded; otherwise each
+ *      of those is reported as an error, until the errors reach their
+ *      limit (see errorLimitReached).
+ * Returns the number of valid instructions that could not be encoded.
+ */
+int encodeInstrs (const IRInstr instrs[], int n, int firstPC,
+                  LabelTable * table, OutputSink * out, int report)
+{
+    int nbrErrors = 0;
+
+    for ( int i = 0; i < n; i++ )
+        if ( instrs[i].id == IR_INVALID )
+            outputWord (out, PLACEHOLDER_WORD);
+        else if ( ! encode (&instrs[i], firstPC + i * INSTRUCTION_SIZE,
+                            table, NULL, out, report) )
+        {
+            nbrErrors++;
+            if ( ! report || errorLimitReached () )
+                break;
+        }
+
+    return nbrErrors;
+}
+
+static int encode (const IRInstr * instr, int PC, LabelTable * table,
+                   FixupList * fixups, OutputSink * out, int report)
+ /* Encodes instr, at address PC, and adds it to out.  Returns 1 if
+  * that worked; 0 (after printing an error, if report is not 0, and
+  * adding it with a target that encodes as zero) otherwise.
+  */
+{
+    uint32_t word;
+    int      target = 0;
+    int      ok = 1;
+
+    if ( instr->symbol >= 0 &&
+         (target = labelAddress (instr, PC, table, fixups, out,
+                                 report)) < 0 )
+        ok = 0;
+    else if ( ! ENCODE[instr->id] (instr, PC, target, &word) )
+    {
+        if ( report )
+            reportError (DIAG_TOO_FAR, instr->line,
+                         tableEntry (table, instr->symbol)->label,
+                         tableEntry (table, instr->symbol)->length);
+        ok = 0;
+    }
+
+    if ( ! ok )
+        (void) ENCODE[instr->id] (instr, PC, zeroTarget (instr, PC), &word);
+    outputWord (out, word);
+    return ok;
+}
+
+static int encodeR (const IRInstr * instr, int PC, int target,
+                    uint32_t * word)
+ /* The encoder for R type: registers, shift amount, and funct number.
+  */
+{
+    (void) PC;
+    (void) target;
+    *word = OP_BITS[instr->id] | (uint32_t) instr->rs << 21 |
+            instr->rt << 16 | instr->rd << 11 | instr->imm << 6;
+    return 1;
+}
+
+static int encodeImmediate (const IRInstr * instr, int PC, int target,
+                            uint32_t * word)
+ /* The encoder for I type with a value: registers and the low 16 bits
+  * of the (already range-checked) value.
+  */
+{
+    (void) PC;
+    (void) target;
+    *word = OP_BITS[instr->id] | (uint32_t) instr->rs << 21 |
+            instr->rt << 16 | (instr->imm & 0xffff);
+    return 1;
+}
+
+static int encodeBranch (const IRInstr * instr, int PC, int target,
+                         uint32_t * word)
+ /* The encoder for I type with a label: registers and the offset of the
+  * target, in instructions, from the next instruction, which must fit
+  * in 16 bits.
+  */
+{
+    int offset = (target - (PC + INSTRUCTION_SIZE)) / INSTRUCTION_SIZE;
+
+    if ( offset < -32768 || offset > 32767 )
+        return 0;
+    *word = OP_BITS[instr->id] | (uint32_t) instr->rs << 21 |
+            instr->rt << 16 | (offset & 0xffff);
+    return 1;
+}
+
+static int encodeJump (const IRInstr * instr, int PC, int target,
+                       uint32_t * word)
+ /* The encoder for J type: the word address of the target.
+  */
+{
+    (void) PC;
+    *word = OP_BITS[instr->id] |
+            ((uint32_t) target / INSTRUCTION_SIZE & 0x3ffffff);
+    return 1;
+}
+
+static int checkOperands (int nbrOperands, int expected, int line)
+ /* Returns 1 if nbrOperands is as expected; prints an error and
+  * returns 0 otherwise.
+  */
+{
+    if ( nbrOperands != expected )
+    {
+        reportError (DIAG_WRONG_NBR_OPERANDS, line, NULL, 0);
+        return 0;
+    }
+    return 1;
+}
+
+static int reg (TokenSpan operand, int line, uint8_t * regNbr)
+ /* Sets *regNbr to the number of the register named by operand and
+  * returns 1, or returns 0 (after printing an error) if it doesn't
+  * name a register.
+  */
+{
+    int nbr = getRegNbr (operand.ptr, operand.len, line);
+
+    if ( nbr < 0 )
+        return 0;
+    *regNbr = nbr;
+    return 1;
+}
+
+static int immediate (TokenSpan operand, long min, long max, int line,
+                      int32_t * value)
+ /* Sets *value to the decimal or hexadecimal (0x...) number in operand
+  * and returns 1, or prints an error and returns 0 if operand is not a
+  * number between min and max.
+  */
+{
+    return getImmediate (operand.ptr, operand.len, min, max, line, value);
+}
+
+static int symbol (LabelTable * table, TokenSpan operand, int32_t * entry)
+ /* Sets *entry to the position in the label table of the label named
+  * by operand (adding it, undefined, if it is not in the table yet)
+  * and returns 1, or returns 0 (after printing an error) if memory
+  * allocation error.
+  */
+{
+    int position = referenceLabelLen (table, operand.ptr, operand.len);
+
+    if ( position < 0 )
+        return 0;
+    *entry = position;
+    return 1;
+}
+
+static int labelAddress (const IRInstr * instr, int PC, LabelTable * table,
+                         FixupList * fixups, OutputSink * out, int report)
+ /* Returns the address of the label instr refers to, or -1 (after
+  * printing an error, if report is not 0) if the label is undefined.
+  * With a list of fixups, a label that is not defined yet is not an
+  * error: a fixup for the word about to be output is recorded instead,
+  * and the address returned is one that encodes as zero (the next
+  * instruction, for a branch).
+  */
+{
+    LabelEntry * label = tableEntry (table, instr->symbol);
+
+    if ( label->address != UNDEFINED_ADDRESS )
+        return label->address;
+    if ( fixups == NULL )
+    {
+        if ( report )
+            reportError (DIAG_UNDEFINED_LABEL, instr->line, label->label,
+                         label->length);
+        return -1;
+    }
+
+    if ( ! addFixup (fixups, instr->symbol, out->nbrDropped + out->nbrWords,
+                     PC, instr->line, OP_TYPE[instr->id]) )
+        return -1;
+    return zeroTarget (instr, PC);
+}
+
+static int zeroTarget (const IRInstr * instr, int PC)
+ /* Returns the address that encodes as zero in instr, at address PC, if
+  * it is a branch or jump: the next instruction for a branch; 0 for a
+  * jump.
+  */
+{
+    return OP_TYPE[instr->id] == 'I' ? PC + INSTRUCTION_SIZE : 0;
+}
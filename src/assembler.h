@@ -13,14 +13,48 @@
 #include <ctype.h>
 
 #include "LabelTable.h"
-//#include "getToken.h"
+#include "SourceFile.h"
+#include "LineStream.h"
+#include "OutputSink.h"
+#include "Fixups.h"
+#include "IR.h"
+#include "Diagnostics.h"
+#include "AssemblerContext.h"
+#include "Stats.h"
+#include "SymbolCache.h"
+#include "getToken.h"
 #include "printFuncs.h"
 
 int getNTokens (char * instructionBuffer, int N, char * results[]);
-LabelTable pass1 (FILE * fp);
-void pass2 (FILE * fp, LabelTable table);
+int getOpType (const char * opcode, int length, char * opType, int * code,
+               int line);
+int getRegNbr (const char * regName, int length, int line);
+int getImmediate (const char * text, int length, long min, long max,
+                  int line, int32_t * value);
+void pass1 (SourceFile * source, LabelTable * table, IRProgram * program,
+            int nbrThreads);
+int pass2 (IRProgram * program, LabelTable table, OutputSink * out,
+           int nbrThreads);
+int onePass (SourceFile * source, LabelTable * table, FixupList * fixups,
+             OutputSink * out);
+int streamPass (LineStream * stream, LabelTable * table, FixupList * fixups,
+                OutputSink * out);
+void pass1Cached (SourceFile * source, LabelTable * table,
+                  IRProgram * program, SymbolCache * cache);
+int pass2Cached (const IRProgram * program, LabelTable * table,
+                 OutputSink * out, SymbolCache * cache);
+int parseLine (const LineView * line, int PC, LabelTable * table,
+               int defineLabel, IRInstr * instr);
+int parseLineLabel (const LineView * line, int PC, LabelTable * table,
+                    int defineLabel, IRInstr * instr, TokenSpan * label);
+int parseOperands (int id, TokenSpan operands[], int nbrOperands, int line,
+                   LabelTable * table, IRInstr * instr);
+int encodeInstr (const IRInstr * instr, int PC, LabelTable * table,
+                 FixupList * fixups, OutputSink * out);
+int encodeInstrs (const IRInstr instrs[], int n, int firstPC,
+                  LabelTable * table, OutputSink * out, int report);
 
-extern const int SAME;		/* useful for making strcmp readable */
+enum { SAME = 0 };		/* useful for making strcmp readable */
                                 /* e.g., if (strcmp (str1, str2) == SAME) */
 
 #endif
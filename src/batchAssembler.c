@@ -0,0 +1,163 @@
+/*
+ * This is the MIPS batch assembler.  It assembles many MIPS assembly
+ * language programs, each from a file of its own, in one process, and
+ * writes the machine code for each one to a file named after it, with
+ * OUTPUT_SUFFIX (".out") added: prog.mips is assembled to prog.mips.out.
+ * The programs are assembled at the same time, on a pool of worker
+ * threads that share them out among themselves (see Batch.h); each
+ * worker reuses one assembler context for every program it assembles.
+ * Each program is assembled just as the assembler program assembles it
+ * (see Assembler.c), so each output file holds what the assembler would
+ * write for the same options.
+ *
+ * USAGE:
+ *      name [ -t | -b | -l ] [ -s ] [ -j N ] [ -e N ] [ -m manifest ]
+ *              [ -p | -P ] filename...
+ * where "name" is the name of the executable, each "filename" is a
+ * program to assemble, and "-m manifest" adds the programs named in the
+ * file manifest (one name to a line; blank lines and lines that start
+ * with '#' are skipped), after the ones before it on the command line.
+ * -m may be given more than once.  The other options are the same as
+ * for the assembler program, and apply to every program:
+ *      -t, -b, -l      the output format (text by default)
+ *      -s              single-pass assembly
+ *      -e N            stop assembling a program after N errors (20 by
+ *                      default; 0 for no limit)
+ *      -p, -P          print statistics for the whole batch on the
+ *                      standard error at the end
+ * except for "-j N", which assembles N programs at a time (one to a
+ * thread; by default, as many as there are processors), each of them
+ * on one thread.
+ * The arguments may appear in any order.
+ *
+ * ERROR CONDITIONS:
+ * Errors in a program do not stop the others.  After all of them have
+ * been assembled, the errors in each program with errors are printed on
+ * the standard error, the program's name before each one, followed by
+ * the number of errors (and whether the error limit stopped it), then
+ * the number of programs and how many of them had errors.  A program
+ * that the error limit stopped gets an empty output file, and one that
+ * cannot be read none at all.  The batch assembler returns 1 if there
+ * were any errors in any of the programs.
+ *
+ * Creation Date:   10/14/2026
+ */
+
+#include <unistd.h>
+
+#include "assembler.h"
+#include "Batch.h"
+
+/* The most threads -j may ask for. */
+#define MAX_THREADS 256
+
+static int process_arguments(int argc, char * argv[], Batch * batch,
+                             int * statsFormat);
+
+int main (int argc, char * argv[])
+{
+    Batch batch;            /* the programs, and how to assemble them */
+    int   statsFormat;
+    int   nbrFailed;
+
+    /* Process command-line arguments. */
+    if ( ! process_arguments(argc, argv, &batch, &statsFormat) )
+    {
+        batchFree (&batch);
+        return 1;   /* Fatal error when processing arguments */
+    }
+
+    nbrFailed = batchRun (&batch);
+    batchReport (&batch, stderr);
+    if ( statsEnabled )
+        statsPrint (stderr, statsFormat);
+
+    batchFree (&batch);
+    return nbrFailed > 0;
+}
+
+/*
+ * The internal (static) process_arguments function parses the
+ * command-line arguments for an optional output format (-t, -b, or -l),
+ * an optional choice of single-pass assembly (-s), an optional number of
+ * threads (-j), an optional error limit (-e), an optional request for
+ * statistics (-p or -P), and the programs to assemble, named on the
+ * command line or in manifests (-m).
+ * It sets up the batch with the settings and the programs, in the order
+ * they were given, sets *statsFormat to 1 for JSON statistics (0
+ * otherwise), turning on statsEnabled if statistics were asked for, and
+ * returns 1, or returns 0 if process_arguments encounters a fatal error
+ * (including not being given any programs).
+ *
+ * Usage:
+ *      programName  [-t|-b|-l] [-s] [-j N] [-e N] [-m manifest] [-p|-P]
+ *                   filename...
+ * The arguments may be in any order.
+ */
+static int process_arguments(int argc, char * argv[], Batch * batch,
+                             int * statsFormat)
+{
+    long   nbrProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    int    nbrThreads;
+    char * end;
+
+    if ( nbrProcessors < 1 )
+        nbrProcessors = 1;
+    else if ( nbrProcessors > MAX_THREADS )
+        nbrProcessors = MAX_THREADS;
+    batchInit (batch, OUTPUT_TEXT, nbrProcessors);
+    *statsFormat = 0;
+    for ( int i = 1; i < argc; i++ )
+    {
+        if ( strcmp(argv[i], "-t") == SAME )
+            batch->mode = OUTPUT_TEXT;
+        else if ( strcmp(argv[i], "-b") == SAME )
+            batch->mode = OUTPUT_BINARY_BE;
+        else if ( strcmp(argv[i], "-l") == SAME )
+            batch->mode = OUTPUT_BINARY_LE;
+        else if ( strcmp(argv[i], "-s") == SAME )
+            batch->singlePass = 1;
+        else if ( strcmp(argv[i], "-p") == SAME ||
+                  strcmp(argv[i], "-P") == SAME )
+        {
+            statsEnabled = 1;
+            *statsFormat = argv[i][1] == 'P';
+        }
+        else if ( strcmp(argv[i], "-j") == SAME && i + 1 < argc &&
+                  (nbrThreads = strtol(argv[i + 1], &end, 10)) > 0 &&
+                  nbrThreads <= MAX_THREADS && *end == '\0' )
+        {
+            batch->nbrThreads = nbrThreads;
+            i++;
+        }
+        else if ( strcmp(argv[i], "-e") == SAME && i + 1 < argc &&
+                  (batch->errorLimit = strtol(argv[i + 1], &end, 10)) >= 0 &&
+                  *end == '\0' && argv[i + 1][0] != '\0' )
+            i++;
+        else if ( strcmp(argv[i], "-m") == SAME && i + 1 < argc )
+        {
+            /* (batchAddManifest prints any error message.) */
+            if ( ! batchAddManifest (batch, argv[++i]) )
+                return 0;
+        }
+        else if ( argv[i][0] != '-' )
+        {
+            if ( ! batchAdd (batch, argv[i]) )
+                return 0;
+        }
+        else
+        {
+            printError("Usage:  %s [-t|-b|-l] [-s] [-j N] [-e N] "
+                       "[-m manifest] [-p|-P] filename...\n", argv[0]);
+            return 0;
+        }
+    }
+
+    if ( batch->nbrJobs == 0 )
+    {
+        printError("Usage:  %s [-t|-b|-l] [-s] [-j N] [-e N] "
+                   "[-m manifest] [-p|-P] filename...\n", argv[0]);
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,401 @@
+/*
+ * This is a driver to measure how fast the assembler is.  It runs two
+ * kinds of benchmarks and prints one line for each measurement.
+ *
+ * The microbenchmarks time the pieces the passes are built on, in this
+ * process:
+ *      getToken, getNTokens, scanTokens  on a typical instruction line
+ *              (getNTokens is given a fresh copy of the line each time,
+ *              since it changes it, and the copy is counted too);
+ *      addLabel, findLabel  on tables of 1e3, 1e4, ... labels, up to
+ *              the largest size asked for;
+ *      parseLine, encodeInstrs  on a mix of R, I, and J instructions.
+ *
+ * The macrobenchmarks generate three programs -- one with a label on
+ * every line, one with a branch or jump on almost every line, and one
+ * with long, padded, commented lines -- and run the assembler program
+ * (./assembler, which must have been built) on each of them, with its
+ * output thrown away.  For each program they report the best of
+ * NBR_RUNS runs, in megabytes of source and instructions per second,
+ * and the largest peak resident set size of the runs.
+ *
+ * Everything is measured on whatever the objects were compiled with;
+ * "make bench CFLAGS=-O2" measures an optimized build (after "make
+ * clean").
+ *
+ * USAGE:
+ *      name [ maxLabels [ megabytes [ assemblerOptions ] ] ]
+ * where "name" is the name of the executable, "maxLabels" is the size
+ * of the largest label table (1e7 by default), "megabytes" is the size
+ * of each generated program (16 by default), and "assemblerOptions"
+ * (one argument, such as "-j 4" or "-s") are passed on to the
+ * assembler, split at the spaces.
+ *
+ * ERROR CONDITIONS:
+ * A message is printed, and the program returns 1, if the assembler
+ * cannot be run or the programs cannot be written.  The generated
+ * programs have no errors, so the assembler should not print any.
+ */
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "assembler.h"
+#include "Scanner.h"
+
+/* Each artificial benchmark runs for about this many repetitions. */
+#define NBR_REPEATS 2000000
+
+/* Each program is assembled this many times; the best time counts. */
+#define NBR_RUNS 3
+
+/* The most arguments passed on to the assembler. */
+#define MAX_OPTIONS 16
+
+static const char * LINE = "loop:   addi $t0, $t1, -42     # count down";
+
+static const char * INSTRUCTIONS[] =
+{
+        "add  $t0, $t1, $t2", "sll  $s0, $s1, 4", "lw   $a0, 8($sp)",
+        "addi $v0, $zero, 0x7fff", "beq  $t0, $zero, L0", "j    L1",
+        "sw   $ra, -4($sp)", "jr   $ra",
+};
+
+#define NBR_INSTRUCTIONS (sizeof(INSTRUCTIONS) / sizeof(INSTRUCTIONS[0]))
+
+/* The programs the macrobenchmarks generate. */
+typedef enum { LABEL_HEAVY, BRANCH_HEAVY, LONG_LINES } Corpus;
+
+static const char * CORPUS_NAME[] =
+        { "label-heavy", "branch-heavy", "long-line" };
+
+static int failures = 0;
+
+// internal functions (visible to this file only)
+static double now ();
+static void report (const char * what, double seconds, double count,
+                    const char * unit);
+static void benchTokens ();
+static void benchLabels (int maxLabels);
+static void benchEncoding ();
+static void benchAssembler (Corpus corpus, long size, char * options[]);
+static long writeCorpus (FILE * file, Corpus corpus, long size);
+
+int main (int argc, char * argv[])
+{
+    int    maxLabels = argc > 1 ? (int) strtod (argv[1], NULL) : 10000000;
+    long   megabytes = argc > 2 ? strtol (argv[2], NULL, 10) : 16;
+    char   optionText[256] = "";
+    char * options[MAX_OPTIONS];
+    int    nbrOptions = 0;
+
+    /* The options for the assembler, split at the spaces. */
+    if ( argc > 3 )
+        (void) snprintf (optionText, sizeof(optionText), "%s", argv[3]);
+    for ( char * option = strtok (optionText, " "); option != NULL &&
+          nbrOptions < MAX_OPTIONS - 1; option = strtok (NULL, " ") )
+        options[nbrOptions++] = option;
+    options[nbrOptions] = NULL;
+
+    printf ("scanner: %s\n", scanImplementation ());
+    benchTokens ();
+    benchLabels (maxLabels);
+    benchEncoding ();
+    benchAssembler (LABEL_HEAVY, megabytes << 20, options);
+    benchAssembler (BRANCH_HEAVY, megabytes << 20, options);
+    benchAssembler (LONG_LINES, megabytes << 20, options);
+
+    return failures > 0;
+}
+
+static double now ()
+ /* Returns the time, in seconds, from some fixed point in the past. */
+{
+    struct timespec time;
+
+    (void) clock_gettime (CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static void report (const char * what, double seconds, double count,
+                    const char * unit)
+ /* Prints how long each of count things took, and how many per second. */
+{
+    printf ("%-34s %10.1f ns/%-6s %12.0f %s/s\n", what,
+            seconds / count * 1e9, unit, count / seconds, unit);
+}
+
+static void benchTokens ()
+ /* The tokenizer microbenchmarks. */
+{
+    char      copy[64];
+    char *    tokens[5];
+    TokenSpan spans[6];
+    char *    begin;
+    char *    end;
+    int       length = strlen (LINE);
+    long      found = 0;
+    double    start;
+
+    /* getToken, one token after another to the end of the line. */
+    start = now ();
+    for ( int i = 0; i < NBR_REPEATS; i++ )
+    {
+        begin = (char *) LINE;
+        for ( getToken (&begin, &end); *begin != '\0' && *begin != '#';
+              getToken (&begin, &end) )
+        {
+            found++;
+            begin = end;
+        }
+    }
+    report ("getToken (per line)", now () - start, NBR_REPEATS, "line");
+
+    /* getNTokens, on a fresh copy of the line without the comment. */
+    start = now ();
+    for ( int i = 0; i < NBR_REPEATS; i++ )
+    {
+        memcpy (copy, LINE, 30);
+        copy[30] = '\0';
+        found += getNTokens (copy, 5, tokens);
+    }
+    report ("getNTokens (per line)", now () - start, NBR_REPEATS, "line");
+
+    /* scanTokens, which pass 1 uses. */
+    start = now ();
+    for ( int i = 0; i < NBR_REPEATS; i++ )
+        found += scanTokens (LINE, length, spans, 6);
+    report ("scanTokens (per line)", now () - start, NBR_REPEATS, "line");
+
+    if ( found == 0 )
+        failures++;             /* (and keeps the loops from vanishing) */
+}
+
+static void benchLabels (int maxLabels)
+ /* The label table microbenchmarks, for 1e3, 1e4, ... maxLabels labels. */
+{
+    LabelTable table;
+    char *     names;
+    char       what[64];
+    int        missing = 0;
+    double     start;
+
+    /* Make all the names up front, so that sprintf is not timed. */
+    if ( (names = malloc ((size_t) maxLabels * 12)) == NULL )
+    {
+        printf ("Error: cannot allocate space for %d label names.\n",
+                maxLabels);
+        failures++;
+        return;
+    }
+    for ( int i = 0; i < maxLabels; i++ )
+        (void) sprintf (names + (size_t) i * 12, "L%d", i);
+
+    for ( int n = 1000; n <= maxLabels; n *= 10 )
+    {
+        tableInit (&table);
+        start = now ();
+        for ( int i = 0; i < n; i++ )
+            (void) addLabel (&table, names + (size_t) i * 12, 4 * i);
+        (void) snprintf (what, sizeof(what), "addLabel (%d labels)", n);
+        report (what, now () - start, n, "label");
+
+        /* Look them up in an order unlike the one they were added in. */
+        start = now ();
+        for ( int i = 0; i < n; i++ )
+            if ( findLabel (&table,
+                            names + (size_t) ((i * 7919L) % n) * 12) < 0 )
+                missing++;
+        (void) snprintf (what, sizeof(what), "findLabel (%d labels)", n);
+        report (what, now () - start, n, "label");
+        tableFree (&table);
+
+        if ( n > maxLabels / 10 )
+            break;
+    }
+
+    if ( missing > 0 )
+        failures++;
+    free (names);
+}
+
+static void benchEncoding ()
+ /* The instruction parsing and encoding microbenchmarks. */
+{
+    LabelTable     table;
+    IRProgram      program;
+    OutputSink     out;
+    LineView       line;
+    IRInstr        instr;
+    int            n = NBR_REPEATS / 4;
+    int            nbrErrors = 0;
+    double         start;
+
+    tableInit (&table);
+    irInit (&program);
+    outputInit (&out, -1, OUTPUT_BINARY_BE);
+    (void) addLabel (&table, "L0", 0);
+    (void) addLabel (&table, "L1", 4);
+
+    start = now ();
+    for ( int i = 0; i < n; i++ )
+    {
+        line.ptr = INSTRUCTIONS[i % NBR_INSTRUCTIONS];
+        line.length = strlen (line.ptr);
+        line.lineNbr = i + 1;
+        if ( parseLine (&line, 4 * i, &table, 1, &instr) <= 0 ||
+             ! irAppend (&program, &instr) )
+            nbrErrors++;
+    }
+    report ("parseLine (per instruction)", now () - start, n, "instr");
+
+    /* Encode the instructions a few at a time, each run starting at
+     * address 0, so that the branches to L0 stay in range.
+     */
+    if ( ! outputReserve (&out, program.nbrInstrs) )
+        nbrErrors++;
+    start = now ();
+    for ( int i = 0; i + (int) NBR_INSTRUCTIONS <= program.nbrInstrs;
+          i += NBR_INSTRUCTIONS )
+        nbrErrors += encodeInstrs (program.instrs + i, NBR_INSTRUCTIONS, 0,
+                                   &table, &out, 1);
+    report ("encodeInstrs (per instruction)", now () - start,
+            out.nbrWords, "instr");
+
+    if ( nbrErrors > 0 )
+        failures++;
+    outputFree (&out);
+    irFree (&program);
+    tableFree (&table);
+}
+
+static void benchAssembler (Corpus corpus, long size, char * options[])
+ /* The macrobenchmark for one generated program. */
+{
+    char           filename[] = "/tmp/benchXXXXXX";
+    char *         args[MAX_OPTIONS + 3];
+    char           what[64];
+    FILE *         file;
+    struct rusage  usage;
+    long           nbrInstrs;
+    long           peak = 0;
+    double         best = 0;
+    double         start, seconds;
+    int            fd, status, nbrArgs = 0;
+    pid_t          child;
+
+    if ( (fd = mkstemp (filename)) < 0 || (file = fdopen (fd, "w")) == NULL )
+    {
+        printf ("Error: cannot write a program in /tmp.\n");
+        failures++;
+        return;
+    }
+    nbrInstrs = writeCorpus (file, corpus, size);
+    size = ftell (file);
+    (void) fclose (file);
+
+    args[nbrArgs++] = "./assembler";
+    args[nbrArgs++] = filename;
+    args[nbrArgs++] = "-b";
+    for ( int i = 0; options[i] != NULL; i++ )
+        args[nbrArgs++] = options[i];
+    args[nbrArgs] = NULL;
+
+    for ( int run = 0; run < NBR_RUNS; run++ )
+    {
+        start = now ();
+        if ( (child = fork ()) == 0 )
+        {
+            /* Throw the machine code away. */
+            fd = open ("/dev/null", O_WRONLY);
+            (void) dup2 (fd, STDOUT_FILENO);
+            (void) execv (args[0], args);
+            _exit (127);
+        }
+        if ( child < 0 || wait4 (child, &status, 0, &usage) != child ||
+             ! WIFEXITED (status) || WEXITSTATUS (status) != 0 )
+        {
+            printf ("Error: %s could not assemble the %s program.\n",
+                    args[0], CORPUS_NAME[corpus]);
+            failures++;
+            break;
+        }
+        seconds = now () - start;
+        if ( run == 0 || seconds < best )
+            best = seconds;
+        if ( usage.ru_maxrss > peak )
+            peak = usage.ru_maxrss;         /* in kilobytes */
+    }
+    (void) unlink (filename);
+
+    if ( best > 0 )
+    {
+        (void) snprintf (what, sizeof(what), "assembler (%s)",
+                         CORPUS_NAME[corpus]);
+        printf ("%-34s %8.1f MB/s %12.0f instr/s %8.1f MB peak RSS\n",
+                what, size / best / (1 << 20), nbrInstrs / best,
+                peak / 1024.0);
+    }
+}
+
+static long writeCorpus (FILE * file, Corpus corpus, long size)
+ /* Writes about size bytes of a program of the given kind to file.
+  * Returns the number of instructions in it.
+  */
+{
+    long n = 0;
+    int  width;
+
+    while ( ftell (file) < size )
+    {
+        switch ( corpus )
+        {
+            case LABEL_HEAVY:
+                /* every instruction has a label of its own */
+                fprintf (file, "label_%ld: add $t%ld, $t%ld, $s%ld\n", n,
+                         n % 8, (n + 1) % 8, n % 7);
+                break;
+
+            case BRANCH_HEAVY:
+                /* branches back and forward, and jumps far ahead */
+                if ( n % 16 == 0 )
+                    fprintf (file, "B%ld:\n", n / 16);
+                if ( n % 4 == 3 )
+                    fprintf (file, "    addi $t0, $t0, -1\n");
+                else if ( n % 4 == 2 )
+                    fprintf (file, "    j    B%ld\n", n / 16 + 100);
+                else
+                    fprintf (file, "    %s  $t0, $zero, B%ld\n",
+                             n % 2 ? "bne" : "beq",
+                             n / 16 + (n % 8 < 4 ? 0 : 1));
+                break;
+
+            default:  /* LONG_LINES */
+                /* Labels are padded after the colon, so every line is
+                 * about as long.
+                 */
+                width = n % 32 == 0 ? fprintf (file, "a_long_label_name_%ld:",
+                                               n) : 0;
+                fprintf (file, "%*s", width < 27 ? 27 - width : 0, "");
+                fprintf (file, "  lw      $t%ld ,   %ld( $sp )     %60s"
+                         "# load word %ld, which the next few "
+                         "instructions are going to need\n",
+                         n % 8, 4 * (n % 1000), "", n);
+                break;
+        }
+        n++;
+    }
+
+    /* Every label branched or jumped to has to be defined. */
+    if ( corpus == BRANCH_HEAVY )
+        for ( long label = (n - 1) / 16 + 1, last = label + 100;
+              label <= last; label++ )
+        {
+            fprintf (file, "B%ld: jr $ra\n", label);
+            n++;
+        }
+    return n;
+}
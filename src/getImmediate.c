@@ -0,0 +1,104 @@
+/*
+ * This file contains the getImmediate function, which decodes the
+ * immediate value of an instruction (e.g., "2", "-4", or "0x7fff") from
+ * its token and checks that it fits the field it goes in.
+ *
+ * The number is decoded in place, in a single pass over the token: no
+ * null-terminated copy is made for strtol.  Each character is looked up
+ * in a table of digit values, in which anything that is not a digit is
+ * worth more than any base (10, or 16 after 0x) allows, and the value
+ * is added in whether the character was a digit of the base or not;
+ * whether every character was one is only checked once, at the end,
+ * along with the range.  The value is capped as it goes, so a token of
+ * any length cannot overflow it, and the loop has no branch but its own.
+ *
+ * As with strtol, a number may have a sign, and leading zeroes (which
+ * do not make it octal).
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#include "assembler.h"
+
+/* One more than the value of each digit, hexadecimal ones included;
+ * 0 for any other character, which (less one) is then worth more than
+ * any digit.
+ */
+static const unsigned char DIGIT_VALUE[256] =
+{
+        ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,
+        ['5'] = 6,  ['6'] = 7,  ['7'] = 8,  ['8'] = 9,  ['9'] = 10,
+        ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15,
+        ['f'] = 16, ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14,
+        ['E'] = 15, ['F'] = 16,
+};
+
+/* The value is capped at VALUE_CAP, more than any field can hold (and
+ * little enough that times 16, plus what a non-digit is worth, it
+ * cannot overflow).
+ */
+static const uint64_t VALUE_CAP = (uint64_t) 1 << 32;
+
+/**
+ * getImmediate -- decode an immediate value
+ * Parameters:  text -- the number, in decimal or hexadecimal (0x...),
+ *                  with or without a sign (need not be null-terminated)
+ *              length -- the number of characters in text
+ *              min, max -- the range of the field the value goes in
+ *              line -- the line number, for error messages
+ *              value -- set to the value
+ * Postcondition:
+ *              If text is a number between min and max, *value is set
+ *              to it and getImmediate returns 1.  Otherwise an invalid
+ *              number or out of range error is reported, *value is
+ *              unchanged, and getImmediate returns 0.
+ */
+int getImmediate (const char * text, int length, long min, long max,
+                  int line, int32_t * value)
+{
+    const unsigned char * next = (const unsigned char *) text;
+    const unsigned char * end = next + length;
+    int                   negative;
+    unsigned              base = 10;
+    unsigned              bad = 0;      /* 1 once a non-digit is seen */
+    uint64_t              result = 0;
+    int64_t               signedResult;
+
+    negative = next < end && *next == '-';
+    next += next < end && (*next == '-' || *next == '+');
+    if ( end - next > 2 && next[0] == '0' && (next[1] | 0x20) == 'x' )
+    {
+        base = 16;
+        next += 2;
+    }
+    if ( next == end )
+    {
+        reportError (DIAG_INVALID_NUMBER, line, text, length);
+        return 0;                   /* no digits at all */
+    }
+
+    for ( ; next < end; next++ )
+    {
+        uint32_t digit = DIGIT_VALUE[*next] - 1u;
+
+        bad |= digit >= base;
+        result = result * base + digit;
+        result = result > VALUE_CAP ? VALUE_CAP : result;
+    }
+
+    if ( bad )
+    {
+        reportError (DIAG_INVALID_NUMBER, line, text, length);
+        return 0;
+    }
+    signedResult = negative ? -(int64_t) result : (int64_t) result;
+    if ( signedResult < min || signedResult > max )
+    {
+        reportError (DIAG_OUT_OF_RANGE, line, text, length);
+        return 0;
+    }
+
+    *value = (int32_t) signedResult;
+    return 1;
+}
@@ -0,0 +1,99 @@
+/*
+ * This file contains the getNTokenSpans function, the non-destructive
+ * sibling of getNTokens.  It reads the specified number of tokens from
+ * a string that need not be null-terminated.  It takes four
+ * parameters: the string, its length, the number of tokens that should
+ * be in the string, and an array large enough to take N token spans.
+ * The string is never modified; each token is described by a pointer
+ * to its first character and its length.
+ *
+ * Tokens are defined exactly as for getNTokens (see getNTokens.c).
+ * Instead of putting a pointer to an error message in the first array
+ * element, getNTokenSpans returns a status code (TOKENS_OK,
+ * TOKENS_TOO_FEW, TOKENS_TOO_MANY, ...); tokenStatusMessage turns a
+ * status code into the message getNTokens would have used.
+ *
+ * The getNTokenSpans function uses the scanTokens function, which
+ * classifies the characters of the line 64 at a time (see Scanner.h).
+ * It finds the same tokens as getTokenSpan, except that a delimiter is
+ * never part of one (see getNTokens.c).
+ *
+ * See getToken.h for more specific information about how
+ * getNTokenSpans behaves and for an example.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Documented how its tokens differ from
+ *                           getTokenSpan's.
+ *
+ */
+
+#include <stdio.h>
+
+#include "getToken.h"
+#include "Scanner.h"
+
+/* Define error messages (global within this file). */
+static const char * TOO_FEW = "Instruction contains fewer tokens than expected.";
+static const char * TOO_MANY = "Instruction contains more tokens than expected.";
+static const char * TOO_LONG = "Instruction contains a token that is too long.";
+static const char * INVALID = "Invalid parameters to getNTokenSpans.";
+
+/**
+ * getNTokenSpans -- read N tokens from the first length characters of
+ *                   line, putting the resulting token spans in results
+ * Parameters:  line -- a string containing tokens (need not be
+ *                  null-terminated)
+ *              length -- the number of characters in line
+ *              N -- the expected number of tokens in line
+ *              results -- an array of token spans
+ * Precondition:
+ *              line is a valid pointer to at least length characters &&
+ *              N >= 1 &&
+ *              results is a valid pointer to an array containing space
+ *                  for at least N token spans
+ * Postcondition:
+ *              line is unchanged.  If line contains N tokens, results
+ *              is filled with spans, one for each of those tokens, and
+ *              getNTokenSpans returns TOKENS_OK.  If line contains
+ *              fewer or more than N tokens, getNTokenSpans returns
+ *              TOKENS_TOO_FEW or TOKENS_TOO_MANY, and the contents of
+ *              results are undefined.
+ */
+int getNTokenSpans (const char * line, int length, int N,
+                    TokenSpan results[])
+{
+    int count;
+
+    /* We're not responsible for checking pre-condition, and we can't
+     * check some aspects of it, but let's check the basics anyway.
+     */
+    if ( line == NULL || length < 0 || N < 1 || results == NULL )
+        return TOKENS_INVALID;
+
+    /* Find the tokens, keeping (at most) the first N of them. */
+    count = scanTokens (line, length, results, N);
+    if ( count < 0 )
+        return TOKENS_TOO_LONG;
+    if ( count < N )
+        return TOKENS_TOO_FEW;
+    if ( count > N )
+        return TOKENS_TOO_MANY;
+
+    return TOKENS_OK;
+}
+
+/**
+ * tokenStatusMessage -- describe a status code from getNTokenSpans
+ * Returns NULL for TOKENS_OK, or an appropriate error message.
+ */
+const char * tokenStatusMessage (int status)
+{
+    switch ( status )
+    {
+        case TOKENS_OK:         return NULL;
+        case TOKENS_TOO_FEW:    return TOO_FEW;
+        case TOKENS_TOO_MANY:   return TOO_MANY;
+        case TOKENS_TOO_LONG:   return TOO_LONG;
+        default:                return INVALID;
+    }
+}
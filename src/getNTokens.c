@@ -21,7 +21,15 @@
  * pointer to a different error message in the first array element
  * ("Instruction contains more tokens than expected.").
  *
- * The getNTokens function uses the getToken function.
+ * The getNTokens function uses the scanTokens function, which
+ * classifies the characters of the string 64 at a time (see Scanner.h).
+ * Its tokens differ from those of the getToken loop used before in one
+ * way: a delimiter is never a token, nor part of one.  getToken only
+ * skips whitespace, so a delimiter where a token could start (at the
+ * beginning of the string, after a space, or after another delimiter)
+ * used to start one: "add $t0 , $t1, $t2" had the extra token ",", and
+ * "add $t0,,$t1" the token ",$t1".  Now the first has 4 tokens and the
+ * second 3, "add", "$t0", and "$t1".
  *
  * See getNTokens.h for more specific information about how getNTokens
  * behaves and for an example.
@@ -29,15 +37,21 @@
  * Author:          Alyce Brady
  * Creation Date:   5/21/14
  *
+ * Modified:  10/14/2026  find all the tokens at once with scanTokens.
+ * Modified:  10/14/2026  documented that delimiters are never tokens.
+ *
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "getToken.h"
+#include "Scanner.h"
 
 /* Define error messages (global within this file). */
 static char * TOO_FEW = "Instruction contains fewer tokens than expected.";
 static char * TOO_MANY = "Instruction contains more tokens than expected.";
+static char * TOO_LONG = "Instruction contains a token that is too long.";
 
 /**
  * getNTokens -- read N tokens from instructionBuffer, putting the
@@ -61,8 +75,7 @@ static char * TOO_MANY = "Instruction contains more tokens than expected.";
 int getNTokens (char * instructionBuffer, int N, char * results[])
 {
     int i;
-    char * tokBegin = instructionBuffer;
-    char * tokEnd;
+    int count;
 
     /* We're not responsible for checking pre-condition, and we can't
      * check some aspects of it, but let's check the basics anyway.
@@ -70,62 +83,34 @@ int getNTokens (char * instructionBuffer, int N, char * results[])
     if ( instructionBuffer == NULL || N < 1 || results == NULL )
         return 0;
 
-// printf("About to get expected tokens.\n");
-    /* Get the expected tokens. */
-    for ( i = 0; i < N; i++, tokBegin = tokEnd + 1 )
+    /* Find all the tokens, keeping (at most) the first N of them. */
+    TokenSpan spans[N];
+    count = scanTokens (instructionBuffer, strlen (instructionBuffer),
+                        spans, N);
+    if ( count < 0 )
     {
-        getToken(&tokBegin, &tokEnd);
-        if ( *tokBegin == '\0' )
-        {
-            /* Token expected, but no token found. */
-            results[0] = TOO_FEW;
-            return 0;
-        }
-// printf("Found token starting at %s.\n", tokBegin);
-
-        /* Add this token to the results array. */
-        results[i] = tokBegin;
-
-        /* Does this token already end in a null byte? */
-        if ( *tokEnd == '\0' )
-        {
-// printf("Token is at end of string.\n");
-            /* Yes, which means token is at end of string;
-             * is this OK, or too soon?
-             */
-            if ( i < N-1 )
-            {
-                /* Too soon, have not found N tokens. */
-                results[0] = TOO_FEW;
-                return 0;
-            }
-
-            /* OK; have found all tokens! */
-            return 1;
-
-        }
-        else
-        {
-// printf("Token is not at end of string; rest of string is %s.\n", tokEnd);
-            /* Insert null byte to turn token into a string.*/
-            *tokEnd = '\0';
-// printf("Token is %s; rest of string is %s.\n", tokBegin, tokEnd + 1);
-        }
-// printf("About to loop to next token.\n");
+        results[0] = TOO_LONG;
+        return 0;
     }
-
-    /* Have found all expected tokens, but last one did not end with a
-     * null byte.  Is there another token in instructionBuffer, or do we
-     * just have left-over whitespace?
-     */
-// printf("Is last 'token' an extra or just whitespace?\n");
-    getToken(&tokBegin, &tokEnd);
-    if ( *tokBegin != '\0' )
+    if ( count < N )
+    {
+        /* Tokens expected, but not found. */
+        results[0] = TOO_FEW;
+        return 0;
+    }
+    if ( count > N )
     {
-        /* No token expected, but one is found. */
+        /* No more tokens expected, but more were found. */
         results[0] = TOO_MANY;
         return 0;
     }
 
+    /* Insert null bytes to turn the tokens into strings. */
+    for ( i = 0; i < N; i++ )
+    {
+        results[i] = (char *) spans[i].ptr;
+        results[i][spans[i].len] = '\0';
+    }
+
     return 1;
 }
@@ -0,0 +1,109 @@
+/*
+ * This file contains the getOpType function, which maps the mnemonic
+ * name of an instruction (e.g., "add") to its instruction type ('R',
+ * 'I', or 'J') and its opcode (or, for R-type instructions, its funct
+ * number).
+ *
+ * Rather than comparing the mnemonic against every known name, the
+ * mnemonic is packed into a 64-bit integer and looked up with a perfect
+ * hash: the top HASH_BITS bits of the integer times HASH_MULTIPLIER,
+ * which are different for every mnemonic in the MIPS_INSTRUCTIONS table
+ * in Instructions.h.  The switch statement on the hash is generated
+ * from the same table, at compile time, and its cases are all below
+ * 1 << HASH_BITS, so the compiler turns it into a jump table; the packed
+ * mnemonic of the one instruction it can be is then compared with the
+ * whole integer.  Classification takes a few instructions no matter how
+ * many instructions are known.
+ *
+ * If a new instruction hashes to the same slot as another one, the
+ * switch has two equal cases, which does not compile: choose another
+ * (odd) HASH_MULTIPLIER, for which the switch does.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Look mnemonics up with a perfect hash.
+ *
+ */
+
+#include "assembler.h"
+#include "Instructions.h"
+
+/* The perfect hash of a packed mnemonic. */
+#define HASH_BITS 7
+#define HASH_MULTIPLIER 0x083cb7adac78a645ULL
+#define HASH(key)  ((unsigned) ((uint64_t) (key) * HASH_MULTIPLIER >> \
+                                (64 - HASH_BITS)))
+
+/* The type, code, and packed mnemonic of each instruction, indexed by
+ * opcode id.
+ */
+#define INSTR(name, form, code, ...)  FORM_TYPE_##form,
+static const char OP_TYPE[NBR_OPCODES] = { MIPS_INSTRUCTIONS };
+#undef INSTR
+
+#define INSTR(name, form, code, ...)  code,
+static const unsigned char OP_CODE[NBR_OPCODES] = { MIPS_INSTRUCTIONS };
+#undef INSTR
+
+#define INSTR(name, form, code, ...)  PACK_MNEMONIC(__VA_ARGS__),
+static const uint64_t OP_KEY[NBR_OPCODES] = { MIPS_INSTRUCTIONS };
+#undef INSTR
+
+/**
+ * getOpType -- classify an instruction mnemonic
+ * Parameters:  opcode -- the mnemonic (need not be null-terminated)
+ *              length -- the number of characters in the mnemonic
+ *              opType -- set to 'R', 'I', or 'J'
+ *              code -- set to the opcode, or funct number for R type
+ *              line -- the line number, for error messages
+ * Postcondition:
+ *              If the mnemonic is known, *opType and *code are set and
+ *              getOpType returns its opcode id (OP_add, OP_lw, ...).
+ *              Otherwise an error is printed, *opType and *code are
+ *              unchanged, and getOpType returns -1.
+ */
+int getOpType (const char * opcode, int length, char * opType, int * code,
+               int line)
+{
+    uint64_t key = 0;
+    int      id;
+
+    /* Pack the mnemonic the same way PACK_MNEMONIC does.  Anything too
+     * long to pack (or containing a null byte, which would look like
+     * padding) is not a known mnemonic; 0 is no instruction's key.
+     */
+    if ( length <= 8 )
+    {
+        for ( int i = 0; i < length; i++ )
+        {
+            if ( opcode[i] == '\0' )
+            {
+                key = 0;
+                break;
+            }
+            key |= (uint64_t) (unsigned char) opcode[i] << (8 * i);
+        }
+    }
+
+    /* The hash says which instruction it can be... */
+    switch ( HASH(key) )
+    {
+#define INSTR(name, form, code, ...) \
+        case HASH(PACK_MNEMONIC(__VA_ARGS__)):  id = OP_##name;  break;
+        MIPS_INSTRUCTIONS
+#undef INSTR
+        default:
+            id = -1;
+            break;
+    }
+
+    /* ...if it is any. */
+    if ( id < 0 || OP_KEY[id] != key )
+    {
+        reportError (DIAG_UNKNOWN_INSTR, line, opcode, length);
+        return -1;
+    }
+
+    *opType = OP_TYPE[id];
+    *code = OP_CODE[id];
+    return id;
+}
@@ -0,0 +1,99 @@
+/*
+ * This file contains the getRegNbr function, which maps the name of a
+ * register (e.g., "$t0", "$sp", or "$8") to its register number.
+ *
+ * The name is decoded directly, without string comparisons:
+ *      $0 - $31    the digits are converted inline;
+ *      $v0, $t3, ... (a letter and a digit)  the letter selects a
+ *                  family of registers from a small table, and the
+ *                  digit selects the register within that family;
+ *      $zero, $sp, ... (any other name)  the characters are packed
+ *                  into an integer and looked up with a switch.
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#include "assembler.h"
+#include "Instructions.h"
+
+/* The registers named by a letter and a digit, indexed by the letter:
+ * the number of the register for digit 0 and how many digits are valid
+ * ($t8 and $t9 are not contiguous with $t0-$t7; see below).
+ */
+static const struct { signed char first; signed char count; } FAMILY[26] =
+{
+        ['v' - 'a'] = {  2,  2 },       /* $v0 - $v1 */
+        ['a' - 'a'] = {  4,  4 },       /* $a0 - $a3 */
+        ['t' - 'a'] = {  8, 10 },       /* $t0 - $t7, $t8 - $t9 */
+        ['s' - 'a'] = { 16,  8 },       /* $s0 - $s7 */
+        ['k' - 'a'] = { 26,  2 },       /* $k0 - $k1 */
+};
+
+/**
+ * getRegNbr -- decode a register name
+ * Parameters:  regName -- the register name, including the '$' (need
+ *                  not be null-terminated)
+ *              length -- the number of characters in regName
+ *              line -- the line number, for error messages
+ * Returns the register number (0 - 31), or -1 (after printing an error)
+ *      if regName is not a valid register name.
+ */
+int getRegNbr (const char * regName, int length, int line)
+{
+    unsigned char c1, c2;
+    uint64_t      key = 0;
+    int           reg = -1;
+
+    if ( length < 2 || length > 5 || regName[0] != '$' )
+    {
+        reportError (DIAG_INVALID_REGISTER, line, regName, length);
+        return -1;
+    }
+    c1 = regName[1];
+    c2 = length > 2 ? regName[2] : 0;
+
+    if ( c1 >= '0' && c1 <= '9' )
+    {
+        /* $0 - $31, without leading zeroes */
+        if ( length == 2 )
+            reg = c1 - '0';
+        else if ( length == 3 && c1 != '0' && c2 >= '0' && c2 <= '9' )
+        {
+            reg = 10 * (c1 - '0') + (c2 - '0');
+            if ( reg > 31 )
+                reg = -1;
+        }
+    }
+    else if ( length == 3 && c1 >= 'a' && c1 <= 'z' && c2 >= '0' && c2 <= '9'
+              && (c2 - '0') < FAMILY[c1 - 'a'].count )
+    {
+        /* a letter and a digit; $t8 and $t9 come after $s0 - $s7 */
+        reg = FAMILY[c1 - 'a'].first + (c2 - '0');
+        if ( c1 == 't' && c2 >= '8' )
+            reg += 8;
+    }
+
+    if ( reg < 0 )
+    {
+        /* any other name: pack the characters after the '$' */
+        for ( int i = 1; i < length; i++ )
+            key |= (uint64_t) (unsigned char) regName[i] << (8 * (i - 1));
+
+        switch ( key )
+        {
+            case PACK_MNEMONIC('z','e','r','o'):  reg = 0;   break;
+            case PACK_MNEMONIC('a','t'):          reg = 1;   break;
+            case PACK_MNEMONIC('g','p'):          reg = 28;  break;
+            case PACK_MNEMONIC('s','p'):          reg = 29;  break;
+            case PACK_MNEMONIC('f','p'):          reg = 30;  break;
+            case PACK_MNEMONIC('s','8'):          reg = 30;  break;
+            case PACK_MNEMONIC('r','a'):          reg = 31;  break;
+            default:
+                reportError (DIAG_INVALID_REGISTER, line, regName, length);
+                return -1;
+        }
+    }
+
+    return reg;
+}
@@ -14,11 +14,16 @@
  *
  * Modified:  3/17/2000   added colon as a token delimiter so that
  *                        getToken can be used to find labels.
+ * Modified:  10/14/2026  added getTokenSpan for read-only strings that
+ *                        need not be null-terminated.
+ * Modified:  10/14/2026  classify characters with the CHAR_CLASS table
+ *                        instead of isspace and separate compares.
  *
  */
 
 #include <stdio.h>
-#include <ctype.h>
+
+#include "CharClass.h"
 
 void getToken (char ** tokBegin, char ** tokEnd)
   /* postcondition: if tokBegin or *tokBegin was NULL when getToken was
@@ -38,7 +43,7 @@ void getToken (char ** tokBegin, char ** tokEnd)
             return;
 
         /* Skip any leading whitespace. */
-        while (**tokBegin != '\0' && isspace (**tokBegin))
+        while (IS_SPACE (**tokBegin))
             (*tokBegin)++;
         if ( **tokBegin == '\0' )
         {
@@ -48,12 +53,35 @@ void getToken (char ** tokBegin, char ** tokEnd)
 
         /* Find the end of the first token */
         *tokEnd = *tokBegin + 1;
-        while (**tokEnd != '\0' && **tokEnd != ',' &&
-               **tokEnd != '(' && **tokEnd != ')' && **tokEnd != ':' &&
-               !isspace (**tokEnd))
+        while (! IS_TOKEN_END (**tokEnd))
             (*tokEnd)++;
 
         /* (*tokBegin) now points to beginning of token;
          * (*tokEnd) now points to 1st character AFTER token
          */
 }
+
+void getTokenSpan (const char ** tokBegin, const char ** tokEnd,
+                   const char * limit)
+  /* postcondition: if *tokBegin reached limit without finding a token,
+   *                    both *tokBegin and *tokEnd are limit;
+   *                otherwise, *tokBegin will point to the first
+   *                    character in the next token and *tokEnd will
+   *                    point to the first character AFTER the token
+   *                    (possibly limit)
+   */
+{
+        /* Skip any leading whitespace. */
+        while (*tokBegin < limit && IS_SPACE (**tokBegin))
+            (*tokBegin)++;
+        if ( *tokBegin >= limit )
+        {
+            *tokBegin = *tokEnd = limit;
+            return;
+        }
+
+        /* Find the end of the first token */
+        *tokEnd = *tokBegin + 1;
+        while (*tokEnd < limit && ! IS_SPAN_END (**tokEnd))
+            (*tokEnd)++;
+}
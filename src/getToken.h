@@ -85,12 +85,72 @@
  *
  * Modified:  3/17/2000   added colon as a token delimiter so that
  *                        getToken can be used to find labels.
+ * Modified:  10/14/2026  added getTokenSpan, which never modifies the
+ *                        string and stops at a given limit.
+ *
+ * void getTokenSpan (const char ** tokBegin, const char ** tokEnd,
+ *                    const char * limit)
+ *   getTokenSpan finds the same tokens as getToken, but in a string
+ *   that need not be null-terminated, such as a line view into a
+ *   read-only, memory-mapped source file.  The characters from
+ *   *tokBegin up to (but not including) limit are searched; limit acts
+ *   just like a null byte would.  Since the string cannot be changed,
+ *   a token is described by its beginning and length instead of being
+ *   turned into a string:
+ *      length = end - begin;
+ *      printf ("%.*s", length, begin);
+ *   postcondition: if *tokBegin reached limit without finding a token,
+ *                      both *tokBegin and *tokEnd are limit;
+ *                  otherwise, *tokBegin will point to the first
+ *                      character in the next token and *tokEnd will
+ *                      point to the first character AFTER the token
+ *                      (possibly limit)
+ *
+ * int getNTokenSpans (const char * line, int length, int N,
+ *                     TokenSpan results[])
+ *   getNTokenSpans is the non-destructive sibling of getNTokens.  It
+ *   reads N tokens from the first length characters of line, and
+ *   fills results with one {ptr, len} span for each token.  These are
+ *   getTokenSpan's tokens, except that a delimiter is never part of
+ *   one: getTokenSpan, which only skips whitespace, starts a token on
+ *   a delimiter at the beginning of the line, after a space, or after
+ *   another delimiter (see scanTokens in Scanner.h).  The line itself
+ *   is never modified, so it may be a view into a read-only source,
+ *   and it can still be printed afterwards (e.g., in an error
+ *   message).  Instead of putting an error message in results[0],
+ *   getNTokenSpans returns a status code:
+ *      TOKENS_OK        the line contains exactly N tokens
+ *      TOKENS_TOO_FEW   the line contains fewer than N tokens
+ *      TOKENS_TOO_MANY  the line contains more than N tokens
+ *      TOKENS_TOO_LONG  a token is longer than a span can describe
+ *      TOKENS_INVALID   the parameters do not meet the precondition
+ *   tokenStatusMessage returns the same messages getNTokens would use.
+ *
+ *   EXAMPLE:
+ *      TokenSpan tokens[4];
+ *      if ( getNTokenSpans (line.ptr, line.length, 4, tokens) == TOKENS_OK )
+ *          printf ("%.*s\n", tokens[0].len, tokens[0].ptr);
  *
  */
 
 #ifndef _GETTOKEN_H
 #define _GETTOKEN_H
 
+#include <stdint.h>
+
+typedef struct {
+        const char * ptr;       /* first character of the token */
+        uint16_t len;           /* nbr of characters in the token */
+} TokenSpan;
+
+enum { TOKENS_OK, TOKENS_TOO_FEW, TOKENS_TOO_MANY, TOKENS_TOO_LONG,
+       TOKENS_INVALID };
+
 void getToken (char ** tokBegin, char ** tokEnd);
+void getTokenSpan (const char ** tokBegin, const char ** tokEnd,
+                   const char * limit);
+int getNTokenSpans (const char * line, int length, int N,
+                    TokenSpan results[]);
+const char * tokenStatusMessage (int status);
 
 #endif
@@ -0,0 +1,79 @@
+/*
+ * This file contains the onePass function, which assembles a program
+ * in a single pass over the source, as an alternative to pass1 followed
+ * by pass2.  Each line is read and tokenized only once: labels are
+ * added to the label table as they are found and instructions are
+ * parsed (see parseLine in pass1.c) and encoded (see encodeInstr in
+ * assemble.c) right away, without keeping the intermediate
+ * representation of the whole program.  A branch or jump
+ * to a label that has not been defined yet is encoded without its
+ * offset or target and recorded in a list of fixups, keyed by the
+ * label, which are patched into the output once the whole program has
+ * been read and the label table is complete (see Fixups.h).
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Invalid instructions take up their word.
+ *
+ */
+
+#include "assembler.h"
+
+static const int INSTRUCTION_SIZE = 4;		/* in bytes */
+
+/**
+ * onePass -- build the label table for a source program and encode it
+ * Parameters:  source -- an open source file, positioned at its first
+ *                  line
+ *              table -- an empty label table
+ *              fixups -- an empty list, for the forward references
+ *              out -- where the encoded instructions go
+ * Postcondition:
+ *              The table holds every label that appears at the
+ *              beginning of a line in source, with its address, as
+ *              well as any undefined labels that were referenced.
+ *              Every valid instruction in source has been encoded and
+ *              added to out, and every other one added as a placeholder
+ *              (see encodeInstr); every invalid one, duplicate label, and
+ *              reference to an undefined label has been reported as an
+ *              error, until the errors reached their limit (see
+ *              errorLimitReached), if they did; the rest of the source
+ *              is then skipped.  Otherwise the source is positioned at
+ *              its end.
+ * Returns the number of errors.
+ */
+int onePass (SourceFile * source, LabelTable * table, FixupList * fixups,
+             OutputSink * out)
+{
+    LineView     line;
+    IRInstr      instr;
+    int          PC = 0;
+    int          nbrErrors = 0;
+    int          found;
+
+    /* Make room for all the labels at once (see sourceCountLabels). */
+    if ( ! tableReserve (table, sourceCountLabels (source)) )
+        return 1;                   /* fatal error: out of memory */
+
+    while ( sourceNextCodeLine (source, &line) )
+    {
+        if ( (found = parseLine (&line, PC, table, 1, &instr)) < 0 )
+        {
+            nbrErrors++;
+            break;                  /* fatal error: out of memory */
+        }
+        if ( ! found )
+            continue;
+
+        if ( ! encodeInstr (&instr, PC, table, fixups, out) )
+            nbrErrors++;
+        PC += INSTRUCTION_SIZE;
+        if ( errorLimitReached () )
+            return nbrErrors;       /* too many errors: stop */
+    }
+
+    /* Now that every label is defined, patch the forward references. */
+    printDebug ("onePass: %d forward references\n", fixups->nbrFixups);
+    nbrErrors += applyFixups (fixups, table, out);
+
+    return nbrErrors;
+}
@@ -0,0 +1,682 @@
+/*
+ * This file contains the pass1 function, the first pass of the
+ * assembler, and the parseLine function it is built on.  pass1 reads
+ * through the source one line at a time and
+ *      builds a table of the labels that appear at the beginning of a
+ *      line together with the addresses of the instructions they
+ *      label, and
+ *      parses each instruction into a record of the intermediate
+ *      representation (see IR.h), which is all pass2 needs to encode
+ *      the program.
+ * Instructions are assumed to be 4 bytes long, with the first
+ * instruction starting at address 0.  A label that appears on a line
+ * by itself labels the next instruction.  Everything from a '#' to the
+ * end of a line is a comment.
+ *
+ * pass1 only looks at the lines through read-only line views and token
+ * spans, so the source is left untouched.  The blank and comment-only
+ * lines never get to it, and the lines that do come without their
+ * comments (see sourceNextCodeLine).
+ *
+ * A large source can be read on several threads.  The address of a
+ * label depends on the number of instructions before it, so this is
+ * done in steps:
+ *      1. The source is cut into shards at line boundaries.  Each
+ *         thread counts the lines and instructions in its shard and
+ *         collects the shard's labels, with addresses relative to the
+ *         start of the shard.
+ *      2. The line and instruction counts of the shards before each
+ *         shard are added up, which gives the number of its first
+ *         line and the address of its first instruction.
+ *      3. Each thread parses the instructions in its shard into an
+ *         intermediate representation of its own.  The labels it
+ *         refers to go into a small label table of its own, and its
+ *         errors go into a diagnostic sink of its own (see
+ *         Diagnostics.h), marking where each of the shard's labels
+ *         comes in between them.
+ *      4. Shard by shard, the labels are added to the label table
+ *         (which reports any duplicates), the shard's errors are
+ *         passed on in between them, each in the order of its line,
+ *         and the instructions are appended to the program, with
+ *         their labels translated to entries of the label table.
+ * The output and the error messages are the same as with one thread.
+ *
+ * pass1Cached reads the source one chunk at a time instead, with a
+ * symbol cache from an earlier run (see SymbolCache.h): the labels and
+ * instructions of a chunk the cache has are added to the label table
+ * and the program from the cache, shifted to where the chunk starts
+ * now, and only the other chunks are parsed.  The new chunks and their
+ * labels go into the cache, for next time.  (A chunk with a label that
+ * is defined already is parsed too, for the error to have its line.)
+ *
+ * Once the errors reach the limit of the sink they go to (see
+ * errorLimitReached), the rest of the source is not assembled.
+ *
+ * Creation Date:   10/14/2026
+ *
+ */
+
+#include <pthread.h>
+
+#include "assembler.h"
+#include "Scanner.h"
+
+static const int INSTRUCTION_SIZE = 4;		/* in bytes */
+
+/* An instruction has at most 3 operands (plus label and mnemonic). */
+#define MAX_TOKENS 6
+
+/* Don't start a thread for less source than this (in bytes). */
+static const size_t MIN_SHARD_SIZE = 256 * 1024;
+
+static const char * ERROR0 = "Error: cannot allocate space in memory.\n";
+
+/* A label found in step 1: where it is, relative to its shard. */
+typedef struct {
+        const char * name;      /* label name, in the source */
+        int length;             /* nbr of characters in the name */
+        int PC;                 /* address, from the start of the shard */
+        int line;               /* line number, from the start of shard */
+        int errorMark;          /* nbr of errors in the shard's sink when
+                                 * its line was reached in step 3 */
+} ShardLabel;
+
+/* One shard of the source and what the steps found out about it. */
+typedef struct {
+        const SourceFile * source;
+        size_t begin, end;      /* offsets of the shard in the source */
+        int nbrLines;           /* step 1 */
+        int nbrInstrs;
+        ShardLabel * labels;
+        int nbrLabels;
+        int capacity;
+        int firstLine;          /* step 2 */
+        int firstPC;
+        LabelTable refs;        /* step 3 */
+        IRProgram program;
+        DiagnosticSink errors;
+        int limit;              /* the limit of the caller's sink */
+        int failed;             /* 1 if out of memory */
+} Shard;
+
+// internal functions (visible to this file only)
+static int scanLine (const LineView * line, TokenSpan tokens[],
+                     int * hasLabel);
+static void parallelPass1 (SourceFile * source, LabelTable * table,
+                           IRProgram * program, int nbrShards);
+static void runShards (Shard shards[], int nbrShards,
+                       void * (* step) (void *));
+static void * countShard (void * shard);
+static void * parseShard (void * shard);
+static int labelsAreNew (LabelTable * table, const SymbolCache * cache,
+                         const CacheChunk * cached);
+
+/**
+ * pass1 -- build the label table and intermediate representation for
+ *      a source program
+ * Parameters:  source -- an open source file, positioned at its first
+ *                  line
+ *              table -- an empty label table, to hold the labels
+ *              program -- an empty program, to hold the instructions
+ *              nbrThreads -- the number of threads to read it on
+ * Postcondition:
+ *              The table holds every label that appears at
+ *              the beginning of a line in source, with its address, as
+ *              well as every label that an instruction refers to
+ *              (undefined, if it is not one of the others).  The
+ *              program holds one record for each instruction in source.
+ *              Duplicate labels and invalid instructions have been
+ *              reported as errors (and counted in the program).  The
+ *              source is positioned at its end, unless the error limit
+ *              was reached, in which case the rest of the source has
+ *              been skipped.
+ */
+void pass1 (SourceFile * source, LabelTable * table, IRProgram * program,
+            int nbrThreads)
+{
+    LineView     line;
+    IRInstr      instr;
+    int          PC = 0;
+    int          found;
+    int          nbrShards = nbrThreads;
+
+    /* At most one shard per MIN_SHARD_SIZE bytes of source. */
+    if ( source->size / MIN_SHARD_SIZE < (size_t) nbrShards )
+        nbrShards = source->size / MIN_SHARD_SIZE;
+    if ( nbrShards > 1 )
+    {
+        parallelPass1 (source, table, program, nbrShards);
+        return;
+    }
+
+    /* Make room for all the labels at once (see sourceCountLabels). */
+    if ( ! tableReserve (table, sourceCountLabels (source)) )
+    {
+        program->nbrErrors++;
+        return;                     /* fatal error: out of memory */
+    }
+
+    while ( sourceNextCodeLine (source, &line) )
+    {
+        if ( (found = parseLine (&line, PC, table, 1, &instr)) < 0 ||
+             (found > 0 && ! irAppend (program, &instr)) )
+        {
+            program->nbrErrors++;
+            break;                  /* fatal error: out of memory */
+        }
+        if ( found )
+            PC += INSTRUCTION_SIZE;
+        if ( errorLimitReached () )
+            break;                  /* too many errors: stop */
+    }
+}
+
+/**
+ * pass1Cached -- build the label table and intermediate representation
+ *      for a source program, with a symbol cache
+ * Parameters:  source, table, program -- as for pass1
+ *              cache -- a symbol cache, with the cache read in from an
+ *                  earlier run (if any) and an empty cache being built
+ * Postcondition:
+ *              The same as for pass1 (on one thread), and the cache
+ *              being built describes the chunks of source and their
+ *              labels (unless memory ran out, which is an error).
+ */
+void pass1Cached (SourceFile * source, LabelTable * table,
+                  IRProgram * program, SymbolCache * cache)
+{
+    SourceFile         lines;
+    LineView           line;
+    IRInstr            instr;
+    TokenSpan          label;
+    CacheChunk         chunk;
+    const CacheChunk * cached;
+    size_t             begin = 0;
+    size_t             end;
+    int                lineNbr = 1;
+    int                nbrLines;
+    int                PC = 0;
+    int                chunkPC;
+    int                found;
+    int                ok = 1;
+
+    /* About as many labels as last time, if there was a last time. */
+    if ( ! tableReserve (table, cache->nbrChunks > 0
+                                ? cache->nbrLabels
+                                : sourceCountLabels (source)) )
+    {
+        program->nbrErrors++;
+        return;                     /* fatal error: out of memory */
+    }
+
+    while ( ok && begin < source->size )
+    {
+        end = cacheNextChunk (source, &chunk.hash, &nbrLines);
+        chunk.size = end - begin;
+        chunk.nbrLines = nbrLines;
+        chunk.firstLabel = cache->nbrNewLabels;
+        chunk.firstInstr = PC / INSTRUCTION_SIZE;
+        chunkPC = PC;
+
+        /* A chunk the cache has: its labels, shifted in bulk. */
+        cached = cacheFindChunk (cache, chunk.hash, chunk.size);
+        if ( cached != NULL && labelsAreNew (table, cache, cached) )
+        {
+            long long start = statsClock ();
+
+            for ( uint32_t i = 0; ok && i < cached->nbrLabels; i++ )
+            {
+                const CacheLabel * old =
+                        &cache->labels[cached->firstLabel + i];
+
+                ok = addLabelLen (table, cache->names + old->name,
+                                  old->length, PC + old->PC, 0) &&
+                     cacheAddLabel (cache, cache->names + old->name,
+                                    old->length, old->PC);
+            }
+            statsTime (STAT_LABELS, start);
+
+            /* ...and its instructions, with their targets in this table. */
+            for ( uint32_t i = 0; ok && i < cached->nbrInstrs; i++ )
+            {
+                instr = cache->instrs[cached->firstInstr + i];
+                instr.line += lineNbr - 1;
+                if ( instr.symbol >= 0 &&
+                     (instr.symbol = cacheTarget (cache, table,
+                                                  instr.symbol)) < 0 )
+                    ok = 0;         /* fatal error: out of memory */
+                ok = ok && irAppend (program, &instr);
+                PC += INSTRUCTION_SIZE;
+            }
+            cache->nbrReused++;
+        }
+
+        /* Parse the lines of a chunk that was not in the cache. */
+        else
+        {
+            sourceSlice (&lines, source, begin, end, lineNbr, 1);
+            while ( ok && sourceNextCodeLine (&lines, &line) )
+            {
+                if ( (found = parseLineLabel (&line, PC, table, 1, &instr,
+                                              &label)) < 0 ||
+                     (found > 0 && ! irAppend (program, &instr)) )
+                    ok = 0;         /* fatal error: out of memory */
+                else if ( label.ptr != NULL )
+                    ok = cacheAddLabel (cache, label.ptr, label.len,
+                                        PC - chunkPC);
+                if ( found > 0 )
+                    PC += INSTRUCTION_SIZE;
+                if ( errorLimitReached () )
+                    return;         /* too many errors: stop */
+            }
+        }
+
+        chunk.nbrInstrs = (PC - chunkPC) / INSTRUCTION_SIZE;
+        chunk.nbrLabels = cache->nbrNewLabels - chunk.firstLabel;
+        ok = ok && cacheAddChunk (cache, &chunk);
+        lineNbr += nbrLines;
+        begin = end;
+    }
+
+    if ( ! ok )
+        program->nbrErrors++;
+    printDebug ("pass1Cached: %d of %d chunks were in the cache\n",
+                cache->nbrReused, cache->nbrNewChunks);
+}
+
+/**
+ * parseLine -- parse the label and instruction (if any) on one line
+ * Parameters:  line -- the line, without its comment (as the code line
+ *                  readers, sourceNextCodeLine and streamNextCodeLine,
+ *                  hand it out): a '#' in it is not taken for one
+ *              PC -- the address of the instruction on the line
+ *              table -- the label table, which the labels the
+ *                  instruction refers to are looked up in (and added
+ *                  to, undefined, if they are not there yet)
+ *              defineLabel -- if 1, a label at the beginning of the line
+ *                  is added to table, with the address PC; if 0, any
+ *                  such label is skipped
+ *              instr -- set to the parsed instruction, if any
+ * Postcondition:
+ *              If the line holds an instruction, instr holds its opcode
+ *              id and operands or, if the instruction is invalid (the
+ *              error has been printed), the id IR_INVALID.
+ * Returns 1 if the line holds an instruction (valid or not); 0 if it is
+ *      blank or only holds a label; -1 if memory allocation error.
+ */
+int parseLine (const LineView * line, int PC, LabelTable * table,
+               int defineLabel, IRInstr * instr)
+{
+    return parseLineLabel (line, PC, table, defineLabel, instr, NULL);
+}
+
+/**
+ * parseLineLabel -- parse the label and instruction (if any) on one
+ *      line, and tell the caller about the label
+ * Parameters:  the same as for parseLine, and
+ *              label -- if not NULL, set to the label at the beginning
+ *                  of the line (whether it was added to table or not),
+ *                  or to a span with a NULL ptr if there is none
+ * Postcondition and return value: the same as for parseLine.
+ */
+int parseLineLabel (const LineView * line, int PC, LabelTable * table,
+                    int defineLabel, IRInstr * instr, TokenSpan * label)
+{
+    TokenSpan    tokens[MAX_TOKENS];
+    TokenSpan *  operands;
+    int          nbrTokens;
+    int          nbrOperands;
+    int          hasLabel;
+    int          id;
+    char         opType;
+    int          code;
+    int          ok;
+
+    instr->id = IR_INVALID;
+    instr->rs = instr->rt = instr->rd = 0;
+    instr->imm = 0;
+    instr->symbol = -1;
+    instr->line = line->lineNbr;
+    if ( label != NULL )
+        label->ptr = NULL;
+
+    countStat (STAT_LINES, 1);
+    if ( (nbrTokens = scanLine (line, tokens, &hasLabel)) < 0 )
+    {
+        reportError (DIAG_TOKEN_TOO_LONG, line->lineNbr, NULL, 0);
+        return 1;
+    }
+    countStat (STAT_TOKENS, nbrTokens);
+    if ( hasLabel && label != NULL )
+        *label = tokens[0];
+    operands = tokens + hasLabel;
+    nbrOperands = nbrTokens - hasLabel;
+
+    /* Is the first token a label? */
+    if ( hasLabel && defineLabel )
+    {
+        long long start = statsClock ();
+
+        printDebug ("parseLine: line %d: label %.*s at address %d\n",
+                    line->lineNbr, tokens[0].len, tokens[0].ptr, PC);
+        ok = addLabelLen (table, tokens[0].ptr, tokens[0].len, PC,
+                          line->lineNbr);
+        statsTime (STAT_LABELS, start);
+        if ( ! ok )
+            return -1;              /* fatal error: out of memory */
+    }
+
+    /* Skip blank (and label-only) lines. */
+    if ( nbrOperands <= 0 )
+        return 0;
+
+    if ( nbrTokens > MAX_TOKENS )
+    {
+        reportError (DIAG_TOO_MANY_OPERANDS, line->lineNbr, NULL, 0);
+        return 1;
+    }
+    if ( (id = getOpType (operands[0].ptr, operands[0].len, &opType,
+                          &code, line->lineNbr)) < 0 )
+        return 1;
+
+    if ( parseOperands (id, operands + 1, nbrOperands - 1, line->lineNbr,
+                        table, instr) )
+        instr->id = id;
+    return 1;
+}
+
+static int scanLine (const LineView * line, TokenSpan tokens[],
+                     int * hasLabel)
+ /* Splits line, which comes without its comment (see parseLine), into
+  * tokens (storing at most MAX_TOKENS of them) and sets *hasLabel to 1
+  * if the first token is a label followed by its colon, or 0 if not.
+  * Returns the number of tokens on the line, or -1 if one of them is
+  * too long.
+  */
+{
+    const char * lineEnd = line->ptr + line->length;
+    int          nbrTokens;
+
+    *hasLabel = 0;
+    nbrTokens = scanTokens (line->ptr, line->length, tokens, MAX_TOKENS);
+    if ( nbrTokens > 0 && tokens[0].ptr + tokens[0].len < lineEnd &&
+         tokens[0].ptr[tokens[0].len] == ':' )
+        *hasLabel = 1;
+    return nbrTokens;
+}
+
+static void parallelPass1 (SourceFile * source, LabelTable * table,
+                           IRProgram * program, int nbrShards)
+ /* Works like pass1, with the source cut into nbrShards shards, each
+  * read on a thread of its own (see above).
+  */
+{
+    Shard        shards[nbrShards];
+    DiagnosticSink * sink = errorSink ();
+    const char * newline;
+    size_t       cut;
+    int *        remap;
+    int          line = 1;
+    int          PC = 0;
+    int          nbrLabels = 0;
+
+    /* Cut the source into shards of about the same size, each ending
+     * just after a newline (except the last).
+     */
+    for ( int i = 0; i < nbrShards; i++ )
+    {
+        shards[i].source = source;
+        shards[i].begin = i == 0 ? 0 : shards[i - 1].end;
+        cut = source->size / nbrShards * (i + 1);
+        if ( i == nbrShards - 1 || cut <= shards[i].begin )
+            cut = i == nbrShards - 1 ? source->size : shards[i].begin;
+        else if ( (newline = memchr (source->data + cut, '\n',
+                                     source->size - cut)) != NULL )
+            cut = newline + 1 - source->data;
+        else
+            cut = source->size;
+        shards[i].end = cut;
+        shards[i].limit = sink != NULL ? sink->limit : 0;
+    }
+
+    /* Step 1: count lines and instructions and find the labels. */
+    runShards (shards, nbrShards, countShard);
+
+    /* Step 2: add up the counts (including the labels, so that the
+     * table can be made big enough for them all at once).
+     */
+    for ( int i = 0; i < nbrShards; i++ )
+    {
+        shards[i].firstLine = line;
+        shards[i].firstPC = PC;
+        line += shards[i].nbrLines;
+        PC += shards[i].nbrInstrs * INSTRUCTION_SIZE;
+        nbrLabels += shards[i].nbrLabels;
+    }
+    if ( ! tableReserve (table, nbrLabels) )
+        for ( int i = 0; i < nbrShards; i++ )
+            shards[i].failed = 1;   /* fatal error: out of memory */
+
+    /* Step 3: parse the instructions. */
+    runShards (shards, nbrShards, parseShard);
+
+    /* Step 4: define the labels, report the errors in the order of
+     * their lines, and put the program together (until the errors reach
+     * the limit).
+     */
+    for ( int i = 0; i < nbrShards; i++ )
+    {
+        Shard *   shard = &shards[i];
+        long long start = statsClock ();
+
+        for ( int j = 0; j < shard->nbrLabels; j++ )
+        {
+            ShardLabel * label = &shard->labels[j];
+
+            diagForward (&shard->errors, label->errorMark);
+            if ( errorLimitReached () )
+                break;
+            printDebug ("parseLine: line %d: label %.*s at address %d\n",
+                        shard->firstLine + label->line - 1, label->length,
+                        label->name, shard->firstPC + label->PC);
+            if ( ! addLabelLen (table, label->name, label->length,
+                                shard->firstPC + label->PC,
+                                shard->firstLine + label->line - 1) )
+                shard->failed = 1;
+        }
+        statsTime (STAT_LABELS, start);
+        diagForward (&shard->errors, -1);
+        if ( errorLimitReached () )
+            ;                       /* too many errors: skip the rest */
+        else if ( shard->failed )
+        {
+            printError ("%s", ERROR0);
+            program->nbrErrors++;
+        }
+        else if ( (remap = arenaAlloc (&program->scratch,
+                                       (shard->refs.nbrLabels + 1) *
+                                       sizeof(int))) == NULL )
+            program->nbrErrors++;   /* (arenaAlloc printed the error) */
+        else
+        {
+            for ( int j = 0; j < shard->refs.nbrLabels; j++ )
+                remap[j] = referenceLabelLen (table,
+                                              tableEntry (&shard->refs, j)->label,
+                                              tableEntry (&shard->refs, j)->length);
+            for ( int j = 0; j < shard->program.nbrInstrs; j++ )
+            {
+                IRInstr * instr = &shard->program.instrs[j];
+
+                if ( instr->symbol >= 0 &&
+                     (instr->symbol = remap[instr->symbol]) < 0 )
+                    instr->id = IR_INVALID;     /* out of memory */
+                if ( ! irAppend (program, instr) )
+                {
+                    program->nbrErrors++;
+                    break;
+                }
+            }
+        }
+
+        free (shard->labels);
+        tableFree (&shard->refs);
+        irFree (&shard->program);
+        diagFree (&shard->errors);
+    }
+
+    /* Leave the source positioned at its end, as pass1 does. */
+    source->next = source->data + source->size;
+    source->lineNbr = line - 1;
+}
+
+static void runShards (Shard shards[], int nbrShards,
+                       void * (* step) (void *))
+ /* Runs step on every shard, each on a thread of its own (or on this
+  * thread, for any shard a thread could not be started for), and waits
+  * for them all to finish.
+  */
+{
+    pthread_t threads[nbrShards];
+    int       started[nbrShards];
+
+    for ( int i = 0; i < nbrShards; i++ )
+        started[i] = pthread_create (&threads[i], NULL, step, &shards[i]) == 0;
+    for ( int i = 0; i < nbrShards; i++ )
+        if ( started[i] )
+            (void) pthread_join (threads[i], NULL);
+        else
+            (void) step (&shards[i]);
+}
+
+static void * countShard (void * shardPtr)
+ /* Step 1 for one shard: counts its lines and instructions and collects
+  * its labels.
+  */
+{
+    Shard *      shard = shardPtr;
+    SourceFile   lines;
+    LineView     line;
+    TokenSpan    tokens[MAX_TOKENS];
+    ShardLabel * labels;
+    int          nbrTokens;
+    int          hasLabel;
+
+    shard->nbrInstrs = 0;
+    shard->labels = NULL;
+    shard->nbrLabels = 0;
+    shard->capacity = 0;
+    shard->failed = 0;
+
+    /* Only parseShard counts the skipped lines, the second time. */
+    sourceSlice (&lines, shard->source, shard->begin, shard->end, 1, 0);
+    while ( sourceNextCodeLine (&lines, &line) )
+    {
+        /* Exactly the lines that parseLine finds instructions on count. */
+        if ( (nbrTokens = scanLine (&line, tokens, &hasLabel)) < 0 )
+        {
+            shard->nbrInstrs++;
+            continue;
+        }
+
+        if ( hasLabel )
+        {
+            if ( shard->nbrLabels >= shard->capacity )
+            {
+                shard->capacity = shard->capacity > 0 ? 2 * shard->capacity
+                                                      : 64;
+                labels = realloc (shard->labels,
+                                  shard->capacity * sizeof(ShardLabel));
+                if ( labels == NULL )
+                {
+                    shard->failed = 1;
+                    break;
+                }
+                shard->labels = labels;
+            }
+            shard->labels[shard->nbrLabels].name = tokens[0].ptr;
+            shard->labels[shard->nbrLabels].length = tokens[0].len;
+            shard->labels[shard->nbrLabels].PC =
+                shard->nbrInstrs * INSTRUCTION_SIZE;
+            shard->labels[shard->nbrLabels].line = line.lineNbr;
+            shard->nbrLabels++;
+        }
+
+        if ( nbrTokens > hasLabel )
+            shard->nbrInstrs++;
+    }
+
+    shard->nbrLines = lines.lineNbr;
+    return NULL;
+}
+
+static void * parseShard (void * shardPtr)
+ /* Step 3 for one shard: parses its instructions, with its own table of
+  * the labels they refer to and its own sink for its errors, marking
+  * where its labels come in between them.  Stops if the errors reach
+  * the limit.
+  */
+{
+    Shard *      shard = shardPtr;
+    SourceFile   lines;
+    LineView     line;
+    IRInstr      instr;
+    int          PC = shard->firstPC;
+    int          nextLabel = 0;
+    int          found;
+    DiagnosticSink * previous;
+
+    tableInit (&shard->refs);
+    irInit (&shard->program);
+    diagInit (&shard->errors, NULL, shard->limit);
+    diagSetSource (&shard->errors, shard->source->data, shard->source->size);
+
+    previous = captureErrors (&shard->errors);
+    sourceSlice (&lines, shard->source, shard->begin, shard->end,
+                 shard->firstLine, 1);
+    while ( ! shard->failed && sourceNextCodeLine (&lines, &line) )
+    {
+        /* Mark where the label on this line (if any) gets defined. */
+        if ( nextLabel < shard->nbrLabels &&
+             shard->labels[nextLabel].line ==
+                line.lineNbr - shard->firstLine + 1 )
+            shard->labels[nextLabel++].errorMark = shard->errors.nbrEntries;
+
+        if ( (found = parseLine (&line, PC, &shard->refs, 0, &instr)) < 0 ||
+             (found > 0 && ! irAppend (&shard->program, &instr)) )
+        {
+            shard->failed = 1;
+            break;
+        }
+        if ( found )
+            PC += INSTRUCTION_SIZE;
+        if ( errorLimitReached () )
+            break;
+    }
+    (void) captureErrors (previous);
+
+    /* Any labels not reached (out of memory, or too many errors) come
+     * after all the errors.
+     */
+    while ( nextLabel < shard->nbrLabels )
+        shard->labels[nextLabel++].errorMark = shard->errors.nbrEntries;
+
+    return NULL;
+}
+
+static int labelsAreNew (LabelTable * table, const SymbolCache * cache,
+                         const CacheChunk * cached)
+ /* Returns 1 if none of the labels of the cached chunk is defined in
+  * the table yet (so adding them all cannot find a duplicate, whose
+  * line the cache does not know); 0 if not.
+  */
+{
+    for ( uint32_t i = 0; i < cached->nbrLabels; i++ )
+    {
+        const CacheLabel * old = &cache->labels[cached->firstLabel + i];
+
+        if ( findLabelLen (table, cache->names + old->name, old->length)
+             != UNDEFINED_ADDRESS )
+            return 0;
+    }
+    return 1;
+}
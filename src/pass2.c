@@ -0,0 +1,284 @@
+/*
+ * This file contains the pass2 function, the second pass of the
+ * assembler.  pass2 does not look at the source again: it runs through
+ * the intermediate representation built by pass1 (see IR.h) and
+ * encodes each valid instruction using the label table, which is
+ * complete by then (see encodeInstrs in assemble.c).  Invalid
+ * instructions were already reported by pass1; they are not encoded,
+ * but still take up their word of the output (as placeholders), as in
+ * onePass, so every word is at its instruction's address.
+ *
+ * Since encoding an instruction only depends on the instruction, its
+ * address, and the (no longer changing) label table, pass2 can encode
+ * a large program on several threads.  The program is cut into chunks
+ * of CHUNK_SIZE instructions, and each chunk is encoded into a slice of
+ * the output of its own (see outputSlice), which the chunk's
+ * instructions cannot overflow.  A small pool of threads hands out the
+ * chunks, next one first, until there are none left.  Afterwards the
+ * slices are moved together, in program order, so the output is the
+ * same as it would be with one thread.
+ *
+ * The threads never print anything.  A thread that comes to an
+ * instruction that cannot be encoded gives up on its chunk; once all
+ * the threads are done, the chunks that were given up on are encoded
+ * again, in order, on the main thread, which reports the errors in the
+ * same order as a sequential pass2 would.
+ *
+ * pass2Cached instead encodes a program that pass1Cached read with a
+ * symbol cache (see SymbolCache.h), on one thread.  The words of the
+ * chunks that were in the cache are copied from it, except for the
+ * branches whose targets are not as far away as they were and the
+ * jumps whose targets moved; only those and the instructions of the
+ * other chunks are encoded.
+ *
+ * The arrays a parallel pass2 shares out among its threads come from
+ * the program's scratch arena (see IR.h), and go when the program does.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Work arrays come from the scratch arena.
+ *   Modified:  10/14/2026   Invalid instructions take up their word.
+ *
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "assembler.h"
+#include "Instructions.h"
+
+static const int INSTRUCTION_SIZE = 4;		/* in bytes */
+
+/* The type of each instruction, indexed by opcode id. */
+#define INSTR(name, form, code, ...)  FORM_TYPE_##form,
+static const char OP_TYPE[NBR_OPCODES] = { MIPS_INSTRUCTIONS };
+#undef INSTR
+
+/* Instructions in each chunk handed to a thread. */
+static const int CHUNK_SIZE = 16 * 1024;
+
+/* The work shared by the threads of a parallel pass2. */
+typedef struct {
+        const IRProgram * program;
+        LabelTable *      table;
+        OutputSink *      out;
+        long              base;         /* first word for the program */
+        int               nbrChunks;
+        atomic_int        nextChunk;    /* next chunk nobody has taken */
+        OutputSink *      slices;       /* output of each chunk */
+        int *             failed;       /* nonzero if a chunk failed */
+} Pass2Work;
+
+// internal functions (visible to this file only)
+static int parallelPass2 (IRProgram * program, LabelTable * table,
+                          OutputSink * out, int nbrThreads);
+static void * encodeChunks (void * work);
+static void encodeChunk (Pass2Work * work, int chunk, int report);
+static int sameWord (const IRInstr * instr, int PC, const IRInstr * old,
+                     int oldPC, LabelTable * table, const SymbolCache * cache);
+
+/**
+ * pass2 -- encode a program
+ * Parameters:  program -- the instructions parsed by pass1 (only its
+ *                  scratch arena is changed)
+ *              table -- the label table built by pass1
+ *              out -- where the encoded instructions go
+ *              nbrThreads -- the number of threads to encode on
+ * Postcondition:
+ *              Every valid instruction in program whose target (if it
+ *              has one) is defined and in range has been encoded and
+ *              added to out, in order, and a placeholder for every
+ *              other instruction (see encodeInstrs); every other valid
+ *              one has been reported as an error, in order, until the
+ *              errors reached their limit (see errorLimitReached), if
+ *              they did.
+ * Returns the number of valid instructions that could not be encoded.
+ */
+int pass2 (IRProgram * program, LabelTable table, OutputSink * out,
+           int nbrThreads)
+{
+    /* Not worth starting threads for fewer than two chunks. */
+    if ( nbrThreads > 1 && program->nbrInstrs > CHUNK_SIZE )
+        return parallelPass2 (program, &table, out, nbrThreads);
+
+    return encodeInstrs (program->instrs, program->nbrInstrs, 0, &table,
+                         out, 1);
+}
+
+/**
+ * pass2Cached -- encode a program, reusing the machine code in a cache
+ * Parameters:  program, table, out -- as for pass2
+ *              cache -- the symbol cache pass1Cached built program with
+ * Postcondition and return value: the same as for pass2.
+ */
+int pass2Cached (const IRProgram * program, LabelTable * table,
+                 OutputSink * out, SymbolCache * cache)
+{
+    const CacheChunk * chunk;
+    const CacheChunk * cached;
+    const IRInstr *    old;
+    int                first = 0;       /* first instruction of chunk */
+    int                nbrEncoded = 0;
+    int                nbrErrors = 0;
+
+    for ( int c = 0; c < cache->nbrNewChunks; c++, first += chunk->nbrInstrs )
+    {
+        chunk = &cache->newChunks[c];
+        if ( (cached = cacheFindChunk (cache, chunk->hash, chunk->size)) ==
+             NULL )
+        {
+            nbrErrors += encodeInstrs (program->instrs + first,
+                                       chunk->nbrInstrs,
+                                       first * INSTRUCTION_SIZE, table, out,
+                                       1);
+            nbrEncoded += chunk->nbrInstrs;
+        }
+        else
+        {
+            old = cache->instrs + cached->firstInstr;
+            for ( uint32_t i = 0; i < chunk->nbrInstrs; i++ )
+                if ( sameWord (&program->instrs[first + i],
+                               (first + i) * INSTRUCTION_SIZE, &old[i],
+                               (cached->firstInstr + i) * INSTRUCTION_SIZE,
+                               table, cache) )
+                    outputWord (out, cache->words[cached->firstInstr + i]);
+                else
+                {
+                    nbrErrors += encodeInstrs (program->instrs + first + i, 1,
+                                               (first + i) * INSTRUCTION_SIZE,
+                                               table, out, 1);
+                    nbrEncoded++;
+                }
+        }
+        if ( errorLimitReached () )
+            break;                  /* too many errors: stop */
+    }
+
+    printDebug ("pass2Cached: %d of %d instructions were encoded\n",
+                nbrEncoded, program->nbrInstrs);
+    return nbrErrors;
+}
+
+static int parallelPass2 (IRProgram * program, LabelTable * table,
+                          OutputSink * out, int nbrThreads)
+ /* Works like pass2, with nbrThreads threads (see above).  Falls back
+  * on encoding the program on the calling thread if there is not
+  * enough memory for the chunks (after arenaAlloc has said so) or if no
+  * thread can be started.
+  */
+{
+    Pass2Work   work;
+    pthread_t * threads;
+    int         nbrStarted = 0;
+    int         nbrErrors = 0;
+    long        next;
+
+    if ( ! outputReserve (out, out->nbrWords + program->nbrInstrs) )
+        return encodeInstrs (program->instrs, program->nbrInstrs, 0, table,
+                             out, 1);
+
+    work.program = program;
+    work.table = table;
+    work.out = out;
+    work.base = out->nbrWords;
+    work.nbrChunks = (program->nbrInstrs + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    atomic_init (&work.nextChunk, 0);
+    if ( nbrThreads > work.nbrChunks )
+        nbrThreads = work.nbrChunks;
+    work.slices = arenaAlloc (&program->scratch,
+                              work.nbrChunks * sizeof(OutputSink));
+    work.failed = arenaAlloc (&program->scratch,
+                              work.nbrChunks * sizeof(int));
+    threads = arenaAlloc (&program->scratch, nbrThreads * sizeof(pthread_t));
+
+    if ( work.slices != NULL && work.failed != NULL && threads != NULL )
+    {
+        (void) memset (work.failed, 0, work.nbrChunks * sizeof(int));
+        for ( ; nbrStarted < nbrThreads; nbrStarted++ )
+            if ( pthread_create (&threads[nbrStarted], NULL, encodeChunks,
+                                 &work) != 0 )
+                break;
+    }
+    if ( nbrStarted == 0 )
+        return encodeInstrs (program->instrs, program->nbrInstrs, 0, table,
+                             out, 1);
+    for ( int i = 0; i < nbrStarted; i++ )
+        (void) pthread_join (threads[i], NULL);
+
+    /* Move the slices together, in order.  Each slice starts at or after
+     * the end of the words moved so far, so redoing a chunk that failed
+     * (in its own slice) cannot overwrite anything still needed.
+     */
+    next = work.base;
+    for ( int chunk = 0; chunk < work.nbrChunks; chunk++ )
+    {
+        if ( work.failed[chunk] )
+            encodeChunk (&work, chunk, 1);
+        nbrErrors += work.failed[chunk];
+        (void) memmove (out->words + next, work.slices[chunk].words,
+                        work.slices[chunk].nbrWords * sizeof(uint32_t));
+        next += work.slices[chunk].nbrWords;
+        if ( errorLimitReached () )
+            break;                  /* too many errors: stop */
+    }
+    out->nbrWords = next;
+    return nbrErrors;
+}
+
+static void * encodeChunks (void * work)
+ /* The body of each thread: encodes chunks, without reporting errors,
+  * until there are none left.
+  */
+{
+    Pass2Work * shared = work;
+    int         chunk;
+
+    while ( (chunk = atomic_fetch_add (&shared->nextChunk, 1))
+            < shared->nbrChunks )
+        encodeChunk (shared, chunk, 0);
+
+    return NULL;
+}
+
+static void encodeChunk (Pass2Work * work, int chunk, int report)
+ /* Encodes the given chunk into its slice of the output (starting the
+  * slice over).  If report is 0, stops at the first instruction that
+  * cannot be encoded and marks the chunk as failed; otherwise reports
+  * every such instruction and records their number in work->failed.
+  */
+{
+    int first = chunk * CHUNK_SIZE;
+    int count = work->program->nbrInstrs - first;
+    int nbrErrors;
+
+    if ( count > CHUNK_SIZE )
+        count = CHUNK_SIZE;
+    outputSlice (&work->slices[chunk], work->out, work->base + first, count);
+
+    nbrErrors = encodeInstrs (work->program->instrs + first, count,
+                              first * INSTRUCTION_SIZE, work->table,
+                              &work->slices[chunk], report);
+    work->failed[chunk] = nbrErrors > 0 ? (report ? nbrErrors : 1) : 0;
+}
+
+static int sameWord (const IRInstr * instr, int PC, const IRInstr * old,
+                     int oldPC, LabelTable * table, const SymbolCache * cache)
+ /* Returns 1 if instr, at address PC, encodes into the same word as the
+  * cached instruction old (the same instruction) did at address oldPC:
+  * if it has no target, or its target is as far away as it was (for a
+  * branch) or where it was (for a jump); 0 otherwise.
+  */
+{
+    int target;
+    int oldTarget;
+
+    if ( old->symbol < 0 )
+        return 1;
+
+    target = tableEntry (table, instr->symbol)->address;
+    oldTarget = cache->targets[old->symbol].PC;
+    if ( target == UNDEFINED_ADDRESS )
+        return 0;
+    if ( OP_TYPE[instr->id] == 'I' )
+        return target - PC == oldTarget - oldPC;
+    return target == oldTarget;
+}
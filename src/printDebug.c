@@ -12,7 +12,14 @@
  *                      debugging state in its current state
  *
  * The file also defines a number of internal data values and helper
- * functions to support the six functions described above.
+ * functions to support the six functions described above.  They are
+ * all thread-local: each thread has a debugging state (and stack) of
+ * its own, so threads assembling different programs at once cannot
+ * turn debugging on or off for each other.
+ *
+ * printDebug and debug_is_on are macros when NDEBUG is defined (see
+ * printFuncs.h), so their names are parenthesized below: the functions
+ * are still defined, for files compiled without NDEBUG.
  */
 
 #include <stdarg.h>
@@ -23,14 +30,14 @@
 
 /* Define the internal DEBUG variable shared by functions in this file. */
 static const char DEBUG_DEFAULT_VALUE = 0;
-static char OVERRIDE_DEBUG_CHANGES = 0;
-static char DEBUG = 0;  /* Can set to 0 if compiler does not
+static _Thread_local char OVERRIDE_DEBUG_CHANGES = 0;
+static _Thread_local char DEBUG = 0;  /* Can set to 0 if compiler does not
                                              like DEBUG_DEFAULT_VALUE */
 
 /* Define the internal DEBUG stack and the functions that operate on it. */
-static char * debugStack = NULL;
-static unsigned debugStackCapacity = 0;
-static unsigned debugStackNumEntries = 0;
+static _Thread_local char * debugStack = NULL;
+static _Thread_local unsigned debugStackCapacity = 0;
+static _Thread_local unsigned debugStackNumEntries = 0;
 static void debug_push();
 static char debug_pop();
 static int resizeDebugStack ();
@@ -54,7 +61,7 @@ static const char * ERROR = "Error: cannot allocate space in memory.\n";
  *  This function prints its output to standard output (stdout).
  *
  */
-void printDebug(const char * restrict_format, ...)
+void (printDebug)(const char * restrict_format, ...)
 {
     if ( ! DEBUG )
         return;
@@ -116,15 +123,13 @@ void debug_restore()
     }
 }
 
-int  debug_is_on();
-
 /**
  * int debug_is_on()
  *
  * Returns 1 if debugging is currently on, 0 if debugging is currently off.
  *
  */
-int debug_is_on()
+int (debug_is_on)()
 {
     return DEBUG;
 }
@@ -149,8 +154,10 @@ void override_debug_changes()
  */
 static void debug_push()
 {
-    if ( debugStack == NULL || debugStackNumEntries <= debugStackCapacity )
-        resizeDebugStack();
+    /* Only grow the stack once it is full. */
+    if ( debugStack == NULL || debugStackNumEntries >= debugStackCapacity )
+        if ( ! resizeDebugStack() )
+            return;             /* fatal error: the state is not saved */
 
     debugStack[debugStackNumEntries++] = DEBUG;
 }
@@ -1,7 +1,9 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "printFuncs.h"
+#include "Diagnostics.h"
 
 /** Define the global ERROR_LIMIT variable. **/
 int ERROR_LIMIT = 20;
@@ -18,7 +20,10 @@ int ERROR_LIMIT = 20;
  * will cause the program to exit.  If the error limit is less than or
  * equal to 0, the program will disregard it, allowing the program to
  * continue (and continue to generate error messages) until it stops on
- * its own.
+ * its own.  Each thread counts its own error messages.  If the
+ * calling thread has a diagnostic sink (see captureErrors in
+ * Diagnostics.h), the message is recorded in the sink instead, and
+ * counts towards the sink's limit rather than ERROR_LIMIT.
  *
  * Parameters:
  *  The parameters to printError are modeled on those to printf,
@@ -31,13 +36,18 @@ int ERROR_LIMIT = 20;
  */
 void printError(const char * restrict_format, ...)
 {
-    static int error_count = 0;
+    static _Thread_local int error_count = 0;
 
     /* The following code allows us to call fprintf with the variable
      * parameters that were passed to printError.
      */
     va_list ap;
     va_start(ap, restrict_format);
+    if ( reportMessage(restrict_format, ap) )
+    {
+        va_end(ap);
+        return;
+    }
     (void) vfprintf(stderr, restrict_format, ap);
     va_end(ap);
 
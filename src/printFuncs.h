@@ -10,7 +10,11 @@
  *
  * ERROR_LIMIT is a global variable that can be set to a different value
  *      to change the number of errors that get printed before the
- *      programs stops execution.
+ *      programs stops execution.  The errors are counted separately on
+ *      each thread.
+ *
+ * A thread can have its error messages go to a diagnostic sink rather
+ *      than to stderr; see captureErrors in Diagnostics.h.
  *
  * printDebug will print a debugging message to stdout, but only if
  *      debugging has been turned on.
@@ -42,6 +46,16 @@
  * override_debug_changes "freezes" the debugging state in its current
  *      state, whether on or off, nulling the effect of any future calls
  *      to debug_on, debug_off, or debug_restore.
+ *
+ * Each thread has a debugging state of its own (off, to begin with), so
+ *      the functions above only affect the thread that calls them.
+ *
+ * If NDEBUG is defined when a file is compiled (make CFLAGS=-DNDEBUG),
+ *      the debugging messages in it are compiled out: printDebug
+ *      expands to nothing, without evaluating its arguments, and
+ *      debug_is_on is the constant 0, so code that only runs when
+ *      debugging is on is dropped as well.  The other functions still
+ *      exist, but no longer have any visible effect in that file.
  */
 
 void printError(const char * restrict_format, ...);
@@ -56,4 +70,9 @@ void debug_restore();
 int  debug_is_on();
 void override_debug_changes();
 
+#ifdef NDEBUG
+#define printDebug(...)         ((void) 0)
+#define debug_is_on()           0
+#endif
+
 #endif
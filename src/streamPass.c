@@ -0,0 +1,119 @@
+/*
+ * This file contains the streamPass function, which assembles a program
+ * in a single pass as it is read, line by line, from a stream of any
+ * length (see LineStream.h), such as a pipe into the standard input.
+ * Like onePass, it parses (see parseLine in pass1.c) and encodes (see
+ * encodeInstr in assemble.c) each instruction as soon as it has read
+ * its line, and records a fixup for each branch or jump to a label that
+ * has not been defined yet (see Fixups.h).  Unlike onePass, it does not
+ * wait for the end of the program to patch them, or to write out the
+ * machine code: every RELEASE_INTERVAL words, the fixups whose labels
+ * have been defined by then are patched, and the words no fixup still
+ * needs are written out and dropped from memory (see releaseOutput).
+ * What is in memory at any time is then the label table, the fixups
+ * still waiting for their labels, and at most RELEASE_INTERVAL words
+ * (or, if the output cannot be patched after it has been written, as
+ * to a pipe, the words since the oldest of those fixups), however long
+ * the program is.
+ *
+ * Since the line being assembled is only in memory until the next one
+ * is read, the characters of any error about it are copied into the
+ * errors (see diagKeepArgs in Diagnostics.h) before it goes away.
+ *
+ * Creation Date:   10/14/2026
+ *   Modified:  10/14/2026   Invalid instructions take up their word.
+ *
+ */
+
+#include "assembler.h"
+#include "LineStream.h"
+
+static const int INSTRUCTION_SIZE = 4;		/* in bytes */
+
+/* Words added between patching fixups and writing out the output. */
+static const long RELEASE_INTERVAL = 16 * 1024;
+
+/**
+ * streamPass -- build the label table for a stream and encode it
+ * Parameters:  stream -- an open line stream, positioned at its first
+ *                  line
+ *              table -- an empty label table
+ *              fixups -- an empty list, for the forward references
+ *              out -- where the encoded instructions go
+ * Postcondition:
+ *              The table holds every label that appears at the
+ *              beginning of a line in the stream, with its address, as
+ *              well as any undefined labels that were referenced.
+ *              Every valid instruction in the stream has been encoded
+ *              and added to out, and every other one added as a
+ *              placeholder (see encodeInstr; out may have written out
+ *              and dropped any of them, as outputRelease does); every
+ *              invalid one, duplicate label, and reference to an
+ *              undefined label has been reported as an error, until the
+ *              errors reached their limit (see errorLimitReached), if
+ *              they did; the rest of the stream is then not read.
+ *              Otherwise the stream has been read to its end.
+ * Returns the number of errors.
+ */
+int streamPass (LineStream * stream, LabelTable * table, FixupList * fixups,
+                OutputSink * out)
+{
+    DiagnosticSink * sink = errorSink ();
+    LineView         line;
+    IRInstr          instr;
+    int              PC = 0;
+    int              nbrErrors = 0;
+    int              mark = 0;
+    int              found;
+    long             nextRelease = RELEASE_INTERVAL;
+
+    while ( streamNextCodeLine (stream, &line) )
+    {
+        /* Errors about the line get their column while it is here. */
+        if ( sink != NULL )
+        {
+            diagSetSource (sink, line.ptr, line.length);
+            mark = sink->nbrEntries;
+        }
+
+        if ( (found = parseLine (&line, PC, table, 1, &instr)) > 0 )
+        {
+            if ( ! encodeInstr (&instr, PC, table, fixups, out) )
+                nbrErrors++;
+            PC += INSTRUCTION_SIZE;
+        }
+
+        /* (The sink may have been flushed since mark, if it was full.) */
+        if ( sink != NULL )
+            diagKeepArgs (sink, mark <= sink->nbrEntries ? mark : 0);
+        if ( found < 0 )
+        {
+            nbrErrors++;
+            break;                  /* fatal error: out of memory */
+        }
+        if ( errorLimitReached () )
+            break;                  /* too many errors: stop */
+
+        /* Now and then, patch what can be and write out the words. */
+        if ( out->nbrWords >= nextRelease )
+        {
+            nbrErrors += resolveFixups (fixups, table, out);
+            if ( ! releaseOutput (fixups, out) )
+                nbrErrors++;
+            nextRelease = out->nbrWords + RELEASE_INTERVAL;
+        }
+    }
+    if ( sink != NULL )
+        diagSetSource (sink, NULL, 0);
+    if ( stream->failed )
+        nbrErrors++;
+    if ( errorLimitReached () )
+        return nbrErrors;
+
+    /* Now that every label is defined, patch the forward references. */
+    printDebug ("streamPass: %d forward references, %ld words written\n",
+                fixups->nbrFixups, out->nbrDropped);
+    nbrErrors += applyFixups (fixups, table, out);
+
+    return nbrErrors;
+}
@@ -0,0 +1,297 @@
+/*
+ * This is a driver to test assembling a batch of source files on a pool
+ * of worker threads (see Batch.h).  It writes a few programs to a new
+ * directory -- one without errors, one with errors, one with more than
+ * the error limit, and one with nothing but comments -- and a manifest
+ * that names them, with comments, blank lines, and spaces around the
+ * names, and a file that does not exist.  It assembles them on more
+ * threads than there are jobs, and checks the output file, the number
+ * of errors, and whether the error limit stopped it, of each job, and
+ * the report batchRun's caller prints; and then assembles many more
+ * programs, on fewer threads, which have to steal jobs from each other,
+ * and checks each of them.  Each check prints "OK" or "FAILED"; the
+ * program returns 1 if any check failed.
+ *
+ * USAGE:
+ *      name [ 0|1 ]
+ * where "name" is the name of the executable and "0" or "1" specifies
+ * that debugging should be turned off or on, respectively.  When
+ * debugging is on, the report is printed.
+ *
+ * ERROR CONDITIONS:
+ * None should be printed: the errors in the test programs are all kept
+ * in the jobs.
+ */
+
+#include <limits.h>
+#include <unistd.h>
+
+#include "assembler.h"
+#include "Batch.h"
+
+extern int ERROR_LIMIT;         /* see printError.c */
+
+/* The first batch runs on NBR_THREADS threads, more than its jobs; the
+ * second one has NBR_MANY jobs, on NBR_STEALERS threads.
+ */
+#define NBR_THREADS 16
+#define NBR_MANY 200
+#define NBR_STEALERS 4
+
+static const char * GOOD_PROGRAM =
+        "main:   addi $t0, $zero, 5     # a comment\n"
+        "        add  $t0, $t1, $t2\n"
+        "loop:   beq  $t0, $t1, main\n"
+        "        j    done\n"
+        "done:   jr   $ra\n";
+
+static const uint32_t GOOD_WORDS[] =
+        { 0x20080005, 0x012a4020, 0x1109fffd, 0x08000004, 0x03e00008 };
+
+/* Its instructions in error still take up their (placeholder) words. */
+static const char * BAD_PROGRAM =
+        "        add  $t0, $t1, $t2\n"
+        "        bogus $t0\n"
+        "        add  $t0, $t1, $zz\n"
+        "done:   jr   $ra\n";
+
+static const uint32_t BAD_WORDS[] =
+        { 0x012a4020, 0, 0, 0x03e00008 };
+
+static const char * COMMENT_PROGRAM = "# nothing but a comment\n\n";
+
+/* The jobs of the first batch, in order. */
+enum { GOOD, BAD, STOPPED, MISSING, COMMENT, NBR_JOBS };
+
+static const char * NAMES[NBR_JOBS] =
+        { "good.mips", "bad.mips", "stopped.mips", "missing.mips",
+          "comment.mips" };
+
+static int failures = 0;
+
+static void check (int condition, const char * description)
+{
+    printf ("%-50s %s\n", description, condition ? "OK" : "FAILED");
+    if ( ! condition )
+        failures++;
+}
+
+static int writeFile (const char * path, const char * text)
+ /* Returns 1 if path could be written with text; 0 if not. */
+{
+    FILE * file = fopen (path, "w");
+    int    ok;
+
+    if ( file == NULL )
+        return 0;
+    ok = fputs (text, file) >= 0;
+    return fclose (file) == 0 && ok;
+}
+
+static char * readFile (const char * path, long * size)
+ /* Returns (in newly allocated memory, null-terminated) what path holds,
+  * and sets *size to its length; returns NULL if it cannot be read.
+  */
+{
+    FILE * file = fopen (path, "r");
+    char * text;
+
+    if ( file == NULL )
+        return NULL;
+    (void) fseek (file, 0, SEEK_END);
+    *size = ftell (file);
+    rewind (file);
+    if ( (text = malloc (*size + 1)) != NULL &&
+         fread (text, 1, *size, file) != (size_t) *size )
+    {
+        free (text);
+        text = NULL;
+    }
+    if ( text != NULL )
+        text[*size] = '\0';
+    (void) fclose (file);
+    return text;
+}
+
+static int holdsWords (const char * path, const uint32_t words[], int n)
+ /* Returns 1 if path holds exactly the n words, most significant byte
+  * first; 0 if not.
+  */
+{
+    long            size;
+    unsigned char * bytes = (unsigned char *) readFile (path, &size);
+    int             same = bytes != NULL && size == 4L * n;
+
+    for ( int i = 0; same && i < n; i++ )
+        same = ((uint32_t) bytes[4 * i] << 24 |
+                (uint32_t) bytes[4 * i + 1] << 16 |
+                (uint32_t) bytes[4 * i + 2] << 8 | bytes[4 * i + 3])
+               == words[i];
+    free (bytes);
+    return same;
+}
+
+static int inOrder (const char * report, const char * lines[], int n)
+ /* Returns 1 if the n lines are all in report (each one, whole, after
+  * the one before it); 0 if not.
+  */
+{
+    const char * next = report;
+
+    for ( int i = 0; i < n; i++ )
+    {
+        const char * found = strstr (next, lines[i]);
+
+        if ( found == NULL || (found != report && found[-1] != '\n') )
+            return 0;
+        next = found + strlen (lines[i]);
+    }
+    return 1;
+}
+
+int main (int argc, char * argv[])
+{
+    char         dir[] = "/tmp/testBatchXXXXXX";
+    char         paths[NBR_JOBS][PATH_MAX];
+    char         manifest[PATH_MAX];
+    char         text[6 * PATH_MAX];
+    char         lines[5][PATH_MAX + 100];
+    const char * expected[5];
+    char         name[PATH_MAX];
+    char *       stopped;
+    char *       report;
+    long         size;
+    Batch        batch;
+    FILE *       stream;
+    int          ok;
+
+    if ( argc > 1 && strcmp(argv[1], "0") == SAME )
+    {
+        debug_off();  override_debug_changes();
+    }
+    else if ( argc > 1 && strcmp(argv[1], "1") == SAME )
+    {
+        debug_on();  override_debug_changes();
+    }
+
+    if ( mkdtemp (dir) == NULL )
+    {
+        check (0, "made a directory for the batch");
+        return 1;
+    }
+
+    /* The programs (but for the missing one) and the manifest. */
+    for ( int i = 0; i < NBR_JOBS; i++ )
+        sprintf (paths[i], "%s/%s", dir, NAMES[i]);
+    stopped = malloc (ERROR_LIMIT * 20 + 100);
+    stopped[0] = '\0';
+    for ( int i = 0; i <= ERROR_LIMIT; i++ )
+        strcat (stopped, "        bogus $t0\n");
+    ok = writeFile (paths[GOOD], GOOD_PROGRAM) &&
+         writeFile (paths[BAD], BAD_PROGRAM) &&
+         writeFile (paths[STOPPED], stopped) &&
+         writeFile (paths[COMMENT], COMMENT_PROGRAM);
+    free (stopped);
+    sprintf (manifest, "%s/batch.list", dir);
+    sprintf (text, "# the test batch\n\n  %s  \n\t%s\n# %s/skipped.mips\n"
+             "%s\n%s\n", paths[GOOD], paths[BAD], dir, paths[STOPPED],
+             paths[MISSING]);
+    ok &= writeFile (manifest, text);
+    check (ok, "wrote the programs and the manifest");
+
+    /* The first batch, on more threads than there are jobs. */
+    batchInit (&batch, OUTPUT_BINARY_BE, NBR_THREADS);
+    check (batchAddManifest (&batch, manifest) &&
+           batchAdd (&batch, paths[COMMENT]) && batch.nbrJobs == NBR_JOBS,
+           "a job for each name in the manifest, and one more");
+    ok = 1;
+    for ( int i = 0; i < batch.nbrJobs; i++ )
+        ok &= strcmp (batch.jobs[i].input, paths[i]) == SAME;
+    check (ok, "...in order, without the spaces around them");
+    check (batchRun (&batch) == 3, "3 files with errors");
+
+    check (batch.jobs[GOOD].nbrErrors == 0 && ! batch.jobs[GOOD].stopped &&
+           holdsWords (batch.jobs[GOOD].output, GOOD_WORDS, 5),
+           "good program: no errors, and its words");
+    check (batch.jobs[BAD].nbrErrors == 2 && ! batch.jobs[BAD].stopped &&
+           holdsWords (batch.jobs[BAD].output, BAD_WORDS, 4),
+           "program with errors: 2, and their words");
+    check (batch.jobs[STOPPED].nbrErrors == ERROR_LIMIT &&
+           batch.jobs[STOPPED].stopped &&
+           holdsWords (batch.jobs[STOPPED].output, NULL, 0),
+           "stopped program: the limit, and an empty file");
+    check (batch.jobs[MISSING].nbrErrors == 1 &&
+           ! batch.jobs[MISSING].stopped &&
+           access (batch.jobs[MISSING].output, F_OK) != 0,
+           "missing program: 1 error, and no file");
+    check (batch.jobs[COMMENT].nbrErrors == 0 &&
+           holdsWords (batch.jobs[COMMENT].output, NULL, 0),
+           "program with only comments: an empty file");
+
+    /* The report, file by file, in the order of the jobs. */
+    report = NULL;
+    if ( (stream = tmpfile ()) != NULL )
+    {
+        batchReport (&batch, stream);
+        size = ftell (stream);
+        rewind (stream);
+        if ( (report = malloc (size + 1)) != NULL )
+        {
+            report[fread (report, 1, size, stream)] = '\0';
+            printDebug ("%s", report);
+        }
+        (void) fclose (stream);
+    }
+    sprintf (lines[0], "%s: Error on line 2: unknown instruction bogus.\n",
+             paths[BAD]);
+    sprintf (lines[1], "%s: 2 errors\n", paths[BAD]);
+    sprintf (lines[2], "%s: %d errors (stopped at the error limit)\n",
+             paths[STOPPED], ERROR_LIMIT);
+    sprintf (lines[3], "%s: 1 error\n", paths[MISSING]);
+    sprintf (lines[4], "%d files assembled, 3 with errors\n", NBR_JOBS);
+    for ( int i = 0; i < 5; i++ )
+        expected[i] = lines[i];
+    check (report != NULL && inOrder (report, expected, 5) &&
+           strstr (report, lines[4])[strlen (lines[4])] == '\0',
+           "report: errors, counts, and the summary last");
+    check (report != NULL && strstr (report, paths[GOOD]) == NULL &&
+           strstr (report, paths[COMMENT]) == NULL,
+           "report: nothing about the files without errors");
+    free (report);
+    for ( int i = 0; i < batch.nbrJobs; i++ )
+        (void) unlink (batch.jobs[i].output);
+    batchFree (&batch);
+
+    /* Many more jobs than threads, every other one with errors. */
+    batchInit (&batch, OUTPUT_BINARY_BE, NBR_STEALERS);
+    ok = 1;
+    for ( int i = 0; ok && i < NBR_MANY; i++ )
+    {
+        sprintf (name, "%s/p%03d.mips", dir, i);
+        ok = writeFile (name, i % 2 == 0 ? GOOD_PROGRAM : BAD_PROGRAM) &&
+             batchAdd (&batch, name);
+    }
+    check (ok && batchRun (&batch) == NBR_MANY / 2,
+           "many jobs: half of them with errors");
+    ok = 1;
+    for ( int i = 0; i < batch.nbrJobs; i++ )
+    {
+        const BatchJob * job = &batch.jobs[i];
+
+        ok &= i % 2 == 0 ? job->nbrErrors == 0 &&
+                           holdsWords (job->output, GOOD_WORDS, 5)
+                         : job->nbrErrors == 2 &&
+                           holdsWords (job->output, BAD_WORDS, 4);
+        (void) unlink (job->input);
+        (void) unlink (job->output);
+    }
+    check (ok, "many jobs: each with its errors and words");
+    batchFree (&batch);
+
+    for ( int i = 0; i < NBR_JOBS; i++ )
+        (void) unlink (paths[i]);
+    (void) unlink (manifest);
+    (void) rmdir (dir);
+
+    return failures > 0;
+}
@@ -0,0 +1,476 @@
+/*
+ * This is a driver to test re-assembling a program with a symbol cache
+ * (see SymbolCache.h).  It assembles a program of a few thousand lines
+ * with a cache file, the way the assembler's -c option does, and then
+ * assembles it again after each of these, starting from the cache of
+ * the original program each time:
+ *      an edited line;
+ *      a chunk of lines inserted in the middle, with labels of its own;
+ *      a chunk of lines deleted, which moves every later label;
+ *      a cache file that is truncated, or damaged in its header, its
+ *      chunk records, its label records, or its instruction records.
+ * Each time, the output file must be byte for byte the same as the one
+ * a run without the cache writes, and the cache must have been used
+ * when it was not damaged (and ignored when it was).
+ *
+ * It then tests writing only the words that changed into the output
+ * file the last run wrote (see outputSetPrevious): when the output
+ * grows, when it shrinks, when the file was modified or deleted since,
+ * and when the cache's header describes another file, or the right one
+ * with the wrong number of words or the wrong mode.  And it streams a
+ * program whose forward references are patched into words already
+ * written to the file (see outputPatch).  Each time, the file must be
+ * the same as one written in full.  Each check prints "OK" or "FAILED";
+ * the program returns 1 if any check failed.
+ *
+ * USAGE:
+ *      name [ 0|1 ]
+ * where "name" is the name of the executable and "0" or "1" specifies
+ * that debugging should be turned off or on, respectively.
+ *
+ * ERROR CONDITIONS:
+ * None should be printed: all of the programs assemble.  The files are
+ * written to a directory of their own under /tmp, which is removed at
+ * the end.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "assembler.h"
+#include "Instructions.h"
+
+/* The lines of the original program, the lines deleted from it, and
+ * where and how many lines are inserted into it.
+ */
+#define NBR_LINES 3000
+#define DELETE_FROM 410         /* (no label after 400 is referred to */
+#define DELETE_TO 590           /* before 600) */
+#define INSERT_AT 1500
+#define NBR_INSERTED 150
+#define EDITED_LINE 1001
+
+/* The streamed program: a jump over more words than streamPass keeps. */
+#define NBR_JUMPED 40000
+
+/* A change to the original program (see makeProgram). */
+typedef struct {
+        int edited;             /* line given another instruction, or -1 */
+        int deleteFrom;         /* lines deleted (none if equal) */
+        int deleteTo;
+        int insertAt;           /* line lines are inserted before, or -1 */
+} Change;
+
+static const Change ORIGINAL = { -1, 0, 0, -1 };
+
+static char directory[] = "/tmp/testCacheXXXXXX";
+static char cacheName[64];
+static char cachedName[64];     /* output of the runs with the cache */
+static char fullName[64];       /* output of the runs without it */
+static char sourceName[64];     /* the streamed program */
+
+/* What the last run with the cache did. */
+static int lastReused;          /* nbr of chunks found in the cache */
+static int lastPatched;         /* 1 if only changed words were to be
+                                 * written to the output file */
+
+static int failures = 0;
+
+static void check (int condition, const char * description)
+{
+    printf ("%-50s %s\n", description, condition ? "OK" : "FAILED");
+    if ( ! condition )
+        failures++;
+}
+
+static char * makeProgram (Change change)
+ /* Returns (in newly allocated memory) the original program, changed as
+  * described by change.  Every tenth line has a label; the branches and
+  * jumps only go to every twentieth label, and some lines end with a
+  * comment.
+  */
+{
+    char * text = malloc ((NBR_LINES + NBR_INSERTED) * 64);
+    char * next = text;
+
+    for ( int i = 0; i < NBR_LINES; i++ )
+    {
+        if ( i == change.insertAt )
+            for ( int k = 0; k < NBR_INSERTED; k++ )
+            {
+                if ( k % 10 == 0 )
+                    next += sprintf (next, "X%d: ", k);
+                next += sprintf (next, "sub $t0, $t0, $t%d\n", k % 8);
+            }
+        if ( i >= change.deleteFrom && i < change.deleteTo )
+            continue;
+
+        if ( i % 10 == 0 )
+            next += sprintf (next, "L%d: ", i);
+        if ( i == change.edited )
+            next += sprintf (next, "ori $t3, $t3, 0x1234\n");
+        else if ( i % 4 == 0 )
+            next += sprintf (next, "addi $t0, $t1, %d\n", i % 1000);
+        else if ( i % 4 == 1 )
+            next += sprintf (next, "beq $t0, $t1, L%d    # branch\n",
+                             (i * 37) % NBR_LINES / 200 * 200);
+        else if ( i % 4 == 2 )
+            next += sprintf (next, "add $t2, $t0, $t1\n");
+        else
+            next += sprintf (next, "j L%d\n",
+                             (i * 53) % NBR_LINES / 200 * 200);
+    }
+    return text;
+}
+
+static int run (const char * program, const char * cacheFile,
+                const char * outName)
+ /* Assembles program (in binary) into the named output file the way the
+  * assembler does: with a cache file, the output is opened without
+  * being truncated, and truncated only if it does not hold the cached
+  * words.  Returns the number of errors.
+  */
+{
+    AssemblerContext ctx;
+    int              fd;
+    int              nbrErrors;
+
+    if ( (fd = open (outName, O_RDWR | O_CREAT |
+                              (cacheFile != NULL ? 0 : O_TRUNC), 0666)) < 0 )
+        return 1;
+    contextInit (&ctx, fd, OUTPUT_BINARY_BE);
+    ctx.cacheFile = cacheFile;
+    nbrErrors = assemble (&ctx, program, strlen (program), NULL);
+    lastReused = ctx.cache.nbrReused;
+    if ( cacheFile != NULL && ctx.out.previous == NULL &&
+         ftruncate (fd, 0) != 0 )
+        nbrErrors++;
+    lastPatched = ctx.out.previous != NULL;
+    if ( ! contextFlush (&ctx) )
+        nbrErrors++;
+    contextFree (&ctx);
+    (void) close (fd);
+    return nbrErrors;
+}
+
+static int runStream (const char * program, const char * outName)
+ /* Writes program to the source file, and streams it from there into
+  * the named output file.  Returns the number of errors.
+  */
+{
+    AssemblerContext ctx;
+    FILE *           fp = fopen (sourceName, "wb");
+    int              inFd;
+    int              outFd;
+    int              nbrErrors = 1;
+
+    if ( fp == NULL )
+        return 1;
+    if ( (fputs (program, fp) < 0) | (fclose (fp) != 0) )
+        return 1;
+    if ( (inFd = open (sourceName, O_RDONLY)) < 0 )
+        return 1;
+    if ( (outFd = open (outName, O_RDWR | O_CREAT | O_TRUNC, 0666)) >= 0 )
+    {
+        contextInit (&ctx, outFd, OUTPUT_BINARY_BE);
+        nbrErrors = assembleStream (&ctx, inFd, sourceName, NULL);
+        if ( ! contextFlush (&ctx) )
+            nbrErrors++;
+        contextFree (&ctx);
+        (void) close (outFd);
+    }
+    (void) close (inFd);
+    return nbrErrors;
+}
+
+static int sameFiles (const char * name1, const char * name2)
+ /* Returns 1 if the two named files hold the same bytes; 0 if not. */
+{
+    FILE * fp1 = fopen (name1, "rb");
+    FILE * fp2 = fopen (name2, "rb");
+    int    c1, c2;
+    int    same = fp1 != NULL && fp2 != NULL;
+
+    while ( same )
+    {
+        c1 = getc (fp1);
+        c2 = getc (fp2);
+        same = c1 == c2;
+        if ( c1 == EOF )
+            break;
+    }
+    if ( fp1 != NULL )
+        (void) fclose (fp1);
+    if ( fp2 != NULL )
+        (void) fclose (fp2);
+    return same;
+}
+
+static int reassemble (Change change)
+ /* Assembles the changed program without a cache, then the original
+  * program with a new cache, and the changed program with that cache
+  * last (so lastReused is for it).  Returns 1 if every run assembled and
+  * the two outputs of the changed program are the same; 0 if not.
+  */
+{
+    char * original = makeProgram (ORIGINAL);
+    char * changed = makeProgram (change);
+    int    ok;
+
+    (void) unlink (cacheName);
+    ok = run (changed, NULL, fullName) == 0 &&
+         run (original, cacheName, cachedName) == 0 &&
+         run (changed, cacheName, cachedName) == 0 &&
+         sameFiles (cachedName, fullName);
+    free (original);
+    free (changed);
+    return ok;
+}
+
+static int setImage (long nbrWords, uint32_t mode, uint64_t inode)
+ /* Makes the cache's header say that the output file of the runs with
+  * the cache, as it is now (but with the given inode, unless it is 0),
+  * holds nbrWords words in the given mode.  Returns 1 if that worked;
+  * 0 if not.
+  */
+{
+    struct stat info;
+    CacheImage  image;
+
+    if ( stat (cachedName, &info) != 0 )
+        return 0;
+    image.device = info.st_dev;
+    image.inode = inode != 0 ? inode : info.st_ino;
+    image.size = info.st_size;
+    image.modified = info.st_mtim.tv_sec * 1000000000ULL +
+                     info.st_mtim.tv_nsec;
+    image.mode = mode;
+    image.nbrWords = nbrWords;
+    return cacheSetImage (cacheName, &image);
+}
+
+static int modifyOutput (void)
+ /* Overwrites the first word of the output file of the runs with the
+  * cache, a little later than it was written (for a file system whose
+  * clock is coarse to see it changed).  Returns 1 if that worked; 0 if
+  * not.
+  */
+{
+    int fd;
+    int ok;
+
+    (void) usleep (20000);
+    fd = open (cachedName, O_WRONLY);
+    ok = fd >= 0 && pwrite (fd, "\xff\xff\xff\xff", 4, 0) == 4;
+    if ( fd >= 0 )
+        (void) close (fd);
+    return ok;
+}
+
+static int patches (const char * changed, int patched)
+ /* Assembles the changed program with the cache (and the output) the
+  * last run with the cache left, and again without one.  Returns 1 if
+  * both runs assembled, only the changed words were to be written if
+  * and only if patched is 1, and the two outputs are the same; 0 if not.
+  */
+{
+    return run (changed, cacheName, cachedName) == 0 &&
+           lastPatched == patched && lastReused > 0 &&
+           run (changed, NULL, fullName) == 0 &&
+           sameFiles (cachedName, fullName);
+}
+
+static long recordOffset (int which, size_t field)
+ /* Returns the offset in the cache file of the given field of the first
+  * chunk (which = 0), label (1), or instruction (2) record, or -1 if
+  * the cache file could not be read in.
+  */
+{
+    SymbolCache  cache;
+    const char * record;
+    long         offset;
+
+    cacheInit (&cache);
+    if ( ! cacheLoad (&cache, cacheName) )
+        return -1;
+    record = which == 0 ? (const char *) cache.chunks
+           : which == 1 ? (const char *) cache.labels
+                        : (const char *) cache.instrs;
+    offset = record + field - (const char *) cache.file;
+    cacheFree (&cache);
+    return offset;
+}
+
+static int damage (long offset, const void * bytes, size_t size)
+ /* Overwrites the size bytes at offset in the cache file with bytes.
+  * Returns 1 if that worked; 0 if not.
+  */
+{
+    int fd = open (cacheName, O_WRONLY);
+    int ok = fd >= 0 && offset >= 0 &&
+             pwrite (fd, bytes, size, offset) == (ssize_t) size;
+
+    if ( fd >= 0 )
+        (void) close (fd);
+    return ok;
+}
+
+static int fallsBack (const char * program)
+ /* Assembles program with the (damaged) cache file as it is, and again
+  * without one.  Returns 1 if the cache was not read in, and the two
+  * outputs are the same; 0 if not.
+  */
+{
+    SymbolCache cache;
+    int         loaded;
+
+    cacheInit (&cache);
+    loaded = cacheLoad (&cache, cacheName);
+    cacheFree (&cache);
+    return ! loaded && run (program, cacheName, cachedName) == 0 &&
+           lastReused == 0 && run (program, NULL, fullName) == 0 &&
+           sameFiles (cachedName, fullName);
+}
+
+int main (int argc, char * argv[])
+{
+    Change   change;
+    char *   program;
+    char *   grown;
+    char *   shrunk;
+    char *   jumps;
+    char *   next;
+    uint32_t huge = UINT32_MAX;
+    uint8_t  badId = NBR_OPCODES;
+    int32_t  badSymbol = INT32_MAX;
+    int      nbrReused;
+
+    if ( argc > 1 && strcmp(argv[1], "0") == SAME )
+    {
+        debug_off();  override_debug_changes();
+    }
+    else if ( argc > 1 && strcmp(argv[1], "1") == SAME )
+    {
+        debug_on();  override_debug_changes();
+    }
+
+    if ( mkdtemp (directory) == NULL )
+    {
+        printf ("cannot make a directory for the files\n");
+        return 1;
+    }
+    sprintf (cacheName, "%s/prog.sym", directory);
+    sprintf (cachedName, "%s/cached.out", directory);
+    sprintf (fullName, "%s/full.out", directory);
+    sprintf (sourceName, "%s/jumps.mips", directory);
+
+    /* The same program again: every chunk comes from the cache. */
+    program = makeProgram (ORIGINAL);
+    check (run (program, cacheName, cachedName) == 0 && lastReused == 0,
+           "original program assembles with a new cache");
+    check (run (program, cacheName, cachedName) == 0 && lastReused > 0 &&
+           run (program, NULL, fullName) == 0 &&
+           sameFiles (cachedName, fullName),
+           "unchanged program: same output from the cache");
+    nbrReused = lastReused;
+
+    /* An edited line, an inserted chunk, and a deleted chunk. */
+    change = ORIGINAL;
+    change.edited = EDITED_LINE;
+    check (reassemble (change) && lastReused > 0 &&
+           lastReused >= nbrReused - 2, "edited line: same output");
+    change = ORIGINAL;
+    change.insertAt = INSERT_AT;
+    check (reassemble (change) && lastReused > 0,
+           "inserted chunk: same output");
+    change = ORIGINAL;
+    change.deleteFrom = DELETE_FROM;
+    change.deleteTo = DELETE_TO;
+    check (reassemble (change) && lastReused > 0,
+           "deleted chunk moving later labels: same output");
+
+    /* A damaged cache file is not used. */
+    (void) unlink (cacheName);
+    check (run (program, cacheName, cachedName) == 0 &&
+           truncate (cacheName, 100) == 0 && fallsBack (program),
+           "truncated cache: falls back on a full run");
+    check (run (program, cacheName, cachedName) == 0 && lastReused > 0,
+           "truncated cache replaced by a good one");
+    check (damage (0, "X", 1) && fallsBack (program),
+           "cache with a bad header: falls back");
+    (void) run (program, cacheName, cachedName);
+    check (damage (recordOffset (0, offsetof (CacheChunk, firstLabel)),
+                   &huge, sizeof huge) && fallsBack (program),
+           "chunk record out of range: falls back");
+    (void) run (program, cacheName, cachedName);
+    check (damage (recordOffset (1, offsetof (CacheLabel, name)),
+                   &huge, sizeof huge) && fallsBack (program),
+           "label record out of range: falls back");
+    (void) run (program, cacheName, cachedName);
+    check (damage (recordOffset (2, offsetof (IRInstr, id)),
+                   &badId, sizeof badId) && fallsBack (program),
+           "instruction with a bad opcode: falls back");
+    (void) run (program, cacheName, cachedName);
+    check (damage (recordOffset (2, offsetof (IRInstr, symbol)),
+                   &badSymbol, sizeof badSymbol) && fallsBack (program),
+           "instruction with a bad target: falls back");
+
+    /* Only the changed words are written to the last run's output, as
+     * long as it is still the file (and holds the words) the cache says.
+     */
+    change = ORIGINAL;
+    change.insertAt = INSERT_AT;
+    grown = makeProgram (change);
+    change = ORIGINAL;
+    change.deleteFrom = DELETE_FROM;
+    change.deleteTo = DELETE_TO;
+    shrunk = makeProgram (change);
+    check (run (program, cacheName, cachedName) == 0 && patches (grown, 1),
+           "output grows: changed words patched");
+    check (run (program, cacheName, cachedName) == 0 && patches (shrunk, 1),
+           "output shrinks: changed words patched");
+    check (run (program, cacheName, cachedName) == 0 && modifyOutput () &&
+           patches (grown, 0), "output modified since: rewritten");
+    check (run (program, cacheName, cachedName) == 0 &&
+           unlink (cachedName) == 0 && patches (grown, 0),
+           "output deleted since: rewritten");
+    check (run (program, cacheName, cachedName) == 0 &&
+           setImage (NBR_LINES, OUTPUT_BINARY_BE, 0) && patches (grown, 1),
+           "header set to the same image: patched");
+    check (run (program, cacheName, cachedName) == 0 &&
+           setImage (NBR_LINES, OUTPUT_BINARY_BE, 1) && patches (grown, 0),
+           "header with another file's image: rewritten");
+    check (run (program, cacheName, cachedName) == 0 &&
+           setImage (NBR_LINES, OUTPUT_BINARY_LE, 0) && patches (grown, 0),
+           "header with the wrong mode: rewritten");
+    check (run (program, cacheName, cachedName) == 0 &&
+           setImage (NBR_LINES + 1, OUTPUT_BINARY_BE, 0) &&
+           patches (grown, 0), "header with too many words: rewritten");
+    /* (These words are taken, but the file is not their size.) */
+    check (run (program, cacheName, cachedName) == 0 &&
+           setImage (NBR_LINES - 1, OUTPUT_BINARY_BE, 0) &&
+           patches (grown, 1), "header with too few words: rewritten");
+    free (grown);
+    free (shrunk);
+    free (program);
+
+    /* Forward references patched into words already in the file. */
+    jumps = malloc ((NBR_JUMPED + 3) * 32);
+    next = jumps + sprintf (jumps, "top: j end\n");
+    for ( int i = 0; i < NBR_JUMPED; i++ )
+        next += sprintf (next, "add $t0, $t1, $t2\n");
+    sprintf (next, "end: j top\n");
+    check (runStream (jumps, cachedName) == 0 &&
+           run (jumps, NULL, fullName) == 0 &&
+           sameFiles (cachedName, fullName),
+           "streamed jump patched in the file");
+    free (jumps);
+
+    (void) unlink (sourceName);
+    (void) unlink (cacheName);
+    (void) unlink (cachedName);
+    (void) unlink (fullName);
+    (void) rmdir (directory);
+    return failures > 0;
+}
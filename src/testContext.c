@@ -0,0 +1,391 @@
+/*
+ * This is a driver to test assembling programs held in memory through
+ * an assembler context (see AssemblerContext.h).  It assembles a small
+ * program and compares the machine code with the expected words, in
+ * two passes, in one, and streamed through a pipe; assembles it with
+ * comments and blank lines added, which must leave the same parsed
+ * instructions and words, in each of the passes (and a parallel pass 1
+ * must count the lines it skips only once); assembles a program
+ * with more errors than the context's error limit, which must stop
+ * assembling the program (rather than the driver), and then without a
+ * limit, and streams it too, whose errors must outlast the stream;
+ * assembles a program whose instructions in error must still take up
+ * their words, in each of the passes;
+ * reuses a context for a program of the same size, which must not need
+ * any more memory; and finally has several threads, each with a context
+ * of its own, assemble programs over and over at the same time.  Each
+ * check prints "OK" or "FAILED"; the program returns 1 if any check
+ * failed.
+ *
+ * USAGE:
+ *      name [ 0|1 ]
+ * where "name" is the name of the executable and "0" or "1" specifies
+ * that debugging should be turned off or on, respectively.  When
+ * debugging is on, the label table of each program is printed.
+ *
+ * ERROR CONDITIONS:
+ * None should be printed: the errors in the test programs are all kept
+ * in the contexts.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "assembler.h"
+
+extern int ERROR_LIMIT;         /* see printError.c */
+
+/* The threads test: NBR_THREADS threads assemble NBR_ROUNDS times each. */
+#define NBR_THREADS 4
+#define NBR_ROUNDS 200
+
+static const char * PROGRAM =
+        "main:   addi $t0, $zero, 5     # a comment\n"
+        "        add  $t0, $t1, $t2\n"
+        "loop:   beq  $t0, $t1, main\n"
+        "        j    done\n"
+        "done:   jr   $ra\n";
+
+static const uint32_t PROGRAM_WORDS[] =
+        { 0x20080005, 0x012a4020, 0x1109fffd, 0x08000004, 0x03e00008 };
+
+#define NBR_WORDS (sizeof(PROGRAM_WORDS) / sizeof(PROGRAM_WORDS[0]))
+
+/* PROGRAM with blank and comment-only lines, labels with nothing but a
+ * comment after them, and comments that look like code: the readers
+ * leave out the comments, so it must parse into the same instructions,
+ * on the lines in COMMENTED_LINES.
+ */
+static const char * COMMENTED_PROGRAM =
+        "# PROGRAM, with comments\n"
+        "\n"
+        "main:   addi $t0, $zero, 5     # a comment\n"
+        "   \t  # an indented comment: add $t0, $t1, $t2\n"
+        "        add  $t0, $t1, $t2#no space\n"
+        "loop:   # a label and a comment\n"
+        "\n"
+        "        beq  $t0, $t1, main\n"
+        "        j    done   # done: jr $ra\n"
+        "done:#\n"
+        "        jr   $ra\n"
+        "#";
+
+static const int COMMENTED_LINES[] = { 3, 5, 8, 9, 11 };
+
+/* A program with an instruction that cannot be parsed, one that cannot
+ * be assembled, and a jump to an undefined label: each still takes up
+ * its word, so done is where it would be without the errors.
+ */
+static const char * BAD_PROGRAM =
+        "        add  $t0, $t1, $t2\n"
+        "        bogus $t0\n"
+        "        j    done\n"
+        "        beq  $t0, $zz, done\n"
+        "        j    nowhere\n"
+        "done:   jr   $ra\n";
+
+static const uint32_t BAD_WORDS[] =
+        { 0x012a4020, 0, 0x08000005, 0, 0x08000000, 0x03e00008 };
+
+#define NBR_BAD_WORDS (sizeof(BAD_WORDS) / sizeof(BAD_WORDS[0]))
+
+static int failures = 0;
+
+static void check (int condition, const char * description)
+{
+    printf ("%-50s %s\n", description, condition ? "OK" : "FAILED");
+    if ( ! condition )
+        failures++;
+}
+
+static int sameWords (const AssembledCode * code)
+ /* Returns 1 if code holds exactly the words of PROGRAM; 0 if not. */
+{
+    return code->nbrErrors == 0 && code->nbrWords == NBR_WORDS &&
+           memcmp (code->words, PROGRAM_WORDS, sizeof(PROGRAM_WORDS)) == SAME;
+}
+
+static int badWords (const AssembledCode * code)
+ /* Returns 1 if code holds the 3 errors and exactly the words of
+  * BAD_PROGRAM; 0 if not.
+  */
+{
+    return code->nbrErrors == 3 && code->nbrWords == NBR_BAD_WORDS &&
+           memcmp (code->words, BAD_WORDS, sizeof(BAD_WORDS)) == SAME;
+}
+
+static int sameIR (const IRProgram * program, const IRInstr * instrs,
+                   int nbrInstrs)
+ /* Returns 1 if program holds the nbrInstrs instructions in instrs, but
+  * for their line numbers; 0 if not.
+  */
+{
+    if ( program->nbrInstrs != nbrInstrs )
+        return 0;
+    for ( int i = 0; i < nbrInstrs; i++ )
+    {
+        const IRInstr * instr = &program->instrs[i];
+
+        if ( instr->id != instrs[i].id || instr->rs != instrs[i].rs ||
+             instr->rt != instrs[i].rt || instr->rd != instrs[i].rd ||
+             instr->imm != instrs[i].imm ||
+             instr->symbol != instrs[i].symbol )
+            return 0;
+    }
+    return 1;
+}
+
+static char * repeat (const char * line, int times)
+ /* Returns (in newly allocated memory) line, times times over. */
+{
+    size_t length = strlen (line);
+    char * text = malloc (length * times + 1);
+
+    for ( int i = 0; i < times; i++ )
+        memcpy (text + i * length, line, length);
+    text[length * times] = '\0';
+    return text;
+}
+
+static int streamProgram (AssemblerContext * ctx, const char * program,
+                          AssembledCode * code)
+ /* Assembles the program with assembleStream, through a pipe (it must
+  * fit in the pipe's buffer).  Returns what assembleStream returns, or
+  * -1 if the pipe could not be made.
+  */
+{
+    ssize_t length = strlen (program);
+    int     fds[2];
+    int     result;
+
+    if ( pipe (fds) != 0 )
+        return -1;
+    if ( write (fds[1], program, length) != length )
+        result = -1;
+    else
+    {
+        (void) close (fds[1]);
+        fds[1] = -1;
+        result = assembleStream (ctx, fds[0], "<pipe>", code);
+    }
+    (void) close (fds[0]);
+    if ( fds[1] >= 0 )
+        (void) close (fds[1]);
+    return result;
+}
+
+static void * work (void * result)
+ /* The body of each thread in the threads test: sets *result to 1 if
+  * every program it assembled came out right, 0 if not.
+  */
+{
+    AssemblerContext ctx;
+    AssembledCode    code;
+    char *           bad = repeat ("bogus $t0\n", 25);
+    int              ok = 1;
+
+    contextInit (&ctx, -1, OUTPUT_BINARY_BE);
+    for ( int round = 0; round < NBR_ROUNDS; round++ )
+    {
+        ctx.singlePass = round % 2;
+        (void) assemble (&ctx, PROGRAM, strlen (PROGRAM), &code);
+        ok &= sameWords (&code);
+        (void) assemble (&ctx, bad, strlen (bad), &code);
+        ok &= code.nbrErrors == ERROR_LIMIT && code.stopped &&
+              code.nbrWords == 0 && code.errors->nbrEntries == ERROR_LIMIT;
+    }
+    contextFree (&ctx);
+    free (bad);
+
+    *(int *) result = ok;
+    return NULL;
+}
+
+int main (int argc, char * argv[])
+{
+    AssemblerContext ctx;
+    AssembledCode    code;
+    char *           bad;
+    char *           big;
+    char *           other;
+    const uint32_t * words;
+    const IRInstr *  instrs;
+    const char *     names;
+    const ArenaChunk * scratch;
+    const Diagnostic * entries;
+    IRInstr          baseline[NBR_WORDS];
+    IRInstr *        copy;
+    long long        skipped;
+    char             message[100];
+    pthread_t        threads[NBR_THREADS];
+    int              started[NBR_THREADS];
+    int              results[NBR_THREADS];
+    int              allOK;
+
+    if ( argc > 1 && strcmp(argv[1], "0") == SAME )
+    {
+        debug_off();  override_debug_changes();
+    }
+    else if ( argc > 1 && strcmp(argv[1], "1") == SAME )
+    {
+        debug_on();  override_debug_changes();
+    }
+
+    /* A small program, in two passes and in one. */
+    contextInit (&ctx, -1, OUTPUT_BINARY_BE);
+    check (assemble (&ctx, PROGRAM, strlen (PROGRAM), &code) == 0,
+           "small program assembles");
+    check (sameWords (&code), "small program has the expected words");
+    ctx.singlePass = 1;
+    check (assemble (&ctx, PROGRAM, strlen (PROGRAM), &code) == 0 &&
+           sameWords (&code), "same words in a single pass");
+    ctx.singlePass = 0;
+    check (streamProgram (&ctx, PROGRAM, &code) == 0 && sameWords (&code),
+           "same words streamed through a pipe");
+    check (assemble (&ctx, PROGRAM, 0, &code) == 0 && code.nbrWords == 0,
+           "empty program assembles to nothing");
+
+    /* Comments and blank lines change nothing but the line numbers. */
+    (void) assemble (&ctx, PROGRAM, strlen (PROGRAM), &code);
+    memcpy (baseline, ctx.program.instrs, sizeof(baseline));
+    check (assemble (&ctx, COMMENTED_PROGRAM, strlen (COMMENTED_PROGRAM),
+                     &code) == 0 && sameWords (&code) &&
+           sameIR (&ctx.program, baseline, NBR_WORDS),
+           "comments leave the same instructions");
+    allOK = 1;
+    for ( size_t i = 0; i < NBR_WORDS; i++ )
+        allOK &= ctx.program.instrs[i].line == COMMENTED_LINES[i];
+    check (allOK, "...on the lines they are on");
+    ctx.singlePass = 1;
+    check (assemble (&ctx, COMMENTED_PROGRAM, strlen (COMMENTED_PROGRAM),
+                     &code) == 0 && sameWords (&code),
+           "and the same words in a single pass");
+    ctx.singlePass = 0;
+    check (streamProgram (&ctx, COMMENTED_PROGRAM, &code) == 0 &&
+           sameWords (&code), "and streamed");
+    big = repeat ("        add  $t0, $t1, $t2\n", 20000);
+    bad = repeat ("  # a comment\n\n        add  $t0, $t1, $t2 # add\n",
+                  20000);
+    statsEnabled = 1;           /* before any threads are started */
+    statsClear ();
+    (void) assemble (&ctx, bad, strlen (bad), &code);
+    skipped = statsCount (STAT_SKIPPED);
+    ctx.nbrThreads = 4;
+    statsClear ();
+    (void) assemble (&ctx, bad, strlen (bad), &code);
+    check (skipped == 2 * 20000 && statsCount (STAT_SKIPPED) == skipped,
+           "skipped lines counted once in a parallel pass 1");
+    statsEnabled = 0;
+    statsClear ();
+    (void) assemble (&ctx, big, strlen (big), &code);
+    copy = malloc (20000 * sizeof(IRInstr));
+    memcpy (copy, ctx.program.instrs, 20000 * sizeof(IRInstr));
+    check (assemble (&ctx, bad, strlen (bad), &code) == 0 &&
+           code.nbrWords == 20000 && sameIR (&ctx.program, copy, 20000),
+           "and the same instructions in a parallel pass 1");
+    ctx.nbrThreads = 1;
+    free (copy);
+    free (big);
+    free (bad);
+
+    /* More errors than the limit: kept, not printed, and not fatal. */
+    bad = repeat ("        add  $t0, $t1, $zz\n", 30);
+    check (assemble (&ctx, bad, strlen (bad), &code) == ERROR_LIMIT &&
+           code.stopped, "stopped at the error limit");
+    check (code.errors->nbrEntries == ERROR_LIMIT, "errors up to it kept");
+    (void) diagFormat (code.errors, 0, message, sizeof(message));
+    check (strcmp (message, "Error on line 1: invalid register $zz.\n")
+           == SAME, "first message is for line 1");
+    check (code.errors->entries[0].line == 1 &&
+           code.errors->entries[0].column == 24 &&
+           code.errors->entries[0].code == DIAG_INVALID_REGISTER,
+           "first error is at line 1, column 24");
+    ctx.errorLimit = 0;
+    check (assemble (&ctx, bad, strlen (bad), &code) == 30 && ! code.stopped
+           && code.errors->nbrEntries == 30, "30 errors found with no limit");
+    check (code.errors->entries[29].line == 30, "last error is for line 30");
+    check (streamProgram (&ctx, bad, &code) == 30 &&
+           code.errors->entries[0].column == 24 &&
+           diagFormat (code.errors, 29, message, sizeof(message)) > 0 &&
+           strcmp (message, "Error on line 30: invalid register $zz.\n")
+           == SAME, "streamed errors kept after the stream");
+    check (assemble (&ctx, PROGRAM, strlen (PROGRAM), &code) == 0 &&
+           sameWords (&code) && code.errors->nbrEntries == 0,
+           "next program starts with no errors");
+    free (bad);
+
+    /* Instructions in error keep their words, in every pass. */
+    check (assemble (&ctx, BAD_PROGRAM, strlen (BAD_PROGRAM), &code) == 3 &&
+           badWords (&code), "errors keep their words in two passes");
+    ctx.singlePass = 1;
+    check (assemble (&ctx, BAD_PROGRAM, strlen (BAD_PROGRAM), &code) == 3 &&
+           badWords (&code), "the same words in a single pass");
+    ctx.singlePass = 0;
+    check (streamProgram (&ctx, BAD_PROGRAM, &code) == 3 &&
+           badWords (&code), "the same words streamed");
+    bad = repeat ("        bogus $t0\n        add $t0, $t1, $t2\n", 20000);
+    ctx.nbrThreads = 4;
+    allOK = assemble (&ctx, bad, strlen (bad), &code) == 20000 &&
+            code.nbrWords == 40000;
+    for ( int i = 0; allOK && i < code.nbrWords; i++ )
+        allOK = code.words[i] == (i % 2 == 0 ? 0 : 0x012a4020);
+    check (allOK, "and in a parallel pass 2");
+    ctx.nbrThreads = 1;
+    free (bad);
+
+    /* Reusing a context for a program of the same size. */
+    big = repeat ("here: add $t0, $t1, $t2\n", 5000);
+    other = repeat ("this: sub $t0, $t1, $t2\n", 5000);
+    big[0] = other[0] = 'L';
+    (void) assemble (&ctx, big, strlen (big), &code);
+    words = ctx.out.words;
+    instrs = ctx.program.instrs;
+    names = (char *) ctx.table.names.first->data;
+    entries = ctx.errors.entries;
+    check (assemble (&ctx, other, strlen (other), &code) == 0 &&
+           code.nbrWords == 5000 && code.errors->nbrEntries == 5000 - 2,
+           "second big program (duplicates reported)");
+    check (code.errors->entries[0].code == DIAG_DUPLICATE_LABEL &&
+           code.errors->entries[0].line == 3 &&
+           code.errors->entries[0].column == 1,
+           "first duplicate is at line 3, column 1");
+    check (ctx.out.words == words && ctx.program.instrs == instrs &&
+           (char *) ctx.table.names.first->data == names &&
+           ctx.errors.entries == entries,
+           "reused context needed no more memory");
+    free (big);
+    free (other);
+
+    /* The scratch memory of a parallel pass 2 is reused as well. */
+    big = repeat ("        add $t0, $t1, $t2\n", 40000);
+    ctx.nbrThreads = 4;
+    (void) assemble (&ctx, big, strlen (big), &code);
+    scratch = ctx.program.scratch.first;
+    check (assemble (&ctx, big, strlen (big), &code) == 0 &&
+           code.nbrWords == 40000 && scratch != NULL &&
+           ctx.program.scratch.first == scratch &&
+           scratch->next == NULL,
+           "scratch arena reset for the next program");
+    ctx.nbrThreads = 1;
+    free (big);
+    contextFree (&ctx);
+
+    /* Contexts on several threads at once. */
+    for ( int t = 0; t < NBR_THREADS; t++ )
+    {
+        started[t] = pthread_create (&threads[t], NULL, work,
+                                     &results[t]) == 0;
+        if ( ! started[t] )
+            (void) work (&results[t]);
+    }
+    allOK = 1;
+    for ( int t = 0; t < NBR_THREADS; t++ )
+    {
+        if ( started[t] )
+            (void) pthread_join (threads[t], NULL);
+        allOK &= results[t];
+    }
+    check (allOK, "threads assembled with contexts of their own");
+
+    return failures > 0;
+}
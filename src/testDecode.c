@@ -0,0 +1,361 @@
+/*
+ * This is a driver to test the decoding of mnemonics and operands.
+ * getOpType must find every mnemonic in MIPS_INSTRUCTIONS (see
+ * Instructions.h), with its opcode id, type, and code, and reject the
+ * near misses made from each one: its prefixes, itself with a character
+ * added, and itself in upper case (unless that is another mnemonic).
+ * getRegNbr must find every register by its name and its number, and
+ * reject a table of near misses.  And getImmediate is run on a table of
+ * tokens, each with the range of a field it goes in and what
+ * getImmediate must make of it -- a value, or an invalid number or out
+ * of range error.  The table has prefixes with no digits, signs that
+ * are doubled or go with hexadecimal, characters that are not digits of
+ * the base, numbers long enough to reach the cap on the value (see
+ * getImmediate.c), and the bounds of the signed, unsigned, and shift
+ * amount fields, and one past each.  Each token is followed by other
+ * characters, which must not be taken for part of it.  Each check
+ * prints "OK" or "FAILED"; the program returns 1 if any check failed.
+ *
+ * USAGE:
+ *      name [ 0|1 ]
+ * where "name" is the name of the executable and "0" or "1" specifies
+ * that debugging should be turned off or on, respectively.  When
+ * debugging is on, what the decoders made of each token that came out
+ * wrong is printed.
+ *
+ * ERROR CONDITIONS:
+ * None should be printed: the errors are all kept in a sink.
+ */
+
+#include "assembler.h"
+#include "Instructions.h"
+
+/* The name, opcode id, type, and code of each instruction. */
+typedef struct {
+        const char * name;
+        int id;
+        char type;
+        int code;
+} Mnemonic;
+
+#define INSTR(name, form, code, ...)  { #name, OP_##name, FORM_TYPE_##form, \
+                                        code },
+static const Mnemonic MNEMONICS[NBR_OPCODES] = { MIPS_INSTRUCTIONS };
+#undef INSTR
+
+/* The characters added to each mnemonic for its near misses. */
+static const char ADDED[] = "abdilsuvz0 ";
+
+/* The name of each register, by number, and the other name of $30. */
+static const char * REGISTERS[32] =
+{
+        "zero", "at", "v0", "v1", "a0", "a1", "a2", "a3",
+        "t0", "t1", "t2", "t3", "t4", "t5", "t6", "t7",
+        "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7",
+        "t8", "t9", "k0", "k1", "gp", "sp", "fp", "ra",
+};
+#define FP_ALIAS "s8"
+
+/* Register names that are not. */
+static const char * NOT_REGISTERS[] =
+{
+        "", "$", "t0", "$32", "$99", "$100", "$01", "$00", "$-1", "$+1",
+        "$3a", "$$0", "$ t0", "$t10", "$t", "$v2", "$a4", "$s9", "$k2",
+        "$t00", "$T0", "$ZERO", "$Zero", "$Sp", "$RA", "$zer", "$zeros",
+        "$ra0", "$sp1", "$gp0", "$at0", "$b0", "$x1",
+};
+
+#define NBR_NOT_REGISTERS (sizeof(NOT_REGISTERS) / sizeof(NOT_REGISTERS[0]))
+
+/* The fields an immediate value goes in (see assemble.c). */
+#define SIGNED_MIN (-32768)
+#define SIGNED_MAX 32767
+#define UNSIGNED_MAX 65535
+#define SHAMT_MAX 31
+
+/* Set in value when getImmediate must leave it unchanged. */
+#define UNCHANGED 12345
+
+/* A token, the range of the field it goes in, and what getImmediate
+ * must make of it: 1 and its value, or 0 and the error.
+ */
+typedef struct {
+        const char * text;
+        long min;
+        long max;
+        int ok;
+        int32_t value;
+        DiagCode error;
+} ImmediateCase;
+
+static const ImmediateCase IMMEDIATES[] =
+{
+        /* no digits */
+        { "", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "-", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "+", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "0x", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "0X", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "-0x", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        /* signs */
+        { "+5", SIGNED_MIN, SIGNED_MAX, 1, 5, 0 },
+        { "-5", SIGNED_MIN, SIGNED_MAX, 1, -5, 0 },
+        { "--1", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "+-1", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "5-", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "-0x8000", SIGNED_MIN, SIGNED_MAX, 1, -32768, 0 },
+        { "-0x8001", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        { "+0x7fff", SIGNED_MIN, SIGNED_MAX, 1, 32767, 0 },
+        { "-0", 0, UNSIGNED_MAX, 1, 0, 0 },
+        /* digits and non-digits */
+        { "0x1g", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "0x7FfF", SIGNED_MIN, SIGNED_MAX, 1, 32767, 0 },
+        { "0X10", SIGNED_MIN, SIGNED_MAX, 1, 16, 0 },
+        { "1a", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "0x-1", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "0x 1", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_INVALID_NUMBER },
+        { "00012", SIGNED_MIN, SIGNED_MAX, 1, 12, 0 },
+        { "0", SIGNED_MIN, SIGNED_MAX, 1, 0, 0 },
+        { "0x0", SIGNED_MIN, SIGNED_MAX, 1, 0, 0 },
+        /* long enough to reach the cap */
+        { "99999999999999999999", SIGNED_MIN, SIGNED_MAX, 0, 0,
+          DIAG_OUT_OF_RANGE },
+        { "-99999999999999999999", SIGNED_MIN, SIGNED_MAX, 0, 0,
+          DIAG_OUT_OF_RANGE },
+        { "0xffffffffffffffffffff", 0, UNSIGNED_MAX, 0, 0,
+          DIAG_OUT_OF_RANGE },
+        { "9999999999999999999x", SIGNED_MIN, SIGNED_MAX, 0, 0,
+          DIAG_INVALID_NUMBER },
+        { "00000000000000000001", SIGNED_MIN, SIGNED_MAX, 1, 1, 0 },
+        { "99999999999999999999", 0, 0xffffffffL, 0, 0, DIAG_OUT_OF_RANGE },
+        { "4294967296", 0, 0xffffffffL, 0, 0, DIAG_OUT_OF_RANGE },
+        { "4294967295", 0, 0xffffffffL, 1, -1, 0 },
+        /* the bounds of the signed field */
+        { "-32768", SIGNED_MIN, SIGNED_MAX, 1, -32768, 0 },
+        { "-32769", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        { "32767", SIGNED_MIN, SIGNED_MAX, 1, 32767, 0 },
+        { "32768", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        { "0x8000", SIGNED_MIN, SIGNED_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        /* ...of the unsigned field */
+        { "0", 0, UNSIGNED_MAX, 1, 0, 0 },
+        { "-1", 0, UNSIGNED_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        { "65535", 0, UNSIGNED_MAX, 1, 65535, 0 },
+        { "65536", 0, UNSIGNED_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        { "0xffff", 0, UNSIGNED_MAX, 1, 65535, 0 },
+        { "0x10000", 0, UNSIGNED_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        /* ...of either (lui) */
+        { "-32768", SIGNED_MIN, UNSIGNED_MAX, 1, -32768, 0 },
+        { "-32769", SIGNED_MIN, UNSIGNED_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        { "65535", SIGNED_MIN, UNSIGNED_MAX, 1, 65535, 0 },
+        { "65536", SIGNED_MIN, UNSIGNED_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        /* ...and of the shift amount */
+        { "0", 0, SHAMT_MAX, 1, 0, 0 },
+        { "-1", 0, SHAMT_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        { "31", 0, SHAMT_MAX, 1, 31, 0 },
+        { "32", 0, SHAMT_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+        { "0x1f", 0, SHAMT_MAX, 1, 31, 0 },
+        { "0x20", 0, SHAMT_MAX, 0, 0, DIAG_OUT_OF_RANGE },
+};
+
+#define NBR_IMMEDIATES (sizeof(IMMEDIATES) / sizeof(IMMEDIATES[0]))
+
+static int failures = 0;
+
+static void check (int condition, const char * description)
+{
+    printf ("%-50s %s\n", description, condition ? "OK" : "FAILED");
+    if ( ! condition )
+        failures++;
+}
+
+static int mnemonicId (const char * name)
+ /* Returns the opcode id of the mnemonic name, or -1 if it is none. */
+{
+    for ( int i = 0; i < NBR_OPCODES; i++ )
+        if ( strcmp (MNEMONICS[i].name, name) == SAME )
+            return MNEMONICS[i].id;
+    return -1;
+}
+
+static int opTypeAsExpected (const char * name, DiagnosticSink * sink)
+ /* Returns 1 if getOpType finds the mnemonic name (followed by other
+  * characters) with the id, type, and code in MNEMONICS, or rejects it
+  * if it is none of them; 0 (after printing what it found, if debugging
+  * is on) if not.
+  */
+{
+    char text[100];
+    int  length = strlen (name);
+    int  before = sink->nbrEntries;
+    int  id = mnemonicId (name);
+    char type = '?';
+    int  code = -1;
+    int  found;
+    int  right;
+
+    snprintf (text, sizeof(text), "%s $t0", name);
+    found = getOpType (text, length, &type, &code, 3);
+    if ( id >= 0 )
+        right = found == id && type == MNEMONICS[id].type &&
+                code == MNEMONICS[id].code && sink->nbrEntries == before;
+    else
+        right = found == -1 && type == '?' && code == -1 &&
+                sink->nbrEntries == before + 1 &&
+                sink->entries[before].code == DIAG_UNKNOWN_INSTR &&
+                sink->entries[before].line == 3 &&
+                sink->entries[before].argLength == length;
+    if ( ! right )
+        printDebug ("\"%s\": returned %d, type %c, code %d, %d errors\n",
+                    name, found, type, code, sink->nbrEntries - before);
+    return right;
+}
+
+static int regNbrAsExpected (const char * name, int reg,
+                             DiagnosticSink * sink)
+ /* Returns 1 if getRegNbr finds the register name (followed by other
+  * characters) as reg or, if reg is -1, rejects it; 0 (after printing
+  * what it found, if debugging is on) if not.
+  */
+{
+    char text[100];
+    int  length = strlen (name);
+    int  before = sink->nbrEntries;
+    int  found;
+    int  right;
+
+    snprintf (text, sizeof(text), "%s, $t1", name);
+    found = getRegNbr (text, length, 3);
+    if ( reg >= 0 )
+        right = found == reg && sink->nbrEntries == before;
+    else
+        right = found == -1 && sink->nbrEntries == before + 1 &&
+                sink->entries[before].code == DIAG_INVALID_REGISTER &&
+                sink->entries[before].line == 3 &&
+                sink->entries[before].argLength == length;
+    if ( ! right )
+        printDebug ("\"%s\": returned %d, %d errors\n", name, found,
+                    sink->nbrEntries - before);
+    return right;
+}
+
+static int decodesAsExpected (const ImmediateCase * test,
+                              DiagnosticSink * sink)
+ /* Returns 1 if getImmediate makes of the token of test (followed by
+  * other characters, for it to stop at the end of the token) what it
+  * must; 0 (after printing what it made of it, if debugging is on) if
+  * not.
+  */
+{
+    char    text[100];
+    int     length = strlen (test->text);
+    int     before = sink->nbrEntries;
+    int32_t value = UNCHANGED;
+    int     ok;
+    int     right;
+
+    snprintf (text, sizeof(text), "%s, 7", test->text);
+    ok = getImmediate (text, length, test->min, test->max, 3, &value);
+    if ( test->ok )
+        right = ok == 1 && value == test->value &&
+                sink->nbrEntries == before;
+    else
+        right = ok == 0 && value == UNCHANGED &&
+                sink->nbrEntries == before + 1 &&
+                sink->entries[before].code == test->error &&
+                sink->entries[before].line == 3 &&
+                sink->entries[before].argLength == length;
+    if ( ! right )
+        printDebug ("\"%s\" in [%ld, %ld]: returned %d, value %d, %d "
+                    "errors\n", test->text, test->min, test->max, ok,
+                    (int) value, sink->nbrEntries - before);
+    return right;
+}
+
+int main (int argc, char * argv[])
+{
+    DiagnosticSink   sink;
+    DiagnosticSink * previous;
+    char             description[100];
+    char             name[100];
+    int              length;
+    int              ok;
+
+    if ( argc > 1 && strcmp(argv[1], "0") == SAME )
+    {
+        debug_off();  override_debug_changes();
+    }
+    else if ( argc > 1 && strcmp(argv[1], "1") == SAME )
+    {
+        debug_on();  override_debug_changes();
+    }
+
+    diagInit (&sink, NULL, 0);
+    previous = captureErrors (&sink);
+
+    /* Every mnemonic, and the near misses made from each one. */
+    ok = 1;
+    for ( int i = 0; i < NBR_OPCODES; i++ )
+        ok &= MNEMONICS[i].id == i &&
+              opTypeAsExpected (MNEMONICS[i].name, &sink);
+    check (ok, "getOpType: every mnemonic, with its type and code");
+    ok = 1;
+    for ( int i = 0; i < NBR_OPCODES; i++ )
+    {
+        length = strlen (MNEMONICS[i].name);
+        for ( int k = 0; k < length; k++ )
+        {
+            sprintf (name, "%.*s", k, MNEMONICS[i].name);
+            ok &= opTypeAsExpected (name, &sink);
+        }
+        for ( size_t k = 0; k < sizeof(ADDED) - 1; k++ )
+        {
+            sprintf (name, "%s%c", MNEMONICS[i].name, ADDED[k]);
+            ok &= opTypeAsExpected (name, &sink);
+            sprintf (name, "%c%s", ADDED[k], MNEMONICS[i].name);
+            ok &= opTypeAsExpected (name, &sink);
+        }
+        for ( int k = 0; k <= length; k++ )
+            name[k] = toupper (MNEMONICS[i].name[k]);
+        ok &= opTypeAsExpected (name, &sink);
+        name[0] = MNEMONICS[i].name[0];
+        ok &= opTypeAsExpected (name, &sink);
+    }
+    check (ok, "getOpType: near misses rejected (adds, ADD, ...)");
+    check (opTypeAsExpected ("addaddadd", &sink) &&
+           opTypeAsExpected ("syscalls", &sink),
+           "getOpType: too long to pack rejected");
+
+    /* Every register, by name and by number, and the near misses. */
+    ok = 1;
+    for ( int i = 0; i < 32; i++ )
+    {
+        sprintf (name, "$%s", REGISTERS[i]);
+        ok &= regNbrAsExpected (name, i, &sink);
+        sprintf (name, "$%d", i);
+        ok &= regNbrAsExpected (name, i, &sink);
+    }
+    ok &= regNbrAsExpected ("$" FP_ALIAS, 30, &sink);
+    check (ok, "getRegNbr: every register, by name and number");
+    ok = 1;
+    for ( size_t i = 0; i < NBR_NOT_REGISTERS; i++ )
+        ok &= regNbrAsExpected (NOT_REGISTERS[i], -1, &sink);
+    for ( int i = 0; i < 32; i++ )
+    {
+        sprintf (name, "$%s", REGISTERS[i]);
+        for ( int k = 1; name[k] != '\0'; k++ )
+            name[k] = toupper (name[k]);
+        ok &= regNbrAsExpected (name, -1, &sink);
+    }
+    check (ok, "getRegNbr: near misses rejected ($32, $t10, ...)");
+
+    for ( size_t i = 0; i < NBR_IMMEDIATES; i++ )
+    {
+        sprintf (description, "getImmediate \"%.20s\" in [%ld, %ld]",
+                 IMMEDIATES[i].text, IMMEDIATES[i].min, IMMEDIATES[i].max);
+        check (decodesAsExpected (&IMMEDIATES[i], &sink), description);
+    }
+
+    (void) captureErrors (previous);
+    diagFree (&sink);
+    return failures > 0;
+}
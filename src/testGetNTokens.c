@@ -0,0 +1,245 @@
+/*
+ * This is a driver to test the tokenizers: getToken, scanTokens (with
+ * each implementation of scanBlock this CPU supports, see Scanner.h),
+ * and getNTokens, which uses scanTokens.  It splits a table of lines
+ * with leading, trailing, adjacent, and spaced-out delimiters into
+ * tokens and compares them with the expected ones; splits several
+ * thousand random lines, up to a few blocks long, with every
+ * implementation and checks that each finds the tokens getToken does,
+ * less the delimiter a getToken token may start with; and checks what
+ * getNTokens returns for too few, too many, and too long tokens.  Each
+ * check prints "OK" or "FAILED"; the program returns 1 if any check
+ * failed.
+ *
+ * USAGE:
+ *      name [ 0|1 ]
+ * where "name" is the name of the executable and "0" or "1" specifies
+ * that debugging should be turned off or on, respectively.  When
+ * debugging is on, the tokens of every line that came out wrong are
+ * printed.
+ */
+
+#include "assembler.h"
+#include "CharClass.h"
+#include "Scanner.h"
+
+/* The random lines: NBR_RANDOM lines of up to MAX_RANDOM characters. */
+#define NBR_RANDOM 5000
+#define MAX_RANDOM 300
+#define MAX_TOKENS (MAX_RANDOM + 1)
+
+/* A line, the tokens scanTokens finds in it, and the ones the getToken
+ * loop finds if they are different (NULL if not); each list of tokens
+ * is separated by single spaces.
+ */
+typedef struct {
+        const char * line;
+        const char * tokens;
+        const char * getTokens;
+} TokenLine;
+
+static const TokenLine LINES[] =
+{
+        { "", "", NULL },
+        { "   \t ", "", NULL },
+        { "add", "add", NULL },
+        { "loop: add $t0, $t1, $t2", "loop add $t0 $t1 $t2", NULL },
+        { "  lw $t0, 4($sp)  ", "lw $t0 4 $sp", NULL },
+        { "lw $t0,4($sp)", "lw $t0 4 $sp", NULL },
+        { "add $t0, $t1, $t2,", "add $t0 $t1 $t2", NULL },
+        { "jr $ra)", "jr $ra", NULL },
+        /* a delimiter where a token could start */
+        { ",add", "add", ",add" },
+        { ": add", "add", ": add" },
+        { "add $t0 , $t1", "add $t0 $t1", "add $t0 , $t1" },
+        { "add $t0,,$t1", "add $t0 $t1", "add $t0 ,$t1" },
+        { "add $t0,,,$t1", "add $t0 $t1", "add $t0 , $t1" },
+        { "lw $t0, 4 ($sp)", "lw $t0 4 $sp", "lw $t0 4 ($sp" },
+        { "jr $ra ,", "jr $ra", "jr $ra ," },
+        { "jr $ra))", "jr $ra", "jr $ra )" },
+        { ",", "", "," },
+        { "(,)", "", "( )" },
+        /* tokens next to a block boundary (a block is 64 characters) */
+        { "add                                                         "
+          "$t0,$t1,$t2", "add $t0 $t1 $t2", NULL },
+        { "add                                                          "
+          " ,$t0,$t1,$t2", "add $t0 $t1 $t2", "add ,$t0 $t1 $t2" },
+        { "a123456789012345678901234567890123456789012345678901234567890"
+          "12,b", "a12345678901234567890123456789012345678901234567890123456"
+          "789012 b", NULL },
+        { "a123456789012345678901234567890123456789012345678901234567890"
+          "12,,b", "a12345678901234567890123456789012345678901234567890123456"
+          "789012 b", "a12345678901234567890123456789012345678901234567890"
+          "123456789012 ,b" },
+};
+
+#define NBR_LINES (sizeof(LINES) / sizeof(LINES[0]))
+
+/* The characters the random lines are made of. */
+static const char RANDOM_CHARS[] = "  \t,,():#ab$0";
+
+static const char * IMPLEMENTATIONS[] = { "scalar", "sse2", "avx2", "neon" };
+
+static int failures = 0;
+
+static void check (int condition, const char * description)
+{
+    printf ("%-50s %s\n", description, condition ? "OK" : "FAILED");
+    if ( ! condition )
+        failures++;
+}
+
+static void joinScanned (const char * line, char * tokens)
+ /* Fills tokens with the tokens scanTokens finds in line, separated by
+  * single spaces.
+  */
+{
+    TokenSpan spans[MAX_TOKENS];
+    int       count = scanTokens (line, strlen (line), spans, MAX_TOKENS);
+
+    tokens[0] = '\0';
+    for ( int i = 0; i < count && i < MAX_TOKENS; i++ )
+        tokens += sprintf (tokens, "%s%.*s", i > 0 ? " " : "",
+                           spans[i].len, spans[i].ptr);
+}
+
+static void joinGetTokens (const char * line, int stripDelimiter,
+                           char * tokens)
+ /* Fills tokens with the tokens the getToken loop (see getToken.h)
+  * finds in line, separated by single spaces, leaving out the delimiter
+  * a token starts with (and a token that was only that) if
+  * stripDelimiter is 1.
+  */
+{
+    char   copy[MAX_RANDOM + 100];
+    char * begin = strcpy (copy, line);
+    char * end;
+    char * next = tokens;
+    int    isLastToken;
+
+    *next = '\0';
+    for ( ;; )
+    {
+        getToken (&begin, &end);
+        if ( *begin == '\0' )
+            break;
+        isLastToken = *end == '\0';
+        *end = '\0';
+        if ( stripDelimiter && (CHAR_CLASS_OF (*begin) & CC_DELIM) )
+            begin++;
+        if ( *begin != '\0' )
+            next += sprintf (next, "%s%s", next > tokens ? " " : "", begin);
+        if ( isLastToken )
+            break;
+        begin = end + 1;
+    }
+}
+
+static int sameTokens (const char * line, const char * tokens,
+                       const char * expected)
+ /* Returns 1 if tokens are the expected ones; 0 (after printing them,
+  * if debugging is on) if not.
+  */
+{
+    (void) line;                /* only printed, if debugging is on */
+    if ( strcmp (tokens, expected) == SAME )
+        return 1;
+    printDebug ("\"%s\": found [%s], expected [%s]\n", line, tokens,
+                expected);
+    return 0;
+}
+
+static void randomLine (char * line)
+ /* Fills line with a random line of up to MAX_RANDOM characters. */
+{
+    int length = rand () % (MAX_RANDOM + 1);
+
+    for ( int i = 0; i < length; i++ )
+        line[i] = RANDOM_CHARS[rand () % (sizeof(RANDOM_CHARS) - 1)];
+    line[length] = '\0';
+}
+
+int main (int argc, char * argv[])
+{
+    const char * inUse = scanImplementation ();
+    char         line[MAX_RANDOM + 1];
+    char         tokens[2 * MAX_RANDOM + 100];
+    char         expected[2 * MAX_RANDOM + 100];
+    char         description[100];
+    char         buffer[100];
+    char *       results[4];
+    char *       longLine;
+    int          ok;
+
+    if ( argc > 1 && strcmp(argv[1], "0") == SAME )
+    {
+        debug_off();  override_debug_changes();
+    }
+    else if ( argc > 1 && strcmp(argv[1], "1") == SAME )
+    {
+        debug_on();  override_debug_changes();
+    }
+
+    /* The getToken loop, on the table of lines. */
+    ok = 1;
+    for ( size_t i = 0; i < NBR_LINES; i++ )
+    {
+        joinGetTokens (LINES[i].line, 0, tokens);
+        ok &= sameTokens (LINES[i].line, tokens, LINES[i].getTokens != NULL
+                          ? LINES[i].getTokens : LINES[i].tokens);
+    }
+    check (ok, "getToken: delimiters that start tokens");
+
+    /* scanTokens with each implementation, on the table and at random. */
+    for ( size_t k = 0; k < sizeof(IMPLEMENTATIONS) / sizeof(char *); k++ )
+    {
+        if ( ! scanSelect (IMPLEMENTATIONS[k]) )
+            continue;           /* not on this CPU */
+
+        ok = 1;
+        for ( size_t i = 0; i < NBR_LINES; i++ )
+        {
+            joinScanned (LINES[i].line, tokens);
+            ok &= sameTokens (LINES[i].line, tokens, LINES[i].tokens);
+        }
+        sprintf (description, "scanTokens (%s): expected tokens",
+                 IMPLEMENTATIONS[k]);
+        check (ok, description);
+
+        ok = 1;
+        srand (1);              /* the same lines for each of them */
+        for ( int i = 0; i < NBR_RANDOM; i++ )
+        {
+            randomLine (line);
+            joinScanned (line, tokens);
+            joinGetTokens (line, 1, expected);
+            ok &= sameTokens (line, tokens, expected);
+        }
+        sprintf (description, "scanTokens (%s): random lines as getToken",
+                 IMPLEMENTATIONS[k]);
+        check (ok, description);
+    }
+    (void) scanSelect (inUse);
+
+    /* getNTokens, which uses scanTokens. */
+    strcpy (buffer, "add $t0 , $t1,,$t2");
+    check (getNTokens (buffer, 4, results) == 1 &&
+           strcmp (results[0], "add") == SAME &&
+           strcmp (results[2], "$t1") == SAME &&
+           strcmp (results[3], "$t2") == SAME,
+           "getNTokens: 4 tokens between extra delimiters");
+    strcpy (buffer, "add $t0, $t1");
+    check (getNTokens (buffer, 4, results) == 0 &&
+           strstr (results[0], "fewer") != NULL, "getNTokens: too few");
+    strcpy (buffer, "add $t0, $t1, $t2, $t3");
+    check (getNTokens (buffer, 4, results) == 0 &&
+           strstr (results[0], "more") != NULL, "getNTokens: too many");
+    longLine = malloc (UINT16_MAX + 10);
+    memset (longLine, 'a', UINT16_MAX + 8);
+    longLine[UINT16_MAX + 8] = '\0';
+    check (getNTokens (longLine, 1, results) == 0 &&
+           strstr (results[0], "too long") != NULL, "getNTokens: too long");
+    free (longLine);
+
+    return failures > 0;
+}
@@ -0,0 +1,263 @@
+/*
+ * This is a driver to test the Label Table functions.  It builds a
+ * small table by hand, looks labels up, tries to add a duplicate label,
+ * resizes and frees the table, and then builds a much larger table to
+ * exercise the hash index that addLabel and findLabel share, and a
+ * table made big enough for its labels up front.  Then it
+ * does much the same with a concurrent table, first on one thread and
+ * then with several threads adding, referring to, and finding labels
+ * at once.  Each check prints
+ * "OK" or "FAILED"; the program returns 1 if any check failed.
+ *
+ * USAGE:
+ *      name [ 0|1 ]
+ * where "name" is the name of the executable and "0" or "1" specifies
+ * that debugging should be turned off or on, respectively.  When
+ * debugging is on, the contents of the small table are printed.
+ *
+ * ERROR CONDITIONS:
+ * Adding the duplicate label is expected to print a duplicate-label
+ * error message to stderr (once for each kind of table).
+ */
+
+#include <pthread.h>
+
+#include "assembler.h"
+
+
+static int failures = 0;
+
+/* The concurrent test: NBR_THREADS threads share NBR_SHARED labels. */
+#define NBR_THREADS 8
+#define NBR_SHARED 100000
+
+typedef struct {
+        LabelTable * table;
+        int          thread;            /* 0 .. NBR_THREADS - 1 */
+        int *        positions;         /* the positions it was given */
+        int          allFound;          /* 1 if it found its own labels */
+} Worker;
+
+static void * work (void * worker);
+
+static void check (int condition, const char * description)
+{
+    printf ("%-50s %s\n", description, condition ? "OK" : "FAILED");
+    if ( ! condition )
+        failures++;
+}
+
+int main (int argc, char * argv[])
+{
+    LabelTable table;
+    char       name[32];
+    int        allFound;
+    pthread_t  threads[NBR_THREADS];
+    Worker     workers[NBR_THREADS];
+    int        started[NBR_THREADS];
+    char *     seen;
+
+    if ( argc > 1 && strcmp(argv[1], "0") == SAME )
+    {
+        debug_off();  override_debug_changes();
+    }
+    else if ( argc > 1 && strcmp(argv[1], "1") == SAME )
+    {
+        debug_on();  override_debug_changes();
+    }
+
+    /* A small table built by hand. */
+    tableInit (&table);
+    check (table.nbrLabels == 0, "new table is empty");
+    check (findLabel (&table, "main") == -1, "label not found in empty table");
+
+    check (addLabel (&table, "main", 0), "add main");
+    check (addLabel (&table, "loop", 12), "add loop");
+    check (addLabel (&table, "finish", 28), "add finish");
+    check (table.nbrLabels == 3, "table has 3 labels");
+    check (findLabel (&table, "main") == 0, "find main");
+    check (findLabel (&table, "loop") == 12, "find loop");
+    check (findLabel (&table, "finish") == 28, "find finish");
+    check (findLabel (&table, "begin") == -1, "missing label not found");
+
+    check (addLabel (&table, "loop", 40), "add duplicate loop (not fatal)");
+    check (table.nbrLabels == 3, "duplicate was not added");
+    check (findLabel (&table, "loop") == 12, "duplicate kept first address");
+
+    if ( debug_is_on() )
+        printLabels (&table);
+
+    check (tableResize (&table, 2), "truncate table to 2 entries");
+    check (table.nbrLabels == 2, "table has 2 labels");
+    check (findLabel (&table, "finish") == -1, "truncated label not found");
+    check (findLabel (&table, "loop") == 12, "remaining label still found");
+
+    check (findLabel (NULL, "main") == -1, "find in NULL table");
+
+    /* Labels referenced before they are defined (single-pass mode). */
+    check (referenceLabelLen (&table, "done", 4) == 2, "reference done");
+    check (findLabel (&table, "done") == UNDEFINED_ADDRESS,
+           "referenced label is undefined");
+    check (referenceLabelLen (&table, "done", 4) == 2,
+           "reference done again (same entry)");
+    check (referenceLabelLen (&table, "main", 4) == 0,
+           "reference defined label");
+    check (addLabel (&table, "done", 44), "define referenced done");
+    check (table.nbrLabels == 3 && findLabel (&table, "done") == 44,
+           "done defined in place");
+
+    tableFree (&table);
+    check (table.nbrLabels == 0, "freed table is empty");
+    check (findLabel (&table, "main") == -1, "label not found in freed table");
+
+    /* A large table, to make sure the index survives many resizes.  The
+     * same name buffer is reused for every label.
+     */
+    for ( int i = 0; i < 100000; i++ )
+    {
+        sprintf (name, "L%d", i);
+        if ( ! addLabel (&table, name, 4 * i) )
+            break;
+    }
+    check (table.nbrLabels == 100000, "large table has 100000 labels");
+
+    allFound = 1;
+    for ( int i = 0; i < 100000; i++ )
+    {
+        sprintf (name, "L%d", i);
+        if ( findLabel (&table, name) != 4 * i )
+            allFound = 0;
+    }
+    check (allFound, "every label in large table found");
+    check (findLabel (&table, "L100000") == -1,
+           "missing label not found in large table");
+    tableFree (&table);
+
+    /* A table sized up front never has to grow. */
+    check (tableInitWithCapacity (&table, 5000) && table.capacity == 5000 &&
+           table.indexSize >= 10000, "new table with room for 5000 labels");
+    {
+        LabelEntry * entries = table.entries;
+        IndexSlot *  index = table.index;
+
+        for ( int i = 0; i < 5000; i++ )
+        {
+            sprintf (name, "L%d", i);
+            if ( ! addLabel (&table, name, 4 * i) )
+                break;
+        }
+        check (table.nbrLabels == 5000 && table.entries == entries &&
+               table.index == index, "5000 labels added without growing");
+    }
+    check (tableReserve (&table, 100) && table.capacity == 5000,
+           "reserving less room keeps the table as it is");
+    check (tableReserve (&table, 20000) && table.capacity == 20000 &&
+           findLabel (&table, "L4999") == 4 * 4999,
+           "reserving more room keeps the labels");
+    tableFree (&table);
+
+    /* The same small table, made concurrent, on a single thread. */
+    check (tableInitConcurrent (&table), "new concurrent table");
+    check (table.nbrLabels == 0, "new concurrent table is empty");
+    check (addLabel (&table, "main", 0) && addLabel (&table, "loop", 12) &&
+           addLabel (&table, "finish", 28), "add main, loop, finish");
+    check (table.nbrLabels == 3, "concurrent table has 3 labels");
+    check (findLabel (&table, "loop") == 12, "find loop");
+    check (findLabel (&table, "begin") == -1, "missing label not found");
+    check (addLabel (&table, "loop", 40) && table.nbrLabels == 3 &&
+           findLabel (&table, "loop") == 12,
+           "duplicate loop not added (not fatal)");
+    check (referenceLabelLen (&table, "done", 4) == 3 &&
+           findLabel (&table, "done") == UNDEFINED_ADDRESS,
+           "reference done (undefined)");
+    check (referenceLabelLen (&table, "main", 4) == 0,
+           "reference defined label");
+    check (addLabel (&table, "done", 44) && findLabel (&table, "done") == 44,
+           "done defined in place");
+    check (strcmp (tableEntry (&table, 2)->label, "finish") == SAME &&
+           tableEntry (&table, 2)->address == 28, "entry 2 is finish");
+    check (! tableResize (&table, 2), "concurrent table is not truncated");
+    check (tableResize (&table, 10000), "make room for 10000 labels");
+    check (findLabel (&table, "finish") == 28, "finish found after resize");
+    if ( debug_is_on() )
+        printLabels (&table);
+    tableFree (&table);
+    check (table.nbrLabels == 0 && findLabel (&table, "main") == -1,
+           "freed concurrent table is empty");
+
+    /* Many threads at once.  Each refers to all of the labels, in an
+     * order of its own, and defines its share of them, so most labels
+     * are added by one thread while others refer to them, and the
+     * index grows many times underneath them all.
+     */
+    check (tableInitConcurrent (&table), "new concurrent table");
+    for ( int t = 0; t < NBR_THREADS; t++ )
+    {
+        workers[t].table = &table;
+        workers[t].thread = t;
+        workers[t].positions = malloc (NBR_SHARED * sizeof(int));
+        started[t] = pthread_create (&threads[t], NULL, work,
+                                     &workers[t]) == 0;
+        if ( ! started[t] )
+            (void) work (&workers[t]);
+    }
+    for ( int t = 0; t < NBR_THREADS; t++ )
+        if ( started[t] )
+            (void) pthread_join (threads[t], NULL);
+    check (table.nbrLabels == NBR_SHARED,
+           "concurrent table has 100000 labels");
+
+    allFound = 1;
+    for ( int t = 0; t < NBR_THREADS; t++ )
+        allFound &= workers[t].allFound;
+    check (allFound, "every thread found its own labels at once");
+
+    allFound = 1;
+    seen = calloc (NBR_SHARED, 1);
+    for ( int i = 0; i < NBR_SHARED; i++ )
+    {
+        int position = workers[0].positions[i];
+
+        sprintf (name, "L%d", i);
+        for ( int t = 1; t < NBR_THREADS; t++ )
+            if ( workers[t].positions[i] != position )
+                allFound = 0;
+        if ( findLabel (&table, name) != 4 * i || position < 0 ||
+             position >= NBR_SHARED || seen[position]++ ||
+             strcmp (tableEntry (&table, position)->label, name) != SAME ||
+             tableEntry (&table, position)->address != 4 * i )
+            allFound = 0;
+    }
+    check (allFound, "every thread got the same entry for each label");
+    free (seen);
+    for ( int t = 0; t < NBR_THREADS; t++ )
+        free (workers[t].positions);
+    tableFree (&table);
+
+    return failures > 0;
+}
+
+static void * work (void * worker)
+ /* The body of each thread in the concurrent test. */
+{
+    Worker * me = worker;
+    int      thread = me->thread;
+    char     name[32];
+    int      i;
+
+    me->allFound = 1;
+    for ( int n = 0; n < NBR_SHARED; n++ )
+    {
+        /* Every thread starts at a different place. */
+        i = (n + thread * (NBR_SHARED / NBR_THREADS)) % NBR_SHARED;
+        sprintf (name, "L%d", i);
+        if ( i % NBR_THREADS == thread )
+        {
+            if ( ! addLabel (me->table, name, 4 * i) ||
+                 findLabel (me->table, name) != 4 * i )
+                me->allFound = 0;
+        }
+        me->positions[i] = referenceLabelLen (me->table, name, strlen (name));
+    }
+    return NULL;
+}
@@ -51,24 +51,27 @@
  * Modified by:  Alyce Brady, 5/25/2015
  *      Support use of printErr and printDebug functions.
  *      Improve function documentation.
+ * Modified 10/14/2026:
+ *      Read the input through a SourceFile (memory-mapped when possible)
+ *      instead of a FILE stream.
+ * Modified 10/14/2026:
+ *      pass1 also parses the instructions, so it reports invalid ones
+ *      and labels that are referenced but never defined show up in the
+ *      table, with address -1.
  */
 
 #include "assembler.h"
 
-const int SAME = 0;		/* useful for making strcmp readable */
-                                /* e.g., if (strcmp (str1, str2) == SAME) */
-
-static FILE * process_arguments(int argc, char * argv[]);
+static int process_arguments(int argc, char * argv[], SourceFile * source);
 
 int main (int argc, char * argv[])
 {
-    FILE * fptr;               /* file pointer */
+    SourceFile source;         /* the input, held in memory */
     LabelTable table;
-    const char * ERROR1 = "Error: Cannot open file %s.\n";
+    IRProgram  program;        /* the parsed instructions (unused here) */
 
     /* Process command-line arguments (if any). */
-    fptr = process_arguments(argc, argv);
-    if ( fptr == NULL )
+    if ( ! process_arguments(argc, argv, &source) )
     {
         return 1;   /* Fatal error when processing arguments */
     }
@@ -79,22 +82,27 @@ int main (int argc, char * argv[])
     debug_on();
 
     /* Call pass1 to generate the label table. */
-    table = pass1 (fptr);
-    rewind (fptr);
+    tableInit (&table);
+    irInit (&program);
+    pass1 (&source, &table, &program, 1);
+    sourceRewind (&source);
 
     if ( debug_is_on() )
         printLabels (&table);
 
-    (void) fclose(fptr);
+    irFree (&program);
+    tableFree (&table);
+    sourceClose (&source);
     return 0;
 }
 
 /*
  * The internal (static) process_arguments function parses the
  * command-line arguments for an optional filename and an optional
- * choice (1 or 0) to turn all debugging messages on or off.  It returns
- * a FILE pointer to an open file (stdin if no filename was passed in)
- * or NULL if process_arguments encounters a fatal error.
+ * choice (1 or 0) to turn all debugging messages on or off.  It opens
+ * the input (stdin if no filename was passed in) as the given source
+ * and returns 1, or returns 0 if process_arguments encounters a fatal
+ * error.
  *
  * Usage:
  *      programName  [filename] [0|1]
@@ -102,8 +110,8 @@ int main (int argc, char * argv[])
  * be in either order.
  *
  * The optional filename indicates the input file; if it is provided,
- * process_arguments opens the file and returns it after also processing
- * the debugging option.  If it is not provided, the program reads its
+ * process_arguments opens the file after also processing the debugging
+ * option.  If it is not provided, the program reads its
  * input from stdin.
  *
  * A debugging choice argument of 0 or 1 indicates a choice to globally
@@ -115,10 +123,8 @@ int main (int argc, char * argv[])
  * depending on the current debugging state set by the debug_on,
  * debug_off, and debug_restore functions.
  */
-static FILE * process_arguments(int argc, char * argv[])
+static int process_arguments(int argc, char * argv[], SourceFile * source)
 {
-    FILE * fptr;               /* file pointer */
-
     /* Implementation notes:
      * The arguments are both optional and may be provided in either
      * order, which makes the logic more complicated.  This function
@@ -184,18 +190,8 @@ static FILE * process_arguments(int argc, char * argv[])
         return 0;
     }
 
-    /* Process the filename, if one was passed in. */
-    if ( argc > 1 )
-    {
-        /* Open the file for reading */
-        if ((fptr = fopen (argv[1], "r")) == NULL)
-        {
-            printError("Error: Cannot open file %s.\n", argv[1]);
-            return NULL;
-        }
-    }
-    else  /* No file passed in; use standard input. */
-        fptr = stdin;
-
-    return fptr;   /* Everything was OK! */
+    /* Process the filename, if one was passed in; with no file, use
+     * standard input.  (sourceOpen prints any error message.)
+     */
+    return sourceOpen (source, argc > 1 ? argv[1] : NULL);
 }